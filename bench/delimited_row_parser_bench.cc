@@ -0,0 +1,188 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "benchmark/benchmark.h"
+
+#include "delimited_row_parser.h"
+#include "input_source.h"
+#include "row_counters.h"
+#include "tsv_generator.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+namespace {
+
+constexpr int kRowCount{20000};
+
+// `kRowCount` rows, the last of which is not followed by a newline character,
+// so that the parser does not read an empty row after it
+TsvSpec row_spec() {
+  TsvSpec spec;
+  spec.row_count = kRowCount;
+  spec.final_newline = false;
+  return spec;
+}
+
+// parses all rows of `data` with `parser` from an *std::istringstream* and
+// reports rows and allocations; rows the parser ignores count as parsed
+void run_parse_row(benchmark::State& state, DelimitedRowParser parser,
+                   const std::string& data) {
+  std::vector<std::string> row;
+  RowCounters counters{&state};
+  for (auto _ : state) {
+    std::istringstream iss{data};
+    while (parser.parse_row(&iss, &row)) {
+      benchmark::DoNotOptimize(row.data());
+    }
+  }
+  counters.report(kRowCount, data.size());
+}
+
+// Args: fields per row, characters per field
+void BM_DelimitedRowParserRowShape(benchmark::State& state) {
+  TsvSpec spec{row_spec()};
+  spec.min_fields = spec.max_fields = static_cast<int>(state.range(0));
+  spec.min_field_length = spec.max_field_length
+      = static_cast<int>(state.range(1));
+  run_parse_row(state, DelimitedRowParser{}, generate_tsv(spec));
+}
+BENCHMARK(BM_DelimitedRowParserRowShape)
+    ->Args({4, 8})->Args({16, 8})->Args({64, 8})
+    ->Args({16, 1})->Args({16, 32})->Args({16, 128});
+
+// Arg(0): tab; Arg(1): comma; Arg(2): comma with "\r\n" line endings, which
+// leave '\r' at the end of the last field
+void BM_DelimitedRowParserDelimiter(benchmark::State& state) {
+  TsvSpec spec{row_spec()};
+  spec.delimiters = state.range(0) == 0 ? "\t" : ",";
+  spec.carriage_returns = state.range(0) == 2;
+  DelimitedRowParser parser;
+  parser.delimiter(spec.delimiters[0]);
+  run_parse_row(state, parser, generate_tsv(spec));
+}
+BENCHMARK(BM_DelimitedRowParserDelimiter)->Arg(0)->Arg(1)->Arg(2);
+
+// Arg: number of the 16 columns with a field parser
+void BM_DelimitedRowParserFieldParsers(benchmark::State& state) {
+  TsvSpec spec{row_spec()};
+  spec.min_fields = spec.max_fields = 16;
+  DelimitedRowParser parser;
+  for (int column = 1; column <= state.range(0); ++column) {
+    parser.set_parser(column, [](std::string* field) {
+      if (!field->empty()) {
+        (*field)[0] = static_cast<char>((*field)[0] - 'a' + 'A');
+      }
+    });
+  }
+  run_parse_row(state, parser, generate_tsv(spec));
+}
+BENCHMARK(BM_DelimitedRowParserFieldParsers)->Arg(0)->Arg(1)->Arg(16);
+
+// rows of 4 to 12 fields; Arg(0): no bounds; Arg(1): bounds every row
+// satisfies; Arg(2): rows with fewer than 6 or more than 10 fields ignored
+void BM_DelimitedRowParserEnforcement(benchmark::State& state) {
+  TsvSpec spec{row_spec()};
+  spec.min_fields = 4;
+  spec.max_fields = 12;
+  DelimitedRowParser parser;
+  if (state.range(0) == 1) {
+    parser.min_fields(4);
+    parser.max_fields(12);
+  } else if (state.range(0) == 2) {
+    parser.min_fields(6);
+    parser.enforce_min_fields(false);
+    parser.max_fields(10);
+    parser.enforce_max_fields(false);
+  }
+  run_parse_row(state, parser, generate_tsv(spec));
+}
+BENCHMARK(BM_DelimitedRowParserEnforcement)->Arg(0)->Arg(1)->Arg(2);
+
+// Arg(0): quoting disabled; Arg(1): quoting enabled on data without quotes;
+// Arg(2): quoting enabled on data with a tenth of the fields quoted
+void BM_DelimitedRowParserQuotes(benchmark::State& state) {
+  TsvSpec spec{row_spec()};
+  spec.quoted_percentage = state.range(0) == 2 ? 10 : 0;
+  DelimitedRowParser parser;
+  parser.quote_fields(state.range(0) > 0);
+  run_parse_row(state, parser, generate_tsv(spec));
+}
+BENCHMARK(BM_DelimitedRowParserQuotes)->Arg(0)->Arg(1)->Arg(2);
+
+// rows of 60 fields; Arg: number of selected columns (0 for all)
+void BM_DelimitedRowParserProjection(benchmark::State& state) {
+  TsvSpec spec{row_spec()};
+  spec.min_fields = spec.max_fields = 60;
+  DelimitedRowParser parser;
+  std::vector<int> columns;
+  for (int i = 0; i < state.range(0); ++i) {
+    columns.push_back(60 - 17 * i);
+  }
+  parser.select_columns(columns);
+  run_parse_row(state, parser, generate_tsv(spec));
+}
+BENCHMARK(BM_DelimitedRowParserProjection)->Arg(0)->Arg(3);
+
+// rows of 16 fields; Arg(0): all rows stored; Arg(1): a predicate on the
+// first column keeps the rows beginning with 'a', about one in 26
+void BM_DelimitedRowParserPredicates(benchmark::State& state) {
+  TsvSpec spec{row_spec()};
+  spec.min_fields = spec.max_fields = 16;
+  spec.min_field_length = 1;
+  DelimitedRowParser parser;
+  if (state.range(0) == 1) {
+    parser.set_predicate(1, [](const FieldView& field) {
+      return field[0] == 'a';
+    });
+  }
+  run_parse_row(state, parser, generate_tsv(spec));
+}
+BENCHMARK(BM_DelimitedRowParserPredicates)->Arg(0)->Arg(1);
+
+// Arg(0): fresh strings per row; Arg(1): reused strings; Arg(2): FieldView
+// rows parsed in place from memory
+void BM_DelimitedRowParserOutput(benchmark::State& state) {
+  TsvSpec spec{row_spec()};
+  std::string data{generate_tsv(spec)};
+  DelimitedRowParser parser;
+  if (state.range(0) < 2) {
+    parser.reuse_row(state.range(0) == 1);
+    run_parse_row(state, parser, data);
+    return;
+  }
+  std::vector<FieldView> row;
+  RowCounters counters{&state};
+  for (auto _ : state) {
+    MemorySource source{data.data(), data.size()};
+    while (parser.parse_row(&source, &row)) {
+      benchmark::DoNotOptimize(row.data());
+    }
+  }
+  counters.report(kRowCount, data.size());
+}
+BENCHMARK(BM_DelimitedRowParserOutput)->Arg(0)->Arg(1)->Arg(2);
+
+} // namespace
+
+} // namespace stl_ios_utilities
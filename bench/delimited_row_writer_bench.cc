@@ -0,0 +1,136 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "benchmark/benchmark.h"
+
+#include "delimited_row_writer.h"
+#include "row_counters.h"
+
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <streambuf>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+namespace {
+
+constexpr int kRowCount{10000};
+
+using Row = std::tuple<std::int64_t, std::string, double, int>;
+
+// rows of an identifier, a name, a measurement, and a count
+std::vector<Row> generate_rows() {
+  std::mt19937_64 generator{42};
+  std::uniform_int_distribution<std::int64_t> id{0, 1ll << 40};
+  std::uniform_int_distribution<int> length{4, 12};
+  std::uniform_int_distribution<int> letter{'a', 'z'};
+  std::uniform_real_distribution<double> measurement{-1000.0, 1000.0};
+  std::uniform_int_distribution<int> count{0, 100000};
+  std::vector<Row> rows;
+  for (int i = 0; i < kRowCount; ++i) {
+    std::string name;
+    for (int j = length(generator); j > 0; --j) {
+      name.push_back(static_cast<char>(letter(generator)));
+    }
+    rows.emplace_back(id(generator), name, measurement(generator),
+                      count(generator));
+  }
+  return rows;
+}
+
+// Discards its characters, counting them, so that only formatting and
+// buffering are measured.
+class CountingBuffer : public std::streambuf {
+ public:
+  std::int64_t count() const {return count_;}
+
+ protected:
+  int_type overflow(int_type c) override {
+    ++count_;
+    return traits_type::not_eof(c);
+  }
+
+  std::streamsize xsputn(const char*, std::streamsize count) override {
+    count_ += count;
+    return count;
+  }
+
+ private:
+  std::int64_t count_{0};
+};
+
+// Writes `rows` to `os`, formatting the measurements if `measurements` is
+// set, with `operator<<` of *std::ostream* and enough precision to read them
+// back unchanged.
+void write_with_ostream(const std::vector<Row>& rows, bool measurements,
+                        std::ostream* os) {
+  for (const Row& row : rows) {
+    (*os) << std::get<0>(row) << '\t' << std::get<1>(row) << '\t';
+    if (measurements) {
+      (*os) << std::get<2>(row) << '\t';
+    }
+    (*os) << std::get<3>(row) << '\n';
+  }
+  os->flush();
+}
+
+// Writes `rows` to `os` as `write_with_ostream` does, with a
+// `DelimitedRowWriter`.
+void write_with_writer(const std::vector<Row>& rows, bool measurements,
+                       std::ostream* os) {
+  DelimitedRowWriter writer{os};
+  for (const Row& row : rows) {
+    if (measurements) {
+      writer.write_row(row);
+    } else {
+      writer.write_row(std::make_tuple(std::get<0>(row), std::get<1>(row),
+                                       std::get<3>(row)));
+    }
+  }
+  writer.close();
+}
+
+// first argument: `operator<<` (0) or `DelimitedRowWriter` (1); second
+// argument: whether rows contain a floating-point measurement
+void BM_DelimitedRowWriter(benchmark::State& state) {
+  std::vector<Row> rows{generate_rows()};
+  bool measurements{state.range(1) == 1};
+  CountingBuffer buffer;
+  std::ostream os{&buffer};
+  os.precision(17);
+  RowCounters counters{&state};
+  for (auto _ : state) {
+    if (state.range(0) == 0) {
+      write_with_ostream(rows, measurements, &os);
+    } else {
+      write_with_writer(rows, measurements, &os);
+    }
+  }
+  counters.report(kRowCount, buffer.count() / state.iterations());
+}
+BENCHMARK(BM_DelimitedRowWriter)->ArgsProduct({{0, 1}, {0, 1}});
+
+} // namespace
+
+} // namespace stl_ios_utilities
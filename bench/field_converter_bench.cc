@@ -0,0 +1,176 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "benchmark/benchmark.h"
+
+#include "field_converter.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+namespace {
+
+constexpr int kNumberCount{10000};
+
+// integers with 1 to 18 digits, a third of them negative
+std::vector<std::string> generate_integers() {
+  std::mt19937_64 generator{42};
+  std::uniform_int_distribution<int> digits{1, 18};
+  std::uniform_int_distribution<int> digit{0, 9};
+  std::vector<std::string> numbers;
+  for (int i = 0; i < kNumberCount; ++i) {
+    std::string number{i % 3 == 0 ? "-" : ""};
+    number.push_back(static_cast<char>('1' + digit(generator) % 9));
+    for (int j = digits(generator); j > 1; --j) {
+      number.push_back(static_cast<char>('0' + digit(generator)));
+    }
+    numbers.push_back(number);
+  }
+  return numbers;
+}
+
+// decimal numbers with 1 to 6 digits before and `decimals` digits after the
+// decimal point, followed by an exponent if `exponent` is set
+std::vector<std::string> generate_decimals(int decimals, bool exponent) {
+  std::mt19937_64 generator{42};
+  std::uniform_int_distribution<int> digits{1, 6};
+  std::uniform_int_distribution<int> digit{0, 9};
+  std::uniform_int_distribution<int> power{-300, 300};
+  std::vector<std::string> numbers;
+  for (int i = 0; i < kNumberCount; ++i) {
+    std::string number;
+    for (int j = digits(generator); j > 0; --j) {
+      number.push_back(static_cast<char>('0' + digit(generator)));
+    }
+    number.push_back('.');
+    for (int j = decimals; j > 0; --j) {
+      number.push_back(static_cast<char>('0' + digit(generator)));
+    }
+    if (exponent) {
+      number += "e" + std::to_string(power(generator));
+    }
+    numbers.push_back(number);
+  }
+  return numbers;
+}
+
+std::int64_t total_size(const std::vector<std::string>& numbers) {
+  std::int64_t size{0};
+  for (const std::string& number : numbers) {
+    size += number.size();
+  }
+  return size;
+}
+
+// runs `convert(number)` for every number and reports fields per second
+template <typename Convert>
+void run(benchmark::State& state, const std::vector<std::string>& numbers,
+         Convert convert) {
+  for (auto _ : state) {
+    for (const std::string& number : numbers) {
+      benchmark::DoNotOptimize(convert(number));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * numbers.size());
+  state.SetBytesProcessed(state.iterations() * total_size(numbers));
+}
+
+void BM_FieldConverterInt64(benchmark::State& state) {
+  run(state, generate_integers(), [](const std::string& number) {
+    std::int64_t value;
+    FieldConverter<std::int64_t>::convert(
+        FieldView{number.data(), number.size()}, &value);
+    return value;
+  });
+}
+BENCHMARK(BM_FieldConverterInt64);
+
+void BM_Strtoll(benchmark::State& state) {
+  run(state, generate_integers(), [](const std::string& number) {
+    return std::strtoll(number.c_str(), nullptr, 10);
+  });
+}
+BENCHMARK(BM_Strtoll);
+
+void BM_Stoll(benchmark::State& state) {
+  run(state, generate_integers(), [](const std::string& number) {
+    return std::stoll(number);
+  });
+}
+BENCHMARK(BM_Stoll);
+
+void BM_FieldConverterFixedPoint(benchmark::State& state) {
+  run(state, generate_decimals(2, false), [](const std::string& number) {
+    FixedPoint<2> value;
+    FieldConverter<FixedPoint<2>>::convert(
+        FieldView{number.data(), number.size()}, &value);
+    return value.units;
+  });
+}
+BENCHMARK(BM_FieldConverterFixedPoint);
+
+// converts to `double` and scales to cents, as fixed-point columns are often
+// read without a dedicated converter
+void BM_StrtodFixedPoint(benchmark::State& state) {
+  run(state, generate_decimals(2, false), [](const std::string& number) {
+    return static_cast<std::int64_t>(
+        std::strtod(number.c_str(), nullptr) * 100.0 + 0.5);
+  });
+}
+BENCHMARK(BM_StrtodFixedPoint);
+
+// Arg(0): short decimals; Arg(1): 17 significant digits with exponents
+std::vector<std::string> generate_doubles(const benchmark::State& state) {
+  return state.range(0) == 0 ? generate_decimals(3, false)
+                             : generate_decimals(14, true);
+}
+
+void BM_FieldConverterDouble(benchmark::State& state) {
+  run(state, generate_doubles(state), [](const std::string& number) {
+    double value;
+    FieldConverter<double>::convert(FieldView{number.data(), number.size()},
+                                    &value);
+    return value;
+  });
+}
+BENCHMARK(BM_FieldConverterDouble)->Arg(0)->Arg(1);
+
+void BM_Strtod(benchmark::State& state) {
+  run(state, generate_doubles(state), [](const std::string& number) {
+    return std::strtod(number.c_str(), nullptr);
+  });
+}
+BENCHMARK(BM_Strtod)->Arg(0)->Arg(1);
+
+void BM_Stod(benchmark::State& state) {
+  run(state, generate_doubles(state), [](const std::string& number) {
+    return std::stod(number);
+  });
+}
+BENCHMARK(BM_Stod)->Arg(0)->Arg(1);
+
+} // namespace
+
+} // namespace stl_ios_utilities
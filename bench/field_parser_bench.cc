@@ -0,0 +1,215 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include "benchmark/benchmark.h"
+
+#include "field_parser.h"
+#include "row_counters.h"
+#include "tsv_generator.h"
+
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+namespace {
+
+constexpr int kFieldCount{100000};
+constexpr int kFieldsPerRequest{8};
+
+// first `count` characters are used as delimiters
+const std::string kDelimiterPool{"\t,;|:_#@!%&*+=~^"};
+
+std::unordered_set<char> delimiter_set(int count) {
+  return std::unordered_set<char>(kDelimiterPool.begin(),
+                                  kDelimiterPool.begin() + count);
+}
+
+// fields of 4 to 16 lowercase letters separated by delimiters drawn uniformly
+// from the first `delimiter_count` delimiters, with a newline after every
+// `kFieldsPerRequest` fields, except after the last field
+std::string generate_input(int delimiter_count) {
+  std::mt19937 generator{42};
+  std::uniform_int_distribution<int> letter{'a', 'z'};
+  std::uniform_int_distribution<int> length{4, 16};
+  std::uniform_int_distribution<int> delimiter{0, delimiter_count - 1};
+  std::string input;
+  for (int i = 1; i <= kFieldCount; ++i) {
+    for (int j = length(generator); j > 0; --j) {
+      input.push_back(static_cast<char>(letter(generator)));
+    }
+    if (i == kFieldCount) {
+      break;
+    } else if (i % kFieldsPerRequest == 0) {
+      input.push_back('\n');
+    } else {
+      input.push_back(kDelimiterPool[delimiter(generator)]);
+    }
+  }
+  return input;
+}
+
+// character-by-character tokenizer probing three hash sets per character, as
+// `FieldParser::parse_fields` did before character classes were compiled into
+// a table; kept as reference point
+void reference_parse_fields(std::istream* is,
+                            std::vector<std::string>* fields,
+                            int requested_field_number,
+                            const std::unordered_set<char>& delimiters,
+                            const std::unordered_set<char>& terminators,
+                            const std::unordered_set<char>& masked) {
+  std::vector<std::string> tmp_fields;
+  std::string field;
+  int field_count{0};
+  char c;
+  while (is->get(c)) {
+    if (terminators.count(c) == 1) {
+      break;
+    } else if (delimiters.count(c) == 1) {
+      field_count += 1;
+      tmp_fields.push_back(std::move(field));
+      field = std::string{};
+      if (field_count == requested_field_number) {
+        break;
+      }
+    } else if (masked.count(c) == 0) {
+      field.push_back(c);
+    }
+  }
+  if (field_count < requested_field_number) {
+    tmp_fields.push_back(std::move(field));
+  }
+  (*fields) = std::move(tmp_fields);
+}
+
+void BM_FieldParserParseFields(benchmark::State& state) {
+  int delimiter_count{static_cast<int>(state.range(0))};
+  std::string input{generate_input(delimiter_count)};
+  FieldParser parser;
+  parser.delimiters(delimiter_set(delimiter_count));
+  parser.masked({'\r'});
+  std::vector<std::string> fields;
+  for (auto _ : state) {
+    std::istringstream iss{input};
+    while (parser.parse_fields(&iss, &fields, kFieldsPerRequest)) {
+      benchmark::DoNotOptimize(fields.data());
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_FieldParserParseFields)->Arg(1)->Arg(4)->Arg(16);
+
+void BM_ReferenceHashSetParseFields(benchmark::State& state) {
+  int delimiter_count{static_cast<int>(state.range(0))};
+  std::string input{generate_input(delimiter_count)};
+  std::unordered_set<char> delimiters{delimiter_set(delimiter_count)};
+  std::unordered_set<char> terminators{'\n'};
+  std::unordered_set<char> masked{'\r'};
+  std::vector<std::string> fields;
+  for (auto _ : state) {
+    std::istringstream iss{input};
+    while (iss) {
+      reference_parse_fields(&iss, &fields, kFieldsPerRequest,
+                             delimiters, terminators, masked);
+      benchmark::DoNotOptimize(fields.data());
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_ReferenceHashSetParseFields)->Arg(1)->Arg(4)->Arg(16);
+
+// about `kFieldCount` fields in rows of `fields_per_row` fields, the last of
+// which is not followed by a newline character, so that no empty field is
+// read after it
+TsvSpec row_spec(int fields_per_row) {
+  TsvSpec spec;
+  spec.row_count = kFieldCount / fields_per_row;
+  spec.min_fields = spec.max_fields = fields_per_row;
+  spec.final_newline = false;
+  return spec;
+}
+
+// parses rows of `spec` as groups of `field_number` fields and reports rows
+// and allocations
+void run_parse_fields(benchmark::State& state, const FieldParser& parser,
+                      const TsvSpec& spec, int field_number) {
+  std::string data{generate_tsv(spec)};
+  std::vector<std::string> fields;
+  RowCounters counters{&state};
+  for (auto _ : state) {
+    std::istringstream iss{data};
+    while (parser.parse_fields(&iss, &fields, field_number)) {
+      benchmark::DoNotOptimize(fields.data());
+    }
+  }
+  counters.report(spec.row_count, data.size());
+}
+
+// Args: fields per row, characters per field, number of delimiters
+void BM_FieldParserRowShape(benchmark::State& state) {
+  int delimiter_count{static_cast<int>(state.range(2))};
+  TsvSpec spec{row_spec(static_cast<int>(state.range(0)))};
+  spec.min_field_length = spec.max_field_length
+      = static_cast<int>(state.range(1));
+  spec.delimiters = kDelimiterPool.substr(0, delimiter_count);
+  FieldParser parser;
+  parser.delimiters(delimiter_set(delimiter_count));
+  run_parse_fields(state, parser, spec, spec.max_fields);
+}
+BENCHMARK(BM_FieldParserRowShape)
+    ->Args({4, 8, 1})->Args({16, 8, 1})->Args({64, 8, 1})
+    ->Args({16, 1, 1})->Args({16, 128, 1})->Args({16, 8, 4});
+
+// Arg: number of the 16 fields of each row with a field parser
+void BM_FieldParserFieldParsers(benchmark::State& state) {
+  TsvSpec spec{row_spec(16)};
+  FieldParser parser;
+  for (int number = 1; number <= state.range(0); ++number) {
+    parser.add_parser(number, [](std::string* field) {
+      if (!field->empty()) {
+        (*field)[0] = static_cast<char>((*field)[0] - 'a' + 'A');
+      }
+    });
+  }
+  run_parse_fields(state, parser, spec, 16);
+}
+BENCHMARK(BM_FieldParserFieldParsers)->Arg(0)->Arg(1)->Arg(16);
+
+// rows of 4 to 12 fields read 12 at a time, without enforcing the field
+// number; Arg(0): rows with fewer fields kept; Arg(1): rows with fewer fields
+// ignored; Arg(2): rows with fewer fields kept and field strings reused
+void BM_FieldParserEnforcement(benchmark::State& state) {
+  TsvSpec spec{row_spec(kFieldsPerRequest)};
+  spec.min_fields = 4;
+  spec.max_fields = 12;
+  FieldParser parser;
+  parser.enforce_field_number(false);
+  parser.ignore_underfull_data(state.range(0) == 1);
+  parser.reuse_fields(state.range(0) == 2);
+  run_parse_fields(state, parser, spec, 12);
+}
+BENCHMARK(BM_FieldParserEnforcement)->Arg(0)->Arg(1)->Arg(2);
+
+} // namespace
+
+} // namespace stl_ios_utilities
@@ -0,0 +1,63 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef STL_IOS_UTILITIES_BENCH_ROW_COUNTERS_H_
+#define STL_IOS_UTILITIES_BENCH_ROW_COUNTERS_H_
+
+#include "benchmark/benchmark.h"
+
+#include "allocation_counter.h"
+
+#include <cstdint>
+
+namespace stl_ios_utilities {
+
+/// @brief Measures the allocations of a benchmark loop and reports bytes per
+///  second, rows per second, and allocations per row.
+///
+/// @details Construct right before the loop over `state` and call `report`
+///  right after it, with the number of rows and bytes processed by each
+///  iteration.
+///
+class RowCounters {
+ public:
+  explicit RowCounters(benchmark::State* state)
+      : state_{state}, allocations_{allocation_count()} {}
+
+  void report(std::int64_t rows_per_iteration,
+              std::int64_t bytes_per_iteration) {
+    std::uint64_t allocations{allocation_count() - allocations_};
+    std::int64_t rows{state_->iterations() * rows_per_iteration};
+    state_->SetBytesProcessed(state_->iterations() * bytes_per_iteration);
+    state_->SetItemsProcessed(rows);
+    state_->counters["rows/s"] = benchmark::Counter(
+        static_cast<double>(rows), benchmark::Counter::kIsRate);
+    state_->counters["allocs/row"] = rows == 0 ? 0.0
+        : static_cast<double>(allocations) / static_cast<double>(rows);
+  }
+
+ private:
+  benchmark::State* state_;
+  std::uint64_t allocations_;
+};
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_BENCH_ROW_COUNTERS_H_
@@ -0,0 +1,128 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "benchmark/benchmark.h"
+
+#include "delimited_row_parser.h"
+#include "input_source.h"
+#include "row_counters.h"
+#include "row_index.h"
+#include "tsv_generator.h"
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+namespace {
+
+constexpr int kRowCount{200000};
+constexpr int kLookups{100};
+
+// `kRowCount` rows written to a file in the working directory, which is
+// removed once the benchmark finished
+class TsvFile {
+ public:
+  TsvFile() {
+    TsvSpec spec;
+    spec.row_count = kRowCount;
+    data_ = generate_tsv(spec);
+    std::ofstream ofs{path_, std::ios_base::binary | std::ios_base::trunc};
+    ofs << data_;
+  }
+
+  ~TsvFile() {
+    std::remove(RowIndex::sidecar_path(path_).c_str());
+    std::remove(path_.c_str());
+  }
+
+  const std::string& path() const {return path_;}
+  const std::string& data() const {return data_;}
+
+ private:
+  std::string path_{"row_index_bench.tsv"};
+  std::string data_;
+};
+
+// row numbers drawn uniformly from all rows
+std::vector<std::size_t> generate_lookups() {
+  std::mt19937 generator{42};
+  std::uniform_int_distribution<std::size_t> row{0, kRowCount - 1};
+  std::vector<std::size_t> rows;
+  for (int i = 0; i < kLookups; ++i) {
+    rows.push_back(row(generator));
+  }
+  return rows;
+}
+
+// reads single rows at random positions; Arg(0): parsing from the beginning
+// of the data; otherwise: `IndexedRowReader` recording every Arg-th row
+void BM_RowIndexRandomAccess(benchmark::State& state) {
+  TsvFile file;
+  std::vector<std::size_t> lookups{generate_lookups()};
+  std::vector<std::string> row;
+  RowCounters counters{&state};
+  if (state.range(0) == 0) {
+    DelimitedRowParser parser;
+    for (auto _ : state) {
+      for (std::size_t lookup : lookups) {
+        MemorySource source{file.data().data(), file.data().size()};
+        for (std::size_t i = 0; i <= lookup; ++i) {
+          parser.parse_row(&source, &row);
+        }
+        benchmark::DoNotOptimize(row.data());
+      }
+    }
+  } else {
+    IndexedRowReader reader{file.path(), DelimitedRowParser{},
+                            static_cast<std::size_t>(state.range(0))};
+    for (auto _ : state) {
+      for (std::size_t lookup : lookups) {
+        reader.read_row(lookup, &row);
+        benchmark::DoNotOptimize(row.data());
+      }
+    }
+  }
+  counters.report(kLookups, 0);
+}
+BENCHMARK(BM_RowIndexRandomAccess)->Arg(0)->Arg(1)->Arg(64)->Arg(1024);
+
+// Arg: number of rows between indexed rows
+void BM_RowIndexBuild(benchmark::State& state) {
+  TsvSpec spec;
+  spec.row_count = kRowCount;
+  std::string data{generate_tsv(spec)};
+  DelimitedRowParser parser;
+  RowCounters counters{&state};
+  for (auto _ : state) {
+    RowIndex index{RowIndex::build(parser, data.data(), data.size(),
+                                   static_cast<std::size_t>(state.range(0)))};
+    benchmark::DoNotOptimize(index.offsets().data());
+  }
+  counters.report(kRowCount, data.size());
+}
+BENCHMARK(BM_RowIndexBuild)->Arg(1)->Arg(64);
+
+} // namespace
+
+} // namespace stl_ios_utilities
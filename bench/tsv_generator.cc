@@ -0,0 +1,65 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "tsv_generator.h"
+
+#include <random>
+
+namespace stl_ios_utilities {
+
+std::string generate_tsv(const TsvSpec& spec) {
+  // std::mt19937 produces the same sequence on every platform; distributions
+  // do not, so that values are derived from its output directly
+  std::mt19937 generator{spec.seed};
+  auto draw = [&generator](int min, int max) {
+    return min + static_cast<int>(
+        generator() % static_cast<std::uint32_t>(max - min + 1));
+  };
+  std::string data;
+  for (int i = 0; i < spec.row_count; ++i) {
+    for (int j = draw(spec.min_fields, spec.max_fields); j > 0; --j) {
+      bool quoted{draw(0, 99) < spec.quoted_percentage};
+      if (quoted) {
+        data.push_back('"');
+      }
+      for (int k = draw(spec.min_field_length, spec.max_field_length); k > 0;
+           --k) {
+        data.push_back(static_cast<char>(draw('a', 'z')));
+      }
+      if (quoted) {
+        data.push_back(spec.delimiters[0]);
+        data.append("\"\"\"");
+      }
+      if (j > 1) {
+        data.push_back(spec.delimiters[
+            draw(0, static_cast<int>(spec.delimiters.size()) - 1)]);
+      }
+    }
+    if (i + 1 < spec.row_count || spec.final_newline) {
+      if (spec.carriage_returns) {
+        data.push_back('\r');
+      }
+      data.push_back('\n');
+    }
+  }
+  return data;
+}
+
+} // namespace stl_ios_utilities
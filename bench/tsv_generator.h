@@ -0,0 +1,62 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef STL_IOS_UTILITIES_BENCH_TSV_GENERATOR_H_
+#define STL_IOS_UTILITIES_BENCH_TSV_GENERATOR_H_
+
+#include <cstdint>
+#include <string>
+
+namespace stl_ios_utilities {
+
+/// @brief Shape of synthetic delimited data produced by `generate_tsv`.
+///
+struct TsvSpec {
+  int row_count{10000};
+  /// @brief Each row has a number of fields drawn uniformly from
+  ///  `[min_fields, max_fields]`.
+  int min_fields{8};
+  int max_fields{8};
+  /// @brief Each field has a number of lowercase letters drawn uniformly from
+  ///  `[min_field_length, max_field_length]`.
+  int min_field_length{4};
+  int max_field_length{16};
+  /// @brief Fields are separated by characters drawn uniformly from
+  ///  `delimiters`.
+  std::string delimiters{"\t"};
+  /// @brief Percentage of fields enclosed in double quotes, each of which
+  ///  contains a delimiter and a doubled quote.
+  int quoted_percentage{0};
+  /// @brief Whether rows end in `"\r\n"` instead of `'\n'`.
+  bool carriage_returns{false};
+  bool final_newline{true};
+  std::uint32_t seed{42};
+};
+
+/// @brief Returns rows of delimited data shaped by `spec`.
+///
+/// @details The output depends only on `spec`, so that benchmark runs on
+///  different machines and at different times parse identical input.
+///
+std::string generate_tsv(const TsvSpec& spec);
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_BENCH_TSV_GENERATOR_H_
@@ -0,0 +1,75 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "tsv_generator.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// Writes synthetic delimited data to standard output, for benchmarking the
+// library or other tools on input of a known shape.
+//
+// Usage: tsv_generator [--rows=N] [--min-fields=N] [--max-fields=N]
+//                      [--min-length=N] [--max-length=N] [--delimiters=CHARS]
+//                      [--quoted=PERCENT] [--crlf] [--seed=N]
+int main(int argc, char** argv) {
+  stl_ios_utilities::TsvSpec spec;
+  for (int i = 1; i < argc; ++i) {
+    std::string argument{argv[i]};
+    std::size_t equals{argument.find('=')};
+    std::string name{argument.substr(0, equals)};
+    std::string value{equals == std::string::npos
+                      ? std::string{} : argument.substr(equals + 1)};
+    int number{std::atoi(value.c_str())};
+    if (name == "--rows") {
+      spec.row_count = number;
+    } else if (name == "--min-fields") {
+      spec.min_fields = number;
+    } else if (name == "--max-fields") {
+      spec.max_fields = number;
+    } else if (name == "--min-length") {
+      spec.min_field_length = number;
+    } else if (name == "--max-length") {
+      spec.max_field_length = number;
+    } else if (name == "--delimiters" && !value.empty()) {
+      spec.delimiters = value;
+    } else if (name == "--quoted") {
+      spec.quoted_percentage = number;
+    } else if (name == "--crlf") {
+      spec.carriage_returns = true;
+    } else if (name == "--seed") {
+      spec.seed = static_cast<std::uint32_t>(std::strtoul(value.c_str(),
+                                                          nullptr, 10));
+    } else {
+      std::cerr << "unknown argument: " << argument << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  if (spec.row_count < 0 || spec.min_fields < 1
+      || spec.max_fields < spec.min_fields || spec.min_field_length < 0
+      || spec.max_field_length < spec.min_field_length) {
+    std::cerr << "invalid data shape" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << stl_ios_utilities::generate_tsv(spec);
+  return std::cout ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,244 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef STL_IOS_UTILITIES_ARENA_H_
+#define STL_IOS_UTILITIES_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <scoped_allocator>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+/// @brief Bump allocator handing out memory from large blocks, all of which
+///  is released at once by `reset`.
+///
+/// @details Allocating advances a pointer within the current block, and
+///  deallocating does nothing, so that storing the fields of many rows costs
+///  little more than copying their characters. `reset` makes the memory of
+///  all blocks available again without returning it to the global allocator,
+///  so that an arena reset after each row or batch stops allocating once its
+///  blocks suffice for the largest row or batch. Requests larger than the
+///  block size are served from blocks of their own.
+///
+///  Memory handed out must no longer be used, and objects in it must no
+///  longer be accessed, once `reset` was called or the arena was destroyed.
+///  `Arena` is neither copyable nor movable, and must not be used by several
+///  threads at the same time.
+///
+/// @usage
+///
+/// ```
+/// stl_ios_utilities::Arena arena;
+/// stl_ios_utilities::DelimitedRowParser parser;
+/// while (std::cin) {
+///   {
+///     stl_ios_utilities::ArenaRow row{
+///         stl_ios_utilities::ArenaRow::allocator_type{&arena}};
+///     parser.parse_row(&std::cin, &row);
+///     // process row
+///   }
+///   arena.reset();
+/// }
+/// ```
+///
+class Arena {
+ public:
+  /// @name Constructors:
+  ///
+  /// @{
+
+  /// @brief Creates an arena allocating blocks of `block_size` bytes when
+  ///  needed.
+  ///
+  explicit Arena(std::size_t block_size = std::size_t{64} << 10)
+      : block_size_{block_size > 0 ? block_size : 1} {}
+
+  Arena(const Arena& other) = delete;
+  Arena& operator=(const Arena& other) = delete;
+  /// @}
+
+  /// @name Memory operations:
+  ///
+  /// @{
+
+  /// @brief Returns `size` bytes aligned to `alignment`, which must be a power
+  ///  of two.
+  ///
+  inline void* allocate(std::size_t size, std::size_t alignment) {
+    std::size_t padding{
+        (alignment - reinterpret_cast<std::uintptr_t>(position_) % alignment)
+        % alignment};
+    if (position_ != nullptr
+        && size + padding <= static_cast<std::size_t>(end_ - position_)) {
+      char* result{position_ + padding};
+      position_ = result + size;
+      return result;
+    }
+    return allocate_from_next_block(size, alignment);
+  }
+
+  /// @brief Makes all memory handed out so far available again, keeping the
+  ///  blocks for reuse.
+  ///
+  inline void reset() {
+    current_ = 0;
+    if (blocks_.empty()) {
+      position_ = end_ = nullptr;
+    } else {
+      position_ = blocks_[0].data.get();
+      end_ = position_ + blocks_[0].size;
+    }
+    return;
+  }
+  /// @}
+
+  /// @name Accessors:
+  ///
+  /// @{
+
+  /// @brief Returns the size of the blocks allocated for ordinary requests.
+  ///
+  inline std::size_t block_size() const {return block_size_;}
+
+  /// @brief Returns the total size of all blocks the arena holds.
+  ///
+  inline std::size_t capacity() const {
+    std::size_t capacity{0};
+    for (const Block& block : blocks_) {
+      capacity += block.size;
+    }
+    return capacity;
+  }
+  /// @}
+
+ private:
+  struct Block {
+    std::unique_ptr<char[]> data;
+    std::size_t size;
+  };
+
+  // Moves on to the next block able to hold `size` bytes at `alignment`,
+  // allocating one if no kept block is large enough.
+  void* allocate_from_next_block(std::size_t size, std::size_t alignment) {
+    if (size > std::numeric_limits<std::size_t>::max() - alignment) {
+      throw std::bad_alloc();
+    }
+    std::size_t needed{size + alignment - 1};
+    std::size_t next{blocks_.empty() ? 0 : current_ + 1};
+    while (next < blocks_.size() && blocks_[next].size < needed) {
+      ++next;
+    }
+    if (next == blocks_.size()) {
+      Block block;
+      block.size = needed > block_size_ ? needed : block_size_;
+      block.data.reset(new char[block.size]);
+      blocks_.push_back(std::move(block));
+    }
+    // blocks skipped over remain unused until the next reset
+    current_ = next;
+    position_ = blocks_[next].data.get();
+    end_ = position_ + blocks_[next].size;
+    return allocate(size, alignment);
+  }
+
+  std::size_t block_size_;
+  std::vector<Block> blocks_;
+  std::size_t current_{0};
+  char* position_{nullptr};
+  char* end_{nullptr};
+};
+
+/// @brief Allocator obtaining memory from an `Arena`, for use with standard
+///  containers.
+///
+/// @details Deallocation does nothing; memory is reclaimed when the arena is
+///  reset. Allocators compare equal if they use the same arena, and are
+///  propagated when containers are copied, moved, or swapped.
+///
+template <typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  /// @brief Allocates from `arena`, which must outlive the allocator and all
+  ///  memory obtained from it.
+  ///
+  explicit ArenaAllocator(Arena* arena) noexcept : arena_{arena} {}
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+      : arena_{other.arena()} {}
+
+  inline T* allocate(std::size_t n) {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  inline void deallocate(T*, std::size_t) noexcept {}
+
+  /// @brief Returns the arena memory is obtained from.
+  ///
+  inline Arena* arena() const {return arena_;}
+
+ private:
+  Arena* arena_;
+};
+
+template <typename T, typename U>
+inline bool operator==(const ArenaAllocator<T>& lhs,
+                       const ArenaAllocator<U>& rhs) {
+  return lhs.arena() == rhs.arena();
+}
+
+template <typename T, typename U>
+inline bool operator!=(const ArenaAllocator<T>& lhs,
+                       const ArenaAllocator<U>& rhs) {
+  return !(lhs == rhs);
+}
+
+/// @brief String whose characters are stored in an `Arena`.
+///
+using ArenaString =
+    std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+/// @brief Row of fields whose strings, and the row itself, are stored in an
+///  `Arena`.
+///
+/// @details Strings added to the row, for instance with `emplace_back`,
+///  automatically use the row's arena.
+///
+using ArenaRow = std::vector<
+    ArenaString, std::scoped_allocator_adaptor<ArenaAllocator<ArenaString>>>;
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_ARENA_H_
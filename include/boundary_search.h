@@ -0,0 +1,85 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#ifndef STL_IOS_UTILITIES_BOUNDARY_SEARCH_H_
+#define STL_IOS_UTILITIES_BOUNDARY_SEARCH_H_
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define STL_IOS_UTILITIES_X86_KERNELS 1
+#endif
+
+namespace stl_ios_utilities {
+
+namespace internal {
+
+/// @brief Signature of a kernel returning the first occurrence of a delimiter
+///  or `\n` in [`first`, `last`), or `last` if there is none.
+///
+using BoundarySearch = const char* (*)(const char* first,
+                                       const char* last,
+                                       char delimiter);
+
+/// @brief Portable kernel examining one character at a time.
+///
+const char* find_boundary_scalar(const char* first,
+                                 const char* last,
+                                 char delimiter);
+
+#ifdef STL_IOS_UTILITIES_X86_KERNELS
+/// @brief Kernel examining 16 characters per step using SSE2 instructions.
+///
+const char* find_boundary_sse2(const char* first,
+                               const char* last,
+                               char delimiter);
+
+/// @brief Kernel examining 32 characters per step using AVX2 instructions.
+///  Must only be called if `cpu_supports_avx2` returns `true`.
+///
+const char* find_boundary_avx2(const char* first,
+                               const char* last,
+                               char delimiter);
+
+/// @brief Indicates whether the executing CPU supports AVX2 instructions.
+///
+bool cpu_supports_avx2();
+#endif
+
+/// @brief Returns the fastest kernel supported by the executing CPU.
+///
+BoundarySearch select_boundary_search();
+
+} // namespace internal
+
+/// @brief Returns the first occurrence of `delimiter` or `\n` in [`first`,
+///  `last`), or `last` if there is none.
+///
+/// @details Dispatches to the fastest kernel supported by the executing CPU,
+///  which is determined on first use.
+///
+inline const char* find_boundary(const char* first,
+                                 const char* last,
+                                 char delimiter) {
+  static const internal::BoundarySearch search{
+      internal::select_boundary_search()};
+  return search(first, last, delimiter);
+}
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_BOUNDARY_SEARCH_H_
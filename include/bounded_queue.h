@@ -0,0 +1,155 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef STL_IOS_UTILITIES_BOUNDED_QUEUE_H_
+#define STL_IOS_UTILITIES_BOUNDED_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace stl_ios_utilities {
+
+/// @brief Fixed-capacity queue which any number of threads may push to and
+///  pop from concurrently without locks.
+///
+/// @details Each slot of a ring buffer carries a sequence number telling
+///  producers and consumers whether it is free or filled for the current lap,
+///  so that a thread claims a slot with a single compare-and-swap on the
+///  shared position and then accesses it exclusively. Neither operation
+///  blocks; callers decide whether to retry, yield, or give up when the queue
+///  is full or empty.
+///
+///  `BoundedQueue` is neither copyable nor movable.
+///
+template <typename T>
+class BoundedQueue {
+ public:
+  /// @name Constructors:
+  ///
+  /// @{
+
+  /// @brief Creates an empty queue holding at least `capacity` elements.
+  ///
+  /// @details The capacity is rounded up to the next power of two.
+  ///
+  explicit BoundedQueue(std::size_t capacity) {
+    std::size_t size{2};
+    while (size < capacity) {
+      size *= 2;
+    }
+    cells_.reset(new Cell[size]);
+    mask_ = size - 1;
+    for (std::size_t i = 0; i < size; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  BoundedQueue(const BoundedQueue& other) = delete;
+  BoundedQueue& operator=(const BoundedQueue& other) = delete;
+  /// @}
+
+  /// @name Queue operations:
+  ///
+  /// @{
+
+  /// @brief Moves `*value` to the back of the queue.
+  ///
+  /// @return Returns `false`, leaving `*value` untouched, if the queue is
+  ///  full.
+  ///
+  bool try_push(T* value) {
+    std::size_t position{
+        enqueue_position_.value.load(std::memory_order_relaxed)};
+    while (true) {
+      Cell* cell{&cells_[position & mask_]};
+      std::ptrdiff_t lap{static_cast<std::ptrdiff_t>(
+          cell->sequence.load(std::memory_order_acquire) - position)};
+      if (lap == 0) {
+        if (enqueue_position_.value.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          cell->value = std::move(*value);
+          cell->sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (lap < 0) {
+        return false;
+      } else {
+        position = enqueue_position_.value.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// @brief Moves the front of the queue to `*value`.
+  ///
+  /// @return Returns `false`, leaving `*value` untouched, if the queue is
+  ///  empty.
+  ///
+  bool try_pop(T* value) {
+    std::size_t position{
+        dequeue_position_.value.load(std::memory_order_relaxed)};
+    while (true) {
+      Cell* cell{&cells_[position & mask_]};
+      std::ptrdiff_t lap{static_cast<std::ptrdiff_t>(
+          cell->sequence.load(std::memory_order_acquire) - (position + 1))};
+      if (lap == 0) {
+        if (dequeue_position_.value.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          (*value) = std::move(cell->value);
+          cell->sequence.store(position + mask_ + 1,
+                               std::memory_order_release);
+          return true;
+        }
+      } else if (lap < 0) {
+        return false;
+      } else {
+        position = dequeue_position_.value.load(std::memory_order_relaxed);
+      }
+    }
+  }
+  /// @}
+
+  /// @brief Returns the number of elements the queue holds when full.
+  ///
+  inline std::size_t capacity() const {return mask_ + 1;}
+
+ private:
+  struct Cell {
+    std::atomic<std::size_t> sequence;
+    T value;
+  };
+
+  // positions are updated by different threads and padded to keep them on
+  // separate cache lines
+  struct Position {
+    std::atomic<std::size_t> value{0};
+    char padding[64 - sizeof(std::atomic<std::size_t>)];
+  };
+
+  std::unique_ptr<Cell[]> cells_;
+  std::size_t mask_;
+  Position enqueue_position_;
+  Position dequeue_position_;
+};
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_BOUNDED_QUEUE_H_
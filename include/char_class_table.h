@@ -0,0 +1,181 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#ifndef STL_IOS_UTILITIES_CHAR_CLASS_TABLE_H_
+#define STL_IOS_UTILITIES_CHAR_CLASS_TABLE_H_
+
+#include "boundary_search.h"
+
+#include <array>
+#include <string>
+#include <unordered_set>
+
+namespace stl_ios_utilities {
+
+/// @brief Role of a character in the input of `FieldParser`, in order of
+///  precedence.
+///
+enum class CharClass : unsigned char {
+  kOrdinary, kMasked, kDelimiter, kTerminator};
+
+/// @brief Membership tables of a character set for the two-nibble shuffle
+///  classification technique.
+///
+/// @details A character with high nibble `h` and low nibble `l` belongs to the
+///  set if `low[r][l] & high[r][h]` is non-zero for some round `r`. High
+///  nibbles whose characters in the set share the same low nibbles are
+///  grouped into a bucket, and each bucket is assigned one bit. Since there
+///  are at most 16 distinct buckets, two rounds of 8 bits represent any set
+///  exactly.
+///
+struct NibbleTable {
+  unsigned char low[2][16];
+  unsigned char high[2][16];
+  /// Number of rounds (`1` or `2`) needed to test membership.
+  int rounds;
+};
+
+class CharClassTable;
+
+namespace internal {
+
+/// @brief Signature of a kernel which appends the characters in [`first`,
+///  `last`) to `field`, leaving out masked characters, until it reaches a
+///  delimiter or terminator, which is returned. Returns `last` if there is
+///  none.
+///
+using FieldScan = const char* (*)(const char* first,
+                                  const char* last,
+                                  const CharClassTable& table,
+                                  std::string* field);
+
+/// @brief Portable kernel looking up one character at a time.
+///
+const char* scan_field_scalar(const char* first,
+                              const char* last,
+                              const CharClassTable& table,
+                              std::string* field);
+
+#ifdef STL_IOS_UTILITIES_X86_KERNELS
+/// @brief Kernel classifying 16 characters per step using SSSE3 shuffles. Must
+///  only be called if `cpu_supports_ssse3` returns `true`.
+///
+const char* scan_field_ssse3(const char* first,
+                             const char* last,
+                             const CharClassTable& table,
+                             std::string* field);
+
+/// @brief Kernel classifying 32 characters per step using AVX2 shuffles. Must
+///  only be called if `cpu_supports_avx2` returns `true`.
+///
+const char* scan_field_avx2(const char* first,
+                            const char* last,
+                            const CharClassTable& table,
+                            std::string* field);
+
+/// @brief Indicates whether the executing CPU supports SSSE3 instructions.
+///
+bool cpu_supports_ssse3();
+#endif
+
+/// @brief Returns the fastest kernel supported by the executing CPU.
+///
+FieldScan select_field_scan();
+
+} // namespace internal
+
+/// @brief Classification of characters into delimiters, terminators, masked
+///  and ordinary characters, compiled from the character sets of a
+///  `FieldParser`.
+///
+/// @details Holds a 256-entry table for looking up single characters, and
+///  nibble tables (see `NibbleTable`) for classifying blocks of characters with
+///  SIMD shuffle instructions, one for delimiters and terminators and one for
+///  masked characters. `CharClassTable` is copyable and movable.
+///
+class CharClassTable {
+ public:
+  /// @name Constructors:
+  ///
+  /// @{
+
+  /// @brief Classifies every character as ordinary.
+  ///
+  CharClassTable();
+  /// @}
+
+  /// @name Modifiers:
+  ///
+  /// @{
+
+  /// @brief Rebuilds the tables from the specified sets. A character in more
+  ///  than one set belongs to the class of highest precedence.
+  ///
+  void compile(const std::unordered_set<char>& delimiters,
+               const std::unordered_set<char>& terminators,
+               const std::unordered_set<char>& masked);
+  /// @}
+
+  /// @name Classification:
+  ///
+  /// @{
+
+  /// @brief Returns the class of `c`.
+  ///
+  inline CharClass operator[](char c) const {
+    return classes_[static_cast<unsigned char>(c)];
+  }
+
+  /// @brief Appends the characters in [`first`, `last`) to `field`, leaving out
+  ///  masked characters, until a delimiter or terminator is reached.
+  ///
+  /// @details Dispatches to the fastest kernel supported by the executing CPU,
+  ///  which is determined on first use.
+  ///
+  /// @return Returns the first delimiter or terminator in [`first`, `last`),
+  ///  or `last` if there is none.
+  ///
+  const char* scan_field(const char* first,
+                         const char* last,
+                         std::string* field) const;
+
+  /// @brief Returns the nibble tables of the union of delimiters and
+  ///  terminators.
+  ///
+  inline const NibbleTable& stop_table() const {return stop_table_;}
+
+  /// @brief Returns the nibble tables of the masked characters.
+  ///
+  inline const NibbleTable& masked_table() const {return masked_table_;}
+
+  /// @brief Indicates whether any character is masked.
+  ///
+  inline bool has_masked() const {return has_masked_;}
+  /// @}
+
+ private:
+  std::array<CharClass, 256> classes_;
+  NibbleTable stop_table_;
+  NibbleTable masked_table_;
+  bool has_masked_{false};
+};
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_CHAR_CLASS_TABLE_H_
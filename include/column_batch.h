@@ -0,0 +1,308 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef STL_IOS_UTILITIES_COLUMN_BATCH_H_
+#define STL_IOS_UTILITIES_COLUMN_BATCH_H_
+
+#include "field_converter.h"
+#include "field_view.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+/// @brief Reusable column-oriented container of rows filled by
+///  `DelimitedRowParser::parse_rows`.
+///
+/// @details Each column stores the characters of all its fields back to back
+///  in a single *std::string* object together with an array of offsets, in
+///  which field `row` of the column spans the characters from `offsets[row]`
+///  to `offsets[row + 1]`. No *std::string* object exists per field, and
+///  scanning a column touches only that column's memory.
+///
+///  Columns declared as `ColumnType::kInteger` or
+///  `ColumnType::kFloatingPoint` instead store their fields converted by
+///  `FieldConverter<std::int64_t>` or `FieldConverter<double>` in a typed
+///  array. A field which cannot be converted causes an exception of type
+///  `InvalidField` to be thrown.
+///
+///  Columns are numbered starting at 1, like the columns of field parsers.
+///  The batch has as many columns as its widest row, or as the highest
+///  declared column, whichever is more. Text columns lacking a field in a
+///  narrower row hold an empty field for that row; a declared numeric column
+///  lacking a field cannot be converted.
+///
+///  Accessors throw an exception of type *std::out_of_range* for columns the
+///  batch does not have. The typed arrays of text columns, and the characters
+///  and offsets of numeric columns, are empty.
+///
+///  Clearing a batch keeps the memory of its columns for reuse. `ColumnBatch`
+///  is copyable and movable.
+///
+/// @usage
+///
+/// ```
+/// stl_ios_utilities::DelimitedRowParser parser;
+/// stl_ios_utilities::ColumnBatch batch;
+/// batch.column_type(2, stl_ios_utilities::ColumnBatch::ColumnType::kInteger);
+/// while (parser.parse_rows(&std::cin, &batch, 4096) > 0) {
+///   std::int64_t sum{0};
+///   for (std::int64_t value : batch.integers(2)) {
+///     sum += value;
+///   }
+/// }
+/// ```
+///
+class ColumnBatch {
+ public:
+  /// @brief Representation of the fields of a column.
+  ///
+  enum class ColumnType {
+    /// Characters and offsets.
+    kText,
+    /// Array of `std::int64_t` values.
+    kInteger,
+    /// Array of `double` values.
+    kFloatingPoint};
+
+  /// @name Accessors:
+  ///
+  /// @{
+
+  /// @brief Returns the number of rows.
+  ///
+  inline std::size_t size() const {return row_count_;}
+
+  /// @brief Indicates whether the batch holds no rows.
+  ///
+  inline bool empty() const {return row_count_ == 0;}
+
+  /// @brief Returns the number of columns.
+  ///
+  inline std::size_t column_count() const {return column_count_;}
+
+  /// @brief Returns the type of `column`, which is `ColumnType::kText` unless
+  ///  declared otherwise.
+  ///
+  inline ColumnType column_type(int column) const {
+    return (column > 0 && static_cast<std::size_t>(column) <= types_.size())
+        ? types_[column - 1] : ColumnType::kText;
+  }
+
+  /// @brief Returns the field of text column `column` in row `row`.
+  ///
+  /// @details The view is valid until the batch is modified.
+  ///
+  inline FieldView field(int column, std::size_t row) const {
+    const Column& text = column_at(column);
+    return FieldView{text.chars.data() + text.offsets[row],
+                     text.offsets[row + 1] - text.offsets[row]};
+  }
+
+  /// @brief Returns the characters of all fields of text column `column`.
+  ///
+  inline const std::string& chars(int column) const {
+    return column_at(column).chars;
+  }
+
+  /// @brief Returns the `size() + 1` offsets delimiting the fields of text
+  ///  column `column` in `chars(column)`.
+  ///
+  inline const std::vector<std::size_t>& offsets(int column) const {
+    return column_at(column).offsets;
+  }
+
+  /// @brief Returns the values of integer column `column`.
+  ///
+  inline const std::vector<std::int64_t>& integers(int column) const {
+    return column_at(column).integers;
+  }
+
+  /// @brief Returns the values of floating-point column `column`.
+  ///
+  inline const std::vector<double>& floating_points(int column) const {
+    return column_at(column).floating_points;
+  }
+  /// @}
+
+  /// @name Modifiers:
+  ///
+  /// @{
+
+  /// @brief Declares the type of `column` (starting at 1) and clears the
+  ///  batch.
+  ///
+  inline void column_type(int column, ColumnType type) {
+    if (column < 1) {
+      return;
+    }
+    while (types_.size() < static_cast<std::size_t>(column)) {
+      types_.push_back(ColumnType::kText);
+    }
+    types_[column - 1] = type;
+    clear();
+    return;
+  }
+
+  /// @brief Removes all rows, keeping the memory of the columns for reuse.
+  ///
+  /// @details Leaves the columns declared by `column_type`.
+  ///
+  inline void clear() {
+    row_count_ = 0;
+    row_width_ = 0;
+    column_count_ = 0;
+    while (column_count_ < types_.size()) {
+      add_column();
+    }
+    return;
+  }
+
+  /// @brief Appends `field` to the next column of the row being built.
+  ///
+  inline void add_field(const FieldView& field) {
+    if (row_width_ == column_count_) {
+      add_column();
+    }
+    append_field(&columns_[row_width_++], field);
+    return;
+  }
+
+  /// @brief Completes the row being built from the fields added since the
+  ///  previous row was completed or discarded.
+  ///
+  /// @details Columns without a field in this row receive an empty field.
+  ///
+  inline void finish_row() {
+    while (row_width_ < column_count_) {
+      append_field(&columns_[row_width_++], FieldView{"", 0});
+    }
+    ++row_count_;
+    row_width_ = 0;
+    return;
+  }
+
+  /// @brief Removes the fields added since the previous row was completed or
+  ///  discarded.
+  ///
+  inline void discard_row() {
+    row_width_ = 0;
+    truncate_columns();
+    return;
+  }
+  /// @}
+
+ private:
+  struct Column {
+    ColumnType type;
+    std::string chars;
+    std::vector<std::size_t> offsets;
+    std::vector<std::int64_t> integers;
+    std::vector<double> floating_points;
+  };
+
+  const Column& column_at(int column) const {
+    if (column < 1 || static_cast<std::size_t>(column) > column_count_) {
+      throw std::out_of_range("No column " + std::to_string(column)
+                              + " in `stl_ios_utilities::ColumnBatch`.");
+    }
+    return columns_[column - 1];
+  }
+
+  // Appends a column whose rows so far hold empty fields, reusing the memory
+  // of a column removed by `clear`, if there is one.
+  void add_column() {
+    if (column_count_ == columns_.size()) {
+      columns_.emplace_back();
+    }
+    Column& column = columns_[column_count_++];
+    column.type = column_type(static_cast<int>(column_count_));
+    column.chars.clear();
+    column.offsets.assign(column.type == ColumnType::kText ? row_count_ + 1 : 0,
+                          0);
+    column.integers.clear();
+    column.floating_points.clear();
+    return;
+  }
+
+  static void append_field(Column* column, const FieldView& field) {
+    switch (column->type) {
+      case ColumnType::kText:
+        column->chars.append(field.data(), field.size());
+        column->offsets.push_back(column->chars.size());
+        break;
+      case ColumnType::kInteger:
+        column->integers.emplace_back();
+        try {
+          FieldConverter<std::int64_t>::convert(field,
+                                                &column->integers.back());
+        } catch (...) {
+          column->integers.pop_back();
+          throw;
+        }
+        break;
+      case ColumnType::kFloatingPoint:
+        column->floating_points.emplace_back();
+        try {
+          FieldConverter<double>::convert(field,
+                                          &column->floating_points.back());
+        } catch (...) {
+          column->floating_points.pop_back();
+          throw;
+        }
+        break;
+    }
+    return;
+  }
+
+  // Drops values past the completed rows from all columns.
+  void truncate_columns() {
+    for (std::size_t i = 0; i < column_count_; ++i) {
+      Column& column = columns_[i];
+      if (column.type == ColumnType::kText) {
+        column.offsets.resize(row_count_ + 1);
+        column.chars.resize(column.offsets[row_count_]);
+      } else {
+        column.integers.resize(
+            column.type == ColumnType::kInteger ? row_count_ : 0);
+        column.floating_points.resize(
+            column.type == ColumnType::kFloatingPoint ? row_count_ : 0);
+      }
+    }
+    return;
+  }
+
+  // declared types, indexed by column number minus one
+  std::vector<ColumnType> types_;
+  // columns in use, followed by columns kept for reuse
+  std::vector<Column> columns_;
+  std::size_t column_count_{0};
+  std::size_t row_count_{0};
+  // number of fields added to the row being built
+  std::size_t row_width_{0};
+};
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_COLUMN_BATCH_H_
@@ -21,8 +21,19 @@
 #ifndef STL_IOS_UTILITIES_PARSE_DELIMTED_ROW_H_
 #define STL_IOS_UTILITIES_PARSE_DELIMTED_ROW_H_
 
+#include "arena.h"
+#include "column_batch.h"
+#include "exceptions.h"
+#include "field_view.h"
+#include "input_source.h"
+#include "parse_statistics.h"
+#include "parse_status.h"
+#include "row_batch.h"
+#include "row_scanner.h"
+
+#include <cstddef>
 #include <functional>
-#include <istream>  
+#include <istream>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
@@ -48,7 +59,10 @@ namespace stl_ios_utilities {
  *  the `max_fields`, `enforce_max_fields`, and `ignore_max_fields` methods.
  *  
  *  The `field_parsers` and `set_parsers` methods allow specification of custom
- *  string parsers to be applied to each individual column.
+ *  string parsers to be applied to each individual column. They are compiled
+ *  into a plan indexed by column number, so that no lookup by hash is needed
+ *  per field. Callables passed directly to the `parse_row` templates are not
+ *  type-erased at all and may be inlined.
  *  
  *  `DelimitedRowParser` is copyable and movable.
  */
@@ -72,6 +86,15 @@ public:
   struct UnexpectedFields : std::logic_error {
     using std::logic_error::logic_error;
   };
+  /**
+   * @brief Exception thrown by Stream operations of the `DelimitedRowParser`
+   *  class when the input ends inside a quoted field
+   * 
+   * @details Derived from *std::logic_error*.
+   */
+  struct UnterminatedQuote : std::logic_error {
+    using std::logic_error::logic_error;
+  };
 
   /**
    * @name Parser option accessors
@@ -130,6 +153,28 @@ public:
    * @see `ignore_overfull_row(bool enforce)` and `parse_row`
    */
   inline bool ignore_overfull_row() const {return ignore_overfull_row_;}
+
+  /**
+   * @brief Indicates whether `parse_row` reuses the strings of previously read
+   *  rows, and their capacity, to store fields.
+   * 
+   * @see `reuse_row(bool reuse)` and `parse_row`
+   */
+  inline bool reuse_row() const {return reuse_row_;}
+
+  /**
+   * @brief Indicates whether fields may be enclosed in quotes.
+   * 
+   * @see `quote_fields(bool quote)` and `parse_row`
+   */
+  inline bool quote_fields() const {return quote_fields_;}
+
+  /**
+   * @brief Returns the character enclosing quoted fields.
+   * 
+   * @see `quote(char quote)` and `quote_fields(bool quote)`
+   */
+  inline char quote() const {return quote_;}
   ///@}
 
   /**
@@ -241,6 +286,59 @@ public:
    * @see `parse_row`
    */
   inline void ignore_overfull_row(bool ignore) {ignore_overfull_row_ = ignore;}
+
+  /**
+   * @brief Sets whether `parse_row` reuses the strings of previously read
+   *  rows, and their capacity, to store fields.
+   * 
+   * @details When set, fields are assigned to the strings of an internal row
+   *  which is then swapped with the *std::vector<std::string>* argument of
+   *  `parse_row`. The strings of the previously read row thereby become the
+   *  internal row, whose capacity is reused by the next call, so that reading
+   *  rows of similar widths into the same vector in a loop does not allocate
+   *  memory once all strings are large enough. As when not set, the argument
+   *  is not modified if the row is ignored or an exception is thrown. Default
+   *  value of `reuse_row_` is `false`.
+   * 
+   * @param reuse If set to `true` `parse_row` reuses previously read strings.
+   * 
+   * @see `parse_row`
+   */
+  inline void reuse_row(bool reuse) {reuse_row_ = reuse;}
+
+  /**
+   * @brief Sets whether fields may be enclosed in quotes as described in
+   *  RFC 4180.
+   * 
+   * @details When set, a field beginning with the quote character extends to
+   *  the next quote character which is not doubled, and may contain
+   *  delimiters and newline characters. The field's value is its contents
+   *  without the enclosing quotes and with doubled quotes reduced to one.
+   *  Characters between the closing quote and the next delimiter are kept as
+   *  they are, as are quotes inside fields which do not begin with one. If
+   *  the input ends inside a quoted field, an exception of member type
+   *  `UnterminatedQuote` is thrown.
+   *  
+   *  Only the first character of each field is compared with the quote
+   *  character, so that rows without quoted fields are read nearly as fast
+   *  as without quoting. Default value of `quote_fields_` is `false`.
+   * 
+   * @param quote If set to `true` quoted fields are recognized.
+   * 
+   * @see `quote(char quote)` and `parse_row`
+   */
+  inline void quote_fields(bool quote) {quote_fields_ = quote;}
+
+  /**
+   * @brief Sets the character enclosing quoted fields. Default value of
+   *  `quote_` is `'"'`.
+   * 
+   * @param quote The quote character. Must differ from the delimiter and the
+   *  newline character.
+   * 
+   * @see `quote_fields(bool quote)`
+   */
+  inline void quote(char quote) {quote_ = quote;}
   ///@}
 
   /**
@@ -261,6 +359,17 @@ public:
     return field_parsers_;
   }
 
+  /**
+   * Returns the field parsers in the order in which fields are stored by
+   *  `parse_row`, that is, by column number or, when columns are selected, by
+   *  position among the selected columns. Entries of fields without a parser
+   *  are empty functions, and fields past the end of the returned vector have
+   *  no parser either.
+   * 
+   * @see `select_columns(const std::vector<int>& columns)`
+   */
+  std::vector<std::function<void(std::string*)>> stored_column_plan() const;
+
   /**
    * Returns a constant reference to the function that parses the fields in the
    *  column specified by `column` when data rows are read by
@@ -288,6 +397,7 @@ public:
       const std::unordered_map<int, std::function<void(std::string*)>>&
           parsers) {
     field_parsers_ = parsers;
+    compile_column_plan();
     return;
   }
 
@@ -305,6 +415,7 @@ public:
   inline void field_parsers(
       std::unordered_map<int, std::function<void(std::string*)>>&& parsers) {
     field_parsers_ = parsers;
+    compile_column_plan();
     return;
   }
 
@@ -323,6 +434,128 @@ public:
   inline void set_parser(int column,
                          const std::function<void(std::string*)>& parser) {
     field_parsers_[column] = parser;
+    compile_column_plan();
+    return;
+  }
+  ///@}
+
+  /**
+   * @name Column projection
+   */
+  ///@{
+  /**
+   * @brief Returns the numbers of the columns (starting at 1) stored by
+   *  `parse_row` and `parse_rows`, in the order in which they are stored. All
+   *  columns are stored if it is empty.
+   * 
+   * @see `select_columns(const std::vector<int>& columns)`
+   */
+  inline const std::vector<int>& selected_columns() const {
+    return selected_columns_;
+  }
+
+  /**
+   * @brief Restricts stored rows to the fields of `columns`, in the given
+   *  order.
+   * 
+   * @details Rows are still tokenized entirely, and the minimum and maximum
+   *  numbers of fields apply to all of their fields, but fields of columns
+   *  not listed in `columns` are neither copied nor passed to field parsers.
+   *  Field parsers are looked up by the columns' numbers in the input, not by
+   *  their positions in the stored row. A column may be listed more than
+   *  once. Listed columns which a row does not have are stored as empty
+   *  fields, to which their field parsers are still applied. An empty
+   *  `columns` restores storing all fields. Throws an exception of type
+   *  `stl_ios_utilities::InvalidArgument` if a column number is below 1.
+   * 
+   * @param columns Numbers of the columns to store (starting at 1).
+   */
+  void select_columns(const std::vector<int>& columns);
+
+  /**
+   * @brief Restricts stored rows to the fields of the columns named `names`
+   *  in `header`, in the given order.
+   * 
+   * @details Behaves like `select_columns(const std::vector<int>& columns)`
+   *  for the positions (starting at 1) at which `header` holds `names`,
+   *  typically the fields of a header row read with `parse_row` before.
+   *  Throws an exception of type `stl_ios_utilities::InvalidArgument` if a
+   *  name does not occur in `header`. If it occurs more than once, its first
+   *  occurrence is selected.
+   * 
+   * @param names Names of the columns to store.
+   * @param header Names of all columns of the input in their order.
+   */
+  void select_columns(const std::vector<std::string>& names,
+                      const std::vector<std::string>& header);
+  ///@}
+
+  /**
+   * @name Row predicates
+   */
+  ///@{
+  /**
+   * Returns a constant reference to the *std::unordered_map* data member of
+   *  `DelimitedRowParser`, which maps column numbers (starting at 1) to
+   *  predicates which every row's field in the respective column must satisfy
+   *  for the row to be stored.
+   * 
+   * @see `set_predicate`
+   */
+  inline const std::unordered_map<int, std::function<bool(const FieldView&)>>&
+      field_predicates() const {
+    return field_predicates_;
+  }
+
+  /**
+   * @brief Sets the predicates for each column.
+   * 
+   * @param predicates The map with column numbers as keys (starting at 1) and
+   *  predicates which fields from the respective columns must satisfy.
+   * 
+   * @see `set_predicate`
+   */
+  inline void field_predicates(
+      const std::unordered_map<int, std::function<bool(const FieldView&)>>&
+          predicates) {
+    field_predicates_ = predicates;
+    compile_predicate_plan();
+    return;
+  }
+
+  /**
+   * @brief Sets the predicate which fields in column `column` must satisfy
+   *  for their rows to be stored.
+   * 
+   * @details `predicate` receives a view of the field's characters as they
+   *  appear in the input (with quotes removed if `quote_fields_` is set),
+   *  before any field parser is applied. Rows for which a predicate returns
+   *  `false` are ignored like rows with an ignored number of fields: `row`
+   *  remains unchanged and no field parser is called. A row lacking `column`
+   *  is tested with an empty field. An empty `predicate` removes the
+   *  predicate of `column`.
+   *  
+   *  Unless `quote_fields_` is set, rows are only tokenized up to the last
+   *  column with a predicate before the predicates are evaluated, and the
+   *  rest of a row failing one of them is skipped up to its newline character
+   *  without being tokenized, unless `max_fields_` or `min_fields_` may still
+   *  make it an error. Either way, a row's numbers of fields are checked
+   *  before its predicates, so that the same row is reported the same way
+   *  regardless of `quote_fields_` and the columns with predicates.
+   * 
+   * @param column Number of the column whose fields `predicate` tests
+   *  (starting at 1).
+   * 
+   * @param predicate Function returning `true` for fields of rows to store.
+   */
+  inline void set_predicate(
+      int column, const std::function<bool(const FieldView&)>& predicate) {
+    if (predicate) {
+      field_predicates_[column] = predicate;
+    } else {
+      field_predicates_.erase(column);
+    }
+    compile_predicate_plan();
     return;
   }
   ///@}
@@ -359,9 +592,11 @@ public:
    *  `row` is not modified.
    *  
    *  Field parsers mapped to by column numbers in `field_parsers_` may throw
-   *  exceptions. Internally, this method repeatedly uses *std::istream::get* to
-   *  read the row character-by-character, which may throw exceptions (see STL
-   *  docs).
+   *  exceptions. Internally, this method tokenizes the row in place inside the
+   *  buffer of `is` (see `StreamSource`), extracting exactly the characters of
+   *  the row, and updates the state of `is` as *std::istream::get* would.
+   *  Exceptions thrown by the stream's buffer are propagated as documented for
+   *  *std::istream::get* (see STL docs).
    *  
    *  Concurrent access to `is` may cause data races as documented in STL docs
    *  for *std::istream::get*.
@@ -374,9 +609,431 @@ public:
    *  the delimited row.
    */
   std::istream& parse_row(std::istream* is, std::vector<std::string>* row);
+
+  /**
+   * @brief Reads a data row from an in-memory source, such as a `MappedFile`.
+   * 
+   * @details Behaves like `parse_row(std::istream* is,
+   *  std::vector<std::string>* row)`, except that the row is tokenized in place
+   *  in `source`'s memory without any characters being copied into a stream
+   *  buffer first.
+   * 
+   * @param source Pointer to the input source containing delimited data.
+   * @param row *std::vector<std::string>* object in which the fields are
+   *  stored, if any. 
+   * 
+   * @return Returns a reference to `source` after extraction of the delimited
+   *  row. It evaluates to `false` once the end of its data was reached.
+   */
+  MemorySource& parse_row(MemorySource* source, std::vector<std::string>* row);
+
+  /**
+   * @brief Reads a data row, storing its fields in the arena of `row`.
+   * 
+   * @details Behaves like `parse_row(std::istream* is,
+   *  std::vector<std::string>* row)`, except that the fields, and the row
+   *  replacing the contents of `row`, are allocated from the `Arena` of
+   *  `row`'s allocator rather than with the global allocator. Field parsers
+   *  are applied to a copy of the field in an internal *std::string* object,
+   *  whose capacity is reused, before the result is stored in the arena.
+   *  `reuse_row_` has no effect.
+   *  
+   *  If the row is ignored or an exception is thrown, `row` is not modified,
+   *  although memory may have been taken from the arena.
+   * 
+   * @param is Pointer to the input stream containing delimited data.
+   * @param row `ArenaRow` object in which the fields are stored, if any.
+   * 
+   * @return Returns a reference to the input stream `is` after extraction of
+   *  the delimited row.
+   */
+  std::istream& parse_row(std::istream* is, ArenaRow* row);
+
+  /**
+   * @brief Reads a data row from an in-memory source, storing its fields in
+   *  the arena of `row`.
+   * 
+   * @details Behaves like `parse_row(std::istream* is, ArenaRow* row)` for
+   *  the data of `source`.
+   * 
+   * @param source Pointer to the input source containing delimited data.
+   * @param row `ArenaRow` object in which the fields are stored, if any.
+   * 
+   * @return Returns a reference to `source` after extraction of the delimited
+   *  row. It evaluates to `false` once the end of its data was reached.
+   */
+  MemorySource& parse_row(MemorySource* source, ArenaRow* row);
+
+  /**
+   * @brief Reads a data row without copying its fields, storing a view of
+   *  each field in the provided *std::vector<FieldView>* object.
+   * 
+   * @details Behaves like `parse_row(std::istream* is,
+   *  std::vector<std::string>* row)`, including enforcement of the minimum
+   *  and maximum numbers of fields, except that `field_parsers_` are not
+   *  applied. Each `FieldView` refers to the field's characters inside the
+   *  buffer of `is`, or inside a buffer of the `DelimitedRowParser` if the row
+   *  straddled the end of the stream's buffer.
+   *  
+   *  The views are valid until the next call of a `parse_row` method, or until
+   *  `is` is otherwise read from, whichever comes first. `row`'s capacity is
+   *  reused, so that no memory is allocated once it is large enough to hold a
+   *  row.
+   * 
+   * @param is Pointer to the input stream containing delimited data.
+   * @param row *std::vector<FieldView>* object in which views of the fields
+   *  are stored, if any. 
+   * 
+   * @return Returns a reference to the input stream `is` after extraction of
+   *  the delimited row.
+   */
+  std::istream& parse_row(std::istream* is, std::vector<FieldView>* row);
+
+  /**
+   * @brief Reads a data row from an in-memory source without copying its
+   *  fields.
+   * 
+   * @details Behaves like `parse_row(std::istream* is,
+   *  std::vector<FieldView>* row)`. Views refer to the memory of `source` and
+   *  remain valid as long as that memory does.
+   * 
+   * @param source Pointer to the input source containing delimited data.
+   * @param row *std::vector<FieldView>* object in which views of the fields
+   *  are stored, if any. 
+   * 
+   * @return Returns a reference to `source` after extraction of the delimited
+   *  row. It evaluates to `false` once the end of its data was reached.
+   */
+  MemorySource& parse_row(MemorySource* source, std::vector<FieldView>* row);
+
+  /**
+   * @brief Reads a data row like `parse_row(std::istream* is,
+   *  std::vector<std::string>* row)`, but reports rows with too few or too
+   *  many fields by its return value instead of an exception.
+   * 
+   * @details Where `parse_row` would throw an exception of member type
+   *  `MissingFields` or `UnexpectedFields`, this method returns a
+   *  `ParseStatus` with code `ParseStatus::Code::kMissingFields` or
+   *  `ParseStatus::Code::kUnexpectedFields`, the number of fields read, the
+   *  violated bound, and the offset of the offending field from the
+   *  beginning of the row. `is` is left where `parse_row` would leave it,
+   *  and `row` is not modified. Ignored rows are reported as
+   *  `ParseStatus::Code::kIgnored`. No error message is built unless
+   *  `ParseStatus::message` is called.
+   *  
+   *  Exceptions thrown by field parsers or by the stream's buffer are
+   *  propagated as by `parse_row`.
+   * 
+   * @param is Pointer to the input stream containing delimited data.
+   * @param row *std::vector<std::string>* object in which the fields are
+   *  stored, if any. 
+   * 
+   * @return Returns the status of the row. Whether `is` reached its end is
+   *  indicated by `is` itself, as for `parse_row`.
+   */
+  ParseStatus try_parse_row(std::istream* is, std::vector<std::string>* row);
+
+  /**
+   * @brief Reads a data row from an in-memory source without throwing
+   *  exceptions for rows with too few or too many fields.
+   * 
+   * @details Behaves like `try_parse_row(std::istream* is,
+   *  std::vector<std::string>* row)` for the data of `source`.
+   * 
+   * @param source Pointer to the input source containing delimited data.
+   * @param row *std::vector<std::string>* object in which the fields are
+   *  stored, if any. 
+   * 
+   * @return Returns the status of the row.
+   */
+  ParseStatus try_parse_row(MemorySource* source,
+                            std::vector<std::string>* row);
+
+  /**
+   * @brief Reads a data row without copying its fields or throwing
+   *  exceptions for rows with too few or too many fields.
+   * 
+   * @details Behaves like `parse_row(std::istream* is,
+   *  std::vector<FieldView>* row)`, reporting malformed rows as
+   *  `try_parse_row(std::istream* is, std::vector<std::string>* row)` does.
+   * 
+   * @param is Pointer to the input stream containing delimited data.
+   * @param row *std::vector<FieldView>* object in which views of the fields
+   *  are stored, if any. 
+   * 
+   * @return Returns the status of the row.
+   */
+  ParseStatus try_parse_row(std::istream* is, std::vector<FieldView>* row);
+
+  /**
+   * @brief Reads a data row from an in-memory source without copying its
+   *  fields or throwing exceptions for rows with too few or too many fields.
+   * 
+   * @details Behaves like `try_parse_row(std::istream* is,
+   *  std::vector<FieldView>* row)` for the data of `source`.
+   * 
+   * @param source Pointer to the input source containing delimited data.
+   * @param row *std::vector<FieldView>* object in which views of the fields
+   *  are stored, if any. 
+   * 
+   * @return Returns the status of the row.
+   */
+  ParseStatus try_parse_row(MemorySource* source, std::vector<FieldView>* row);
+
+  /**
+   * @brief Reads a data row and applies the callable `parser` to each of its
+   *  fields in place of `field_parsers_`.
+   * 
+   * @details Behaves like `parse_row(std::istream* is,
+   *  std::vector<std::string>* row)`, except that `parser` is invoked as
+   *  `parser(column, field)` for every stored field, where `column` is the
+   *  `int` column number (starting at 1) and `field` a pointer to the
+   *  *std::string* holding the field. As `parser` is not wrapped in an
+   *  *std::function* object, calls of it can be inlined, which makes this
+   *  overload preferable when a row has many columns to parse. `row` is not
+   *  modified if `parser` throws an exception.
+   * 
+   * @param is Pointer to the input stream containing delimited data.
+   * @param row *std::vector<std::string>* object in which the fields are
+   *  stored, if any. 
+   * @param parser Callable accepting an `int` and an *std::string* pointer.
+   * 
+   * @return Returns a reference to the input stream `is` after extraction of
+   *  the delimited row.
+   */
+  template <typename ColumnParser>
+  std::istream& parse_row(std::istream* is, std::vector<std::string>* row,
+                          ColumnParser&& parser) {
+    StreamSource source{is};
+    int field_count{scan_row(&source)};
+    if (field_count >= 0) {
+      store_timed_row(field_count, row, parser);
+    }
+    return (*is);
+  }
+
+  /**
+   * @brief Reads a data row from an in-memory source and applies the callable
+   *  `parser` to each of its fields in place of `field_parsers_`.
+   * 
+   * @details Behaves like `parse_row(std::istream* is,
+   *  std::vector<std::string>* row, ColumnParser&& parser)` for the data of
+   *  `source`.
+   * 
+   * @param source Pointer to the input source containing delimited data.
+   * @param row *std::vector<std::string>* object in which the fields are
+   *  stored, if any. 
+   * @param parser Callable accepting an `int` and an *std::string* pointer.
+   * 
+   * @return Returns a reference to `source` after extraction of the delimited
+   *  row. It evaluates to `false` once the end of its data was reached.
+   */
+  template <typename ColumnParser>
+  MemorySource& parse_row(MemorySource* source, std::vector<std::string>* row,
+                          ColumnParser&& parser) {
+    int field_count{scan_row(source)};
+    if (field_count >= 0) {
+      store_timed_row(field_count, row, parser);
+    }
+    return (*source);
+  }
+
+  /**
+   * @brief Reads up to `max_rows` data rows into `batch` in a single call.
+   * 
+   * @details Replaces the contents of `batch` with rows read as by
+   *  `parse_row(std::istream* is, std::vector<std::string>* row)`, applying
+   *  the same options and field parsers, until `max_rows` rows are stored or
+   *  the end of `is` is reached. Ignored rows do not count towards
+   *  `max_rows`. Unlike repeated calls of `parse_row`, no row is read once
+   *  all characters of `is` were read, so that a final newline character
+   *  does not begin an additional empty row.
+   *  
+   *  The stream is prepared for input once per call rather than once per
+   *  row, and fields are assigned to the strings `batch` kept from previous
+   *  calls, so that reading batches of similar rows in a loop does not
+   *  allocate memory once all strings are large enough.
+   *  
+   *  If an exception is thrown, `batch` holds the rows read before the row
+   *  which caused it.
+   * 
+   * @param is Pointer to the input stream containing delimited data.
+   * @param batch `RowBatch` object in which the rows are stored.
+   * @param max_rows Maximum number of rows to store.
+   * 
+   * @return Returns the number of rows stored in `batch`, which is less than
+   *  `max_rows` only if the end of `is` was reached.
+   */
+  std::size_t parse_rows(std::istream* is, RowBatch* batch,
+                         std::size_t max_rows);
+
+  /**
+   * @brief Reads up to `max_rows` data rows from an in-memory source into
+   *  `batch` in a single call.
+   * 
+   * @details Behaves like `parse_rows(std::istream* is, RowBatch* batch,
+   *  std::size_t max_rows)` for the data of `source`.
+   * 
+   * @param source Pointer to the input source containing delimited data.
+   * @param batch `RowBatch` object in which the rows are stored.
+   * @param max_rows Maximum number of rows to store.
+   * 
+   * @return Returns the number of rows stored in `batch`, which is less than
+   *  `max_rows` only if the end of `source` was reached.
+   */
+  std::size_t parse_rows(MemorySource* source, RowBatch* batch,
+                         std::size_t max_rows);
+
+  /**
+   * @brief Reads up to `max_rows` data rows into the columns of `batch` in a
+   *  single call.
+   * 
+   * @details Behaves like `parse_rows(std::istream* is, RowBatch* batch,
+   *  std::size_t max_rows)`, except that fields are appended to the columns
+   *  of `batch` (see `ColumnBatch`) without being stored in *std::string*
+   *  objects of their own, and that `field_parsers_` are not applied. Fields
+   *  of columns declared numeric in `batch` are converted instead; a field
+   *  which cannot be converted causes an exception of type `InvalidField` to
+   *  be thrown.
+   * 
+   * @param is Pointer to the input stream containing delimited data.
+   * @param batch `ColumnBatch` object in which the rows are stored.
+   * @param max_rows Maximum number of rows to store.
+   * 
+   * @return Returns the number of rows stored in `batch`, which is less than
+   *  `max_rows` only if the end of `is` was reached.
+   */
+  std::size_t parse_rows(std::istream* is, ColumnBatch* batch,
+                         std::size_t max_rows);
+
+  /**
+   * @brief Reads up to `max_rows` data rows from an in-memory source into the
+   *  columns of `batch` in a single call.
+   * 
+   * @details Behaves like `parse_rows(std::istream* is, ColumnBatch* batch,
+   *  std::size_t max_rows)` for the data of `source`.
+   * 
+   * @param source Pointer to the input source containing delimited data.
+   * @param batch `ColumnBatch` object in which the rows are stored.
+   * @param max_rows Maximum number of rows to store.
+   * 
+   * @return Returns the number of rows stored in `batch`, which is less than
+   *  `max_rows` only if the end of `source` was reached.
+   */
+  std::size_t parse_rows(MemorySource* source, ColumnBatch* batch,
+                         std::size_t max_rows);
+  ///@}
+
+  /**
+   * @name Statistics
+   */
+  ///@{
+
+  /**
+   * @brief Returns the work done by all `DelimitedRowParser` objects on all
+   *  threads since the last call of `reset_statistics`.
+   * 
+   * @details Each thread accumulates its counts separately, so that recording
+   *  them takes no synchronization, and this function sums them. Counts are
+   *  only collected if the library is compiled with
+   *  `STL_IOS_UTILITIES_STATISTICS` defined; otherwise they remain zero.
+   *  `parse_rows` counts rows like `parse_row`, while rows of
+   *  `ParallelRowParser` and `PipelinedRowParser` are counted on their
+   *  worker threads.
+   * 
+   * @see `ParseStatistics`
+   */
+  static ParseStatistics statistics() {
+    return internal::statistics(StatisticsSource::kDelimitedRowParser);
+  }
+
+  /**
+   * @brief Restarts the counts returned by `statistics` from zero.
+   */
+  static void reset_statistics() {
+    internal::reset_statistics(StatisticsSource::kDelimitedRowParser);
+  }
   ///@}
 
 private:
+  // Tokenizes the next row of `source` and enforces the minimum and maximum
+  // numbers of fields as documented for `parse_row`. Returns the number of
+  // fields to store, or `-1` if the row is ignored.
+  template <typename Source>
+  int scan_row(Source* source);
+
+  // Tokenizes the next row of `source` like `scan_row(Source* source)`, but
+  // reports violated numbers of fields in `status` instead of throwing.
+  template <typename Source>
+  int scan_row(Source* source, ParseStatus* status);
+
+  // Reads a row as documented for `try_parse_row`.
+  template <typename Source, typename Row>
+  ParseStatus try_read_row(Source* source, Row* row);
+
+  // Stores the first `field_count` fields of the most recently scanned row in
+  // `row`, applying field parsers.
+  void store_row(int field_count, std::vector<std::string>* row);
+
+  // Stores the first `field_count` fields of the most recently scanned row in
+  // `row`, calling `parser(column, field)` for each of them.
+  template <typename ColumnParser>
+  void store_row(int field_count, std::vector<std::string>* row,
+                 ColumnParser& parser);
+
+  // Stores a row like `store_row(int field_count, std::vector<std::string>*
+  // row, ColumnParser& parser)`, recording the time spent in `parser`.
+  template <typename ColumnParser>
+  void store_timed_row(int field_count, std::vector<std::string>* row,
+                       ColumnParser& parser);
+
+  // Reads rows from `source` into `batch` as documented for `parse_rows`.
+  template <typename Source, typename Batch>
+  std::size_t read_rows(Source* source, Batch* batch, std::size_t max_rows);
+
+  // Appends the first `field_count` fields of the most recently scanned row to
+  // `batch` as a new row, applying field parsers. The row is left out of
+  // `batch` if a field parser throws.
+  void store_row(int field_count, RowBatch* batch);
+
+  // Appends the first `field_count` fields of the most recently scanned row to
+  // the columns of `batch`. The row is left out of `batch` if a field cannot
+  // be converted.
+  void store_row(int field_count, ColumnBatch* batch);
+
+  // Stores the first `field_count` fields of the most recently scanned row in
+  // `row`, allocating from its arena and applying field parsers.
+  void store_row(int field_count, ArenaRow* row);
+
+  // Stores views of the first `field_count` fields of the most recently
+  // scanned row in `row`.
+  void store_row(int field_count, std::vector<FieldView>* row);
+
+  // Calls `visit(column, field, length)` for each field to store of the most
+  // recently scanned row, of which the first `field_count` fields are kept,
+  // where `column` is the field's column number in the input. Selected
+  // columns which the row does not have are visited as empty fields at the
+  // end of the row.
+  template <typename Visitor>
+  void visit_stored_fields(int field_count, Visitor& visit) const;
+
+  // Returns the number of fields stored of a row with `field_count` fields.
+  inline int stored_field_count(int field_count) const {
+    return (selected_columns_.empty()
+            ? field_count
+            : static_cast<int>(selected_columns_.size()));
+  }
+
+  // Rebuilds `column_plan_` from `field_parsers_`.
+  void compile_column_plan();
+
+  // Rebuilds `predicate_plan_` from `field_predicates_`.
+  void compile_predicate_plan();
+
+  // Indicates whether the first `field_count` fields of the most recently
+  // scanned row satisfy all predicates.
+  bool satisfies_predicates(int field_count) const;
+
   char delimiter_{'\t'};
   int min_fields_{0};
   bool enforce_min_fields_{true};
@@ -385,8 +1042,91 @@ private:
   bool enforce_max_fields_{true};
   bool ignore_overfull_row_{true};
   std::unordered_map<int, std::function<void(std::string*)>> field_parsers_;
+  // `column_plan_[column - 1]` holds the parser of `column`, or an empty
+  // function if it has none; columns past its end have no parser either
+  std::vector<std::function<void(std::string*)>> column_plan_;
+  std::unordered_map<int, std::function<bool(const FieldView&)>>
+      field_predicates_;
+  // `predicate_plan_[column - 1]` holds the predicate of `column`, if any,
+  // and ends with the last column that has one
+  std::vector<std::function<bool(const FieldView&)>> predicate_plan_;
+  // columns stored, in order, or empty to store all columns
+  std::vector<int> selected_columns_;
+  bool reuse_row_{false};
+  bool quote_fields_{false};
+  char quote_{'"'};
+  RowScanner scanner_;
+  std::vector<std::string> reused_row_;
+  // field being parsed before it is stored in an `ArenaRow`
+  std::string parsed_field_;
 };
 
+template <typename ColumnParser>
+void DelimitedRowParser::store_row(int field_count,
+                                   std::vector<std::string>* row,
+                                   ColumnParser& parser) {
+  // fields are assigned to reused strings, if requested, and `row` is only
+  // modified once all field parsers succeeded
+  std::vector<std::string> tmp_row;
+  std::vector<std::string>* fields{this->reuse_row_ ? &reused_row_ : &tmp_row};
+  fields->resize(stored_field_count(field_count));
+  std::string* field{fields->data()};
+  auto store_field = [&field, &parser](int column, const char* data,
+                                       std::size_t length) {
+    field->assign(data, length);
+    parser(column, field);
+    ++field;
+  };
+  visit_stored_fields(field_count, store_field);
+  if (this->reuse_row_) {
+    row->swap(reused_row_);
+  } else {
+    (*row) = std::move(tmp_row);
+  }
+  return;
+}
+
+template <typename Visitor>
+void DelimitedRowParser::visit_stored_fields(int field_count,
+                                             Visitor& visit) const {
+  const std::vector<FieldSpan>& spans = scanner_.fields();
+  if (selected_columns_.empty()) {
+    for (int column = 1; column <= field_count; ++column) {
+      const FieldSpan& span = spans[column - 1];
+      visit(column, scanner_.data() + span.offset, span.length);
+    }
+  } else {
+    // missing fields are empty and located right after the last field, so
+    // that they still lie within the row
+    const char* row_end{""};
+    if (field_count > 0) {
+      const FieldSpan& last = spans[field_count - 1];
+      row_end = scanner_.data() + last.offset + last.length;
+    }
+    for (int column : selected_columns_) {
+      if (column <= field_count) {
+        const FieldSpan& span = spans[column - 1];
+        visit(column, scanner_.data() + span.offset, span.length);
+      } else {
+        visit(column, row_end, std::size_t{0});
+      }
+    }
+  }
+  return;
+}
+
+template <typename ColumnParser>
+void DelimitedRowParser::store_timed_row(int field_count,
+                                         std::vector<std::string>* row,
+                                         ColumnParser& parser) {
+  internal::StatisticsRecorder recorder{StatisticsSource::kDelimitedRowParser};
+  auto timed_parser = [&parser, &recorder](int column, std::string* field) {
+    recorder.call_field_parser(parser, column, field);
+  };
+  store_row(field_count, row, timed_parser);
+  return;
+}
+
 } // namespace stl_ios_utilities
 
 #endif // STL_IOS_UTILITIES_PARSE_DELIMTED_ROW_H_
\ No newline at end of file
@@ -0,0 +1,299 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef STL_IOS_UTILITIES_DELIMITED_ROW_WRITER_H_
+#define STL_IOS_UTILITIES_DELIMITED_ROW_WRITER_H_
+
+#include "field_formatter.h"
+#include "field_view.h"
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+namespace internal {
+
+// Destination of the characters a `DelimitedRowWriter` buffered.
+class OutputSink;
+
+} // namespace internal
+
+/// @brief Writes rows of delimited data, the counterpart of
+///  `DelimitedRowParser`.
+///
+/// @details Fields are formatted into an internal buffer of `buffer_size`
+///  characters, which is handed to the destination in one piece whenever a
+///  row fills it, so that the destination is written to in large blocks
+///  instead of per field. Text fields, including `char` values, are copied
+///  as they are; other values are formatted with `FieldFormatter`,
+///  independently of the global locale.
+///  Each row is terminated by a newline character.
+///
+///  If `quote_fields` is set, text fields containing the delimiter, the
+///  quote, or a newline or carriage return character are enclosed in quotes,
+///  and their quotes are doubled, as `DelimitedRowParser` reads them with
+///  `quote_fields` set.
+///
+///  The destination is one of:
+///  - an *std::ostream* object;
+///  - a file descriptor, which is written to with *write* and left open;
+///  - a file created or truncated at a path, which is written to through
+///    windows mapped into memory with *mmap*, or with an *std::ofstream*
+///    object on platforms without it.
+///
+///  Writing throws an exception of type `stl_ios_utilities::FileError` if it
+///  fails, including when it sets the *failbit* or *badbit* of a stream.
+///  Buffered rows are written when the writer is closed, which happens at the
+///  latest when it is destroyed, in which case errors are ignored. Writing
+///  fields or rows to a closed or moved-from writer throws
+///  *std::logic_error*.
+///
+///  `DelimitedRowWriter` is movable, but not copyable.
+///
+/// @usage
+///
+/// ```
+/// stl_ios_utilities::DelimitedRowWriter writer{"data.tsv"};
+/// writer.write_row(std::vector<std::string>{"name", "count", "price"});
+/// writer.write_row(std::make_tuple(std::string{"apples"}, 12, 0.25));
+/// writer.write_field("pears");
+/// writer.write_field(7);
+/// writer.write_field(0.5);
+/// writer.end_row();
+/// writer.close();
+/// ```
+///
+class DelimitedRowWriter {
+ public:
+  /// @name Constructors:
+  ///
+  /// @{
+
+  /// @brief Writes to `*os`, which must outlive the writer.
+  ///
+  explicit DelimitedRowWriter(std::ostream* os);
+
+  /// @brief Writes to the open file descriptor `fd`, which is not closed by
+  ///  the writer.
+  ///
+  explicit DelimitedRowWriter(int fd);
+
+  /// @brief Creates or truncates the file at `path` and writes to it.
+  ///
+  explicit DelimitedRowWriter(const std::string& path);
+
+  DelimitedRowWriter(const DelimitedRowWriter& other) = delete;
+  DelimitedRowWriter(DelimitedRowWriter&& other) noexcept;
+  /// @}
+
+  /// @name Assignment:
+  ///
+  /// @{
+
+  DelimitedRowWriter& operator=(const DelimitedRowWriter& other) = delete;
+
+  /// @brief Closes the writer's destination, ignoring errors, and takes over
+  ///  that of `other`.
+  ///
+  DelimitedRowWriter& operator=(DelimitedRowWriter&& other) noexcept;
+  /// @}
+
+  ~DelimitedRowWriter();
+
+  /// @name Accessors:
+  ///
+  /// @{
+
+  /// @brief Returns the character written between fields.
+  ///
+  inline char delimiter() const {return delimiter_;}
+
+  /// @brief Returns whether text fields are quoted where necessary.
+  ///
+  inline bool quote_fields() const {return quote_fields_;}
+
+  /// @brief Returns the character quoted fields are enclosed in.
+  ///
+  inline char quote() const {return quote_;}
+
+  /// @brief Returns the number of buffered characters at which they are
+  ///  written to the destination.
+  ///
+  inline std::size_t buffer_size() const {return buffer_size_;}
+  /// @}
+
+  /// @name Mutators:
+  ///
+  /// @{
+
+  /// @brief Sets the character written between fields. Default value is
+  ///  `'\t'`.
+  ///
+  inline void delimiter(char value) {delimiter_ = value;}
+
+  /// @brief Sets whether text fields are quoted where necessary. Default
+  ///  value is `false`.
+  ///
+  inline void quote_fields(bool value) {quote_fields_ = value;}
+
+  /// @brief Sets the character quoted fields are enclosed in. Default value
+  ///  is `'"'`.
+  ///
+  inline void quote(char value) {quote_ = value;}
+
+  /// @brief Sets the number of buffered characters at which they are written
+  ///  to the destination. Default value is 1 MiB.
+  ///
+  void buffer_size(std::size_t value);
+  /// @}
+
+  /// @name Writing:
+  ///
+  /// @{
+
+  /// @brief Appends `value` as the next field of the current row.
+  ///
+  template <typename T>
+  void write_field(const T& value) {
+    this->begin_field();
+    FieldFormatter<T>::append(value, &this->buffer_);
+  }
+
+  /// @brief Appends the text `value` as the next field of the current row.
+  ///
+  inline void write_field(const std::string& value) {
+    this->begin_field();
+    this->append_text(value.data(), value.size());
+  }
+
+  /// @brief Appends the text `value` as the next field of the current row.
+  ///
+  inline void write_field(const FieldView& value) {
+    this->begin_field();
+    this->append_text(value.data(), value.size());
+  }
+
+  /// @brief Appends the character `value` as a text field of the current
+  ///  row.
+  ///
+  inline void write_field(char value) {
+    this->begin_field();
+    this->append_text(&value, 1);
+  }
+
+  /// @brief Appends the null-terminated text `value` as the next field of the
+  ///  current row.
+  ///
+  void write_field(const char* value);
+
+  /// @brief Terminates the current row, writing the buffer to the
+  ///  destination if it is full.
+  ///
+  inline void end_row() {
+    if (this->sink_ == nullptr) {
+      this->throw_closed();
+    }
+    this->buffer_.push_back('\n');
+    this->fields_in_row_ = 0;
+    if (this->buffer_.size() >= this->buffer_size_) {
+      this->write_buffer();
+    }
+  }
+
+  /// @brief Writes `row`'s text fields as a row.
+  ///
+  void write_row(const std::vector<std::string>& row);
+
+  /// @brief Writes `row`'s text fields as a row.
+  ///
+  void write_row(const std::vector<FieldView>& row);
+
+  /// @brief Writes `row`'s values as a row, in order.
+  ///
+  template <typename... Ts>
+  void write_row(const std::tuple<Ts...>& row) {
+    this->write_fields<0>(row);
+    this->end_row();
+  }
+
+  /// @brief Writes the buffer to the destination and flushes the latter.
+  ///
+  /// @details A row begun with `write_field` and not yet ended is written
+  ///  partially.
+  ///
+  void flush();
+
+  /// @brief Writes the buffer to the destination and closes the latter.
+  ///
+  /// @details Files created by the writer are truncated to the written
+  ///  characters and closed. Writing to the writer afterwards throws
+  ///  *std::logic_error*. Calling `close` again has no effect.
+  ///
+  void close();
+  /// @}
+
+ private:
+  inline void begin_field() {
+    if (this->sink_ == nullptr) {
+      this->throw_closed();
+    }
+    if (this->fields_in_row_++ > 0) {
+      this->buffer_.push_back(this->delimiter_);
+    }
+  }
+
+  // Appends the text field, quoted if necessary.
+  void append_text(const char* data, std::size_t size);
+
+  // Hands the buffer to the sink and clears it.
+  void write_buffer();
+
+  // Throws *std::logic_error* for writes after `close` or a move.
+  [[noreturn]] void throw_closed() const;
+
+  template <std::size_t I, typename... Ts>
+  typename std::enable_if<I == sizeof...(Ts)>::type
+  write_fields(const std::tuple<Ts...>&) {}
+
+  template <std::size_t I, typename... Ts>
+  typename std::enable_if<I < sizeof...(Ts)>::type
+  write_fields(const std::tuple<Ts...>& row) {
+    this->write_field(std::get<I>(row));
+    this->write_fields<I + 1>(row);
+  }
+
+  std::unique_ptr<internal::OutputSink> sink_;
+  std::string buffer_;
+  std::size_t buffer_size_{std::size_t{1} << 20};
+  std::size_t fields_in_row_{0};
+  char delimiter_{'\t'};
+  char quote_{'"'};
+  bool quote_fields_{false};
+};
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_DELIMITED_ROW_WRITER_H_
@@ -76,6 +76,25 @@ namespace stl_ios_utilities {
     using BaseException::BaseException;
   };
 
+  /// @ingroup Exceptions
+  /// @brief Indicates that a field could not be converted.
+  ///
+  /// @details Thrown when the characters of a field do not represent a value
+  ///  of the type the field is converted to, or the value is out of the type's
+  ///  range.
+  struct InvalidField final : public BaseException {
+    using BaseException::BaseException;
+  };
+
+  /// @ingroup Exceptions
+  /// @brief Indicates that a file could not be accessed.
+  ///
+  /// @details Thrown when a file cannot be opened, inspected, or mapped into
+  ///  memory.
+  struct FileError final : public BaseException {
+    using BaseException::BaseException;
+  };
+
   /// @ingroup Exceptions
   /// @brief Indicates that a conditional evaluated to an unexpected case.
   ///
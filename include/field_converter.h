@@ -0,0 +1,244 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#ifndef STL_IOS_UTILITIES_FIELD_CONVERTER_H_
+#define STL_IOS_UTILITIES_FIELD_CONVERTER_H_
+
+#include "exceptions.h"
+#include "field_view.h"
+#include "numeric_parsing.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+namespace internal {
+
+// Throws an exception of type `InvalidField` naming `field` and `type`.
+[[noreturn]] inline void throw_invalid_field(const FieldView& field,
+                                             const char* type) {
+  throw InvalidField("Unable to convert field `" + field.str() + "` to "
+                     + type + " in `stl_ios_utilities::FieldConverter`.");
+}
+
+} // namespace internal
+
+/// @brief Decimal number with `Scale` digits after the decimal point, stored
+///  exactly as an integral number of units of 10^-`Scale`.
+///
+/// @details Suited for columns such as prices, which are expected to have a
+///  fixed number of decimal places and must not suffer from the rounding of
+///  floating-point numbers.
+///
+template <unsigned Scale>
+struct FixedPoint {
+  static_assert(Scale <= 18, "Scale of `FixedPoint` must not exceed 18.");
+
+  /// Value of the number times 10^`Scale`.
+  std::int64_t units;
+
+  /// @brief Returns the floating-point number closest to the value.
+  ///
+  double to_double() const {
+    return static_cast<double>(units)
+           / static_cast<double>(internal::integer_powers_of_ten()[Scale]);
+  }
+};
+
+template <unsigned Scale>
+inline bool operator==(const FixedPoint<Scale>& lhs,
+                       const FixedPoint<Scale>& rhs) {
+  return lhs.units == rhs.units;
+}
+
+template <unsigned Scale>
+inline bool operator!=(const FixedPoint<Scale>& lhs,
+                       const FixedPoint<Scale>& rhs) {
+  return !(lhs == rhs);
+}
+
+/// @brief Converts the characters of a field to a value of type `T`.
+///
+/// @details Specializations provide a static member function
+///  `void convert(const FieldView& field, T* value)` which throws an exception
+///  of type `stl_ios_utilities::InvalidField` if the characters do not
+///  represent a value of type `T`. Specializations are provided for
+///  *std::string*, `FieldView`, `char`, `bool`, integer, floating-point,
+///  `FixedPoint`, and enumeration types; the latter are converted from their
+///  underlying integer type. Numbers are converted independently of the
+///  global locale. Users may specialize `FieldConverter` for their own types.
+///
+template <typename T, typename Enable = void>
+struct FieldConverter;
+
+/// @brief Copies the field's characters.
+///
+template <>
+struct FieldConverter<std::string> {
+  static void convert(const FieldView& field, std::string* value) {
+    value->assign(field.data(), field.size());
+  }
+};
+
+/// @brief Passes the field's view on; valid as long as the field's memory.
+///
+template <>
+struct FieldConverter<FieldView> {
+  static void convert(const FieldView& field, FieldView* value) {
+    (*value) = field;
+  }
+};
+
+/// @brief Accepts fields consisting of exactly one character.
+///
+template <>
+struct FieldConverter<char> {
+  static void convert(const FieldView& field, char* value) {
+    if (field.size() != 1) {
+      internal::throw_invalid_field(field, "char");
+    }
+    (*value) = field[0];
+  }
+};
+
+/// @brief Accepts `0`, `1`, `false`, and `true`.
+///
+template <>
+struct FieldConverter<bool> {
+  static void convert(const FieldView& field, bool* value) {
+    if (field == std::string{"1"} || field == std::string{"true"}) {
+      (*value) = true;
+    } else if (field == std::string{"0"} || field == std::string{"false"}) {
+      (*value) = false;
+    } else {
+      internal::throw_invalid_field(field, "bool");
+    }
+  }
+};
+
+/// @brief Accepts decimal digits preceded by an optional sign.
+///
+template <typename T>
+struct FieldConverter<T, typename std::enable_if<
+    std::is_integral<T>::value && !std::is_same<T, bool>::value
+    && !std::is_same<T, char>::value>::type> {
+  static void convert(const FieldView& field, T* value) {
+    if (!internal::parse_integer(field.begin(), field.end(), value)) {
+      internal::throw_invalid_field(field, "integer");
+    }
+  }
+};
+
+/// @brief Accepts decimal numbers with optional sign, decimal point, and
+///  exponent, as well as `inf`, `infinity`, and `nan` in any case.
+///
+/// @details The result is correctly rounded. Numbers whose magnitude is too
+///  large for `T` are rejected.
+///
+template <typename T>
+struct FieldConverter<T, typename std::enable_if<
+    std::is_floating_point<T>::value>::type> {
+  static void convert(const FieldView& field, T* value) {
+    if (!internal::parse_floating_point(field.begin(), field.end(), value)) {
+      internal::throw_invalid_field(field, "floating-point number");
+    }
+  }
+};
+
+/// @brief Accepts decimal numbers with optional sign and at most `Scale`
+///  digits after the decimal point, not counting trailing zeros.
+///
+template <unsigned Scale>
+struct FieldConverter<FixedPoint<Scale>> {
+  static void convert(const FieldView& field, FixedPoint<Scale>* value) {
+    if (!internal::parse_fixed_point(field.begin(), field.end(), Scale,
+                                     &value->units)) {
+      internal::throw_invalid_field(field, "fixed-point number");
+    }
+  }
+};
+
+/// @brief Converts the field to the enumeration's underlying type.
+///
+template <typename T>
+struct FieldConverter<T, typename std::enable_if<
+    std::is_enum<T>::value>::type> {
+  static void convert(const FieldView& field, T* value) {
+    typename std::underlying_type<T>::type underlying;
+    FieldConverter<typename std::underlying_type<T>::type>::convert(
+        field, &underlying);
+    (*value) = static_cast<T>(underlying);
+  }
+};
+
+/// @name Field parsers:
+///
+/// @{
+
+/// @brief Returns a field parser converting fields with `FieldConverter<T>`
+///  and storing the result in `*value`.
+///
+/// @details The field parser may be set for a column of a
+///  `DelimitedRowParser` or a field of a `FieldParser`, so that after each
+///  row `*value` holds the column's value, e.g. `parser.set_parser(3,
+///  convert_into(&price))`. The field itself is left as is. `value` must
+///  outlive the field parser.
+///
+template <typename T>
+std::function<void(std::string*)> convert_into(T* value) {
+  static_assert(!std::is_same<T, FieldView>::value,
+                "Views of fields passed to field parsers do not outlive them.");
+  return [value](std::string* field) {
+    FieldConverter<T>::convert(FieldView{field->data(), field->size()}, value);
+  };
+}
+
+/// @brief Returns a field parser converting fields with `FieldConverter<T>`
+///  and appending the results to `*values`.
+///
+/// @details Collects a column's values in a typed vector while rows are
+///  read. Nothing is appended if a field cannot be converted. `values` must
+///  outlive the field parser.
+///
+///  Values are appended as soon as the field is parsed, not once its row is
+///  stored: when the field parser of a later column throws, the row is not
+///  stored but `*values` keeps the value of its field. Callers resuming
+///  after such an exception should truncate `*values` to the number of rows
+///  stored so far.
+///
+template <typename T>
+std::function<void(std::string*)> append_into(std::vector<T>* values) {
+  static_assert(!std::is_same<T, FieldView>::value,
+                "Views of fields passed to field parsers do not outlive them.");
+  return [values](std::string* field) {
+    T value;
+    FieldConverter<T>::convert(FieldView{field->data(), field->size()},
+                               &value);
+    values->push_back(std::move(value));
+  };
+}
+/// @}
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_FIELD_CONVERTER_H_
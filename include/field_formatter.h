@@ -0,0 +1,107 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef STL_IOS_UTILITIES_FIELD_FORMATTER_H_
+#define STL_IOS_UTILITIES_FIELD_FORMATTER_H_
+
+#include "field_converter.h"
+#include "numeric_formatting.h"
+
+#include <string>
+#include <type_traits>
+
+namespace stl_ios_utilities {
+
+/// @brief Appends the characters representing a value of type `T` to a
+///  field, as the counterpart of `FieldConverter`.
+///
+/// @details Specializations provide a static member function
+///  `void append(const T& value, std::string* out)`. Specializations are
+///  provided for `char`, `bool`, integer, floating-point, `FixedPoint`, and
+///  enumeration types; the latter are formatted as their underlying integer
+///  type. Numbers are formatted independently of the global locale, and
+///  `FieldConverter<T>` reads the characters back as the same value. Users
+///  may specialize `FieldFormatter` for their own types.
+///
+template <typename T, typename Enable = void>
+struct FieldFormatter;
+
+/// @brief Appends the character.
+///
+template <>
+struct FieldFormatter<char> {
+  static void append(char value, std::string* out) {out->push_back(value);}
+};
+
+/// @brief Appends `1` or `0`.
+///
+template <>
+struct FieldFormatter<bool> {
+  static void append(bool value, std::string* out) {
+    out->push_back(value ? '1' : '0');
+  }
+};
+
+/// @brief Appends decimal digits, preceded by `-` for negative numbers.
+///
+template <typename T>
+struct FieldFormatter<T, typename std::enable_if<
+    std::is_integral<T>::value && !std::is_same<T, bool>::value
+    && !std::is_same<T, char>::value>::type> {
+  static void append(T value, std::string* out) {
+    internal::append_integer(value, out);
+  }
+};
+
+/// @brief Appends the shortest decimal number, in fixed or scientific
+///  notation, which reads back as the value, or `nan`, `inf`, or `-inf`.
+///
+template <typename T>
+struct FieldFormatter<T, typename std::enable_if<
+    std::is_floating_point<T>::value>::type> {
+  static void append(T value, std::string* out) {
+    internal::append_floating_point(value, out);
+  }
+};
+
+/// @brief Appends the decimal number with exactly `Scale` digits after the
+///  decimal point.
+///
+template <unsigned Scale>
+struct FieldFormatter<FixedPoint<Scale>> {
+  static void append(const FixedPoint<Scale>& value, std::string* out) {
+    internal::append_fixed_point(value.units, Scale, out);
+  }
+};
+
+/// @brief Appends the enumeration's underlying value.
+///
+template <typename T>
+struct FieldFormatter<T, typename std::enable_if<
+    std::is_enum<T>::value>::type> {
+  static void append(T value, std::string* out) {
+    using Underlying = typename std::underlying_type<T>::type;
+    FieldFormatter<Underlying>::append(static_cast<Underlying>(value), out);
+  }
+};
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_FIELD_FORMATTER_H_
@@ -21,8 +21,15 @@
 #ifndef STL_IOS_UTILITIES_FIELD_PARSER_H_
 #define STL_IOS_UTILITIES_FIELD_PARSER_H_
 
+#include "arena.h"
+#include "char_class_table.h"
 #include "exceptions.h"
+#include "input_source.h"
+#include "parse_statistics.h"
+#include "parse_status.h"
+#include "row_batch.h"
 
+#include <cstddef>
 #include <functional>
 #include <istream>
 #include <string>
@@ -86,7 +93,7 @@ class FieldParser {
   ///
   /// @{
   
-  FieldParser() = default;
+  FieldParser() {compile_char_classes();}
   
   FieldParser(const FieldParser& other) = default;
   FieldParser(FieldParser&& other) = default;
@@ -128,9 +135,14 @@ class FieldParser {
   ///  before any data was read into the current field.
   ///  
   ///  Field parsers mapped to by field numbers in `field_parsers_` may throw
-  ///  exceptions depending on the function. Internally, this method repeatedly
-  ///  uses *std::istream::get* to read the row character-by-character, which
-  ///  may throw exceptions (see STL docs).
+  ///  exceptions depending on the function. Internally, this method classifies
+  ///  characters using tables compiled from `delimiters_`, `terminators_`, and
+  ///  `masked_` (see `CharClassTable`), 16 or 32 at a time on CPUs supporting
+  ///  SIMD shuffle instructions, and reads them in blocks directly out of the
+  ///  buffer of `is` (see `StreamSource`), extracting exactly the characters
+  ///  it processed and updating the state of `is` as *std::istream::get*
+  ///  would. Exceptions thrown by the stream's buffer are propagated as
+  ///  documented for *std::istream::get* (see STL docs).
   ///  
   ///  Concurrent access to `is` may cause data races as documented in STL docs
   ///  for *std::istream::get*.
@@ -151,6 +163,185 @@ class FieldParser {
   std::istream& parse_fields (std::istream* is,
                               std::vector<std::string>* fields,
                               int field_number = 1) const;
+
+  /// @brief Reads fields from an in-memory source, such as a `MappedFile`.
+  ///
+  /// @details Behaves like `parse_fields(std::istream* is,
+  ///  std::vector<std::string>* fields, int field_number)`, except that
+  ///  characters are classified in place in `source`'s memory without being
+  ///  copied into a stream buffer first.
+  ///
+  /// @param source Pointer to the input source containing delimited data.
+  ///
+  /// @param fields *std::vector<std::string>* object in which the fields are
+  ///  stored, if any.
+  ///
+  /// @param field_number The number of fields requested to be read into
+  ///  `fields` (**default:** 1). Must be positive.
+  ///
+  /// @return Returns a reference to `source` after extraction of the fields. It
+  ///  evaluates to `false` once the end of its data was reached.
+  ///
+  MemorySource& parse_fields (MemorySource* source,
+                              std::vector<std::string>* fields,
+                              int field_number = 1) const;
+
+  /// @brief Reads fields like `parse_fields(std::istream* is,
+  ///  std::vector<std::string>* fields, int field_number)`, but reports
+  ///  missing and empty fields by its return value instead of an exception.
+  ///
+  /// @details Where `parse_fields` would throw an exception of type
+  ///  `stl_ios_utilities::MissingFields` or `stl_ios_utilities::EmptyField`,
+  ///  this method returns a `ParseStatus` with code
+  ///  `ParseStatus::Code::kMissingFields` or `ParseStatus::Code::kEmptyField`,
+  ///  the number of fields read (or of the empty field), and the offset of
+  ///  the end of the fields (or of the empty field) in characters read by the
+  ///  call, including masked characters. `is` is left where `parse_fields`
+  ///  would leave it, and `fields` is not modified. Ignored fields are
+  ///  reported as `ParseStatus::Code::kIgnored`. No error message is built
+  ///  unless `ParseStatus::message` is called.
+  ///
+  ///  A non-positive `field_number` is a programming error and still causes
+  ///  an exception of type `stl_ios_utilities::InvalidArgument` to be thrown.
+  ///  Exceptions thrown by field parsers or by the stream's buffer are
+  ///  propagated as by `parse_fields`.
+  ///
+  /// @param is Pointer to the input stream containing delimited data.
+  ///
+  /// @param fields *std::vector<std::string>* object in which the fields are
+  ///  stored, if any.
+  ///
+  /// @param field_number The number of fields requested to be read into
+  ///  `fields` (**default:** 1). Must be positive.
+  ///
+  /// @return Returns the status of the fields. Whether `is` reached its end
+  ///  is indicated by `is` itself, as for `parse_fields`.
+  ///
+  ParseStatus try_parse_fields (std::istream* is,
+                                std::vector<std::string>* fields,
+                                int field_number = 1) const;
+
+  /// @brief Reads fields from an in-memory source without throwing
+  ///  exceptions for missing or empty fields.
+  ///
+  /// @details Behaves like `try_parse_fields(std::istream* is,
+  ///  std::vector<std::string>* fields, int field_number)` for the data of
+  ///  `source`.
+  ///
+  /// @param source Pointer to the input source containing delimited data.
+  ///
+  /// @param fields *std::vector<std::string>* object in which the fields are
+  ///  stored, if any.
+  ///
+  /// @param field_number The number of fields requested to be read into
+  ///  `fields` (**default:** 1). Must be positive.
+  ///
+  /// @return Returns the status of the fields.
+  ///
+  ParseStatus try_parse_fields (MemorySource* source,
+                                std::vector<std::string>* fields,
+                                int field_number = 1) const;
+
+  /// @brief Reads fields from `is`, storing them in the arena of `fields`.
+  ///
+  /// @details Behaves like `parse_fields(std::istream* is,
+  ///  std::vector<std::string>* fields, int field_number)`, except that the
+  ///  fields, and the row replacing the contents of `fields`, are allocated
+  ///  from the `Arena` of `fields`' allocator rather than with the global
+  ///  allocator. Each field is read into a buffer of the calling thread,
+  ///  whose capacity is reused, and stored in the arena once it was parsed.
+  ///  `reuse_fields_` has no effect.
+  ///
+  ///  If the fields are ignored or an exception is thrown, `fields` is not
+  ///  modified, although memory may have been taken from the arena.
+  ///
+  /// @param is Pointer to the input stream containing delimited data.
+  ///
+  /// @param fields `ArenaRow` object in which the fields are stored, if any.
+  ///
+  /// @param field_number The number of fields requested to be read into
+  ///  `fields` (**default:** 1). Must be positive.
+  ///
+  /// @return Returns a reference to the input stream `is` after extraction of
+  ///  the fields.
+  ///
+  std::istream& parse_fields (std::istream* is,
+                              ArenaRow* fields,
+                              int field_number = 1) const;
+
+  /// @brief Reads fields from an in-memory source, storing them in the arena
+  ///  of `fields`.
+  ///
+  /// @details Behaves like `parse_fields(std::istream* is, ArenaRow* fields,
+  ///  int field_number)` for the data of `source`.
+  ///
+  /// @param source Pointer to the input source containing delimited data.
+  ///
+  /// @param fields `ArenaRow` object in which the fields are stored, if any.
+  ///
+  /// @param field_number The number of fields requested to be read into
+  ///  `fields` (**default:** 1). Must be positive.
+  ///
+  /// @return Returns a reference to `source` after extraction of the fields. It
+  ///  evaluates to `false` once the end of its data was reached.
+  ///
+  MemorySource& parse_fields (MemorySource* source,
+                              ArenaRow* fields,
+                              int field_number = 1) const;
+
+  /// @brief Reads up to `max_groups` groups of `field_number` fields into
+  ///  `batch` in a single call.
+  ///
+  /// @details Replaces the contents of `batch` with groups of fields, each
+  ///  read as by `parse_fields(std::istream* is, std::vector<std::string>*
+  ///  fields, int field_number)` and stored as one row of `batch`, until
+  ///  `max_groups` groups are stored or the end of `is` is reached. Groups
+  ///  which are ignored for having too few fields do not count towards
+  ///  `max_groups`. No group is read once all characters of `is` were read.
+  ///
+  ///  The stream is prepared for input once per call rather than once per
+  ///  group, and fields are read into the strings `batch` kept from previous
+  ///  calls, reusing their capacity. If an exception is thrown, `batch` holds
+  ///  the groups read before the group which caused it, and `is` is left as
+  ///  documented for `parse_fields`.
+  ///
+  /// @param is Pointer to the input stream containing delimited data.
+  ///
+  /// @param batch `RowBatch` object in which the groups of fields are stored.
+  ///
+  /// @param field_number The number of fields per group. Must be positive.
+  ///
+  /// @param max_groups Maximum number of groups to store.
+  ///
+  /// @return Returns the number of groups stored in `batch`, which is less
+  ///  than `max_groups` only if the end of `is` was reached.
+  ///
+  std::size_t parse_fields (std::istream* is,
+                            RowBatch* batch,
+                            int field_number,
+                            std::size_t max_groups) const;
+
+  /// @brief Reads up to `max_groups` groups of `field_number` fields from an
+  ///  in-memory source into `batch` in a single call.
+  ///
+  /// @details Behaves like `parse_fields(std::istream* is, RowBatch* batch,
+  ///  int field_number, std::size_t max_groups)` for the data of `source`.
+  ///
+  /// @param source Pointer to the input source containing delimited data.
+  ///
+  /// @param batch `RowBatch` object in which the groups of fields are stored.
+  ///
+  /// @param field_number The number of fields per group. Must be positive.
+  ///
+  /// @param max_groups Maximum number of groups to store.
+  ///
+  /// @return Returns the number of groups stored in `batch`, which is less
+  ///  than `max_groups` only if the end of `source` was reached.
+  ///
+  std::size_t parse_fields (MemorySource* source,
+                            RowBatch* batch,
+                            int field_number,
+                            std::size_t max_groups) const;
   /// @}
 
   /// @name Accessors:
@@ -186,6 +377,11 @@ class FieldParser {
   ///
   inline bool ignore_underfull_data() const {return ignore_underfull_data_;}
 
+  /// @brief Returns a copy of the value of object's data member
+  ///  `reuse_fields_`.
+  ///
+  inline bool reuse_fields() const {return reuse_fields_;}
+
   /// @brief Returns a constant reference to the object's data member
   ///  `field_parsers_`.
   ///
@@ -203,6 +399,7 @@ class FieldParser {
   ///
   inline void delimiters(const std::unordered_set<char>& value) {
     delimiters_ = value;
+    compile_char_classes();
   }
   
   /// @brief Sets value of object's data member `delimiters_` to `value`.
@@ -211,6 +408,7 @@ class FieldParser {
   ///
   inline void delimiters(std::unordered_set<char>&& value) {
     delimiters_ = value;
+    compile_char_classes();
   }
 
   /// @brief Sets value of object's data member `terminators_` to `value`.
@@ -219,6 +417,7 @@ class FieldParser {
   ///
   inline void terminators(const std::unordered_set<char>& value) {
     terminators_ = value;
+    compile_char_classes();
   }
   
   /// @brief Sets value of object's data member `terminators_` to `value`.
@@ -227,19 +426,26 @@ class FieldParser {
   ///
   inline void terminators(std::unordered_set<char>&& value) {
     terminators_ = value;
+    compile_char_classes();
   }
 
   /// @brief Sets value of object's data member `masked_` to `value`.
   ///
   /// @param value The new value for object's data member `masked_`.
   ///
-  inline void masked(const std::unordered_set<char>& value) {masked_ = value;}
+  inline void masked(const std::unordered_set<char>& value) {
+    masked_ = value;
+    compile_char_classes();
+  }
   
   /// @brief Sets value of object's data member `masked_` to `value`.
   ///
   /// @param value The new value for object's data member `masked_`.
   ///
-  inline void masked(std::unordered_set<char>&& value) {masked_ = value;}
+  inline void masked(std::unordered_set<char>&& value) {
+    masked_ = value;
+    compile_char_classes();
+  }
 
   /// @brief Sets value of object's data member `enforce_field_number_` to
   ///  `value`.
@@ -259,6 +465,18 @@ class FieldParser {
     ignore_underfull_data_ = value;
   }
 
+  /// @brief Sets value of object's data member `reuse_fields_` to `value`.
+  ///
+  /// @details When set, `parse_fields` reads fields into the strings of a
+  ///  vector of the calling thread, reusing their capacity, and then swaps it
+  ///  with its *std::vector<std::string>* argument, whose strings are reused
+  ///  by the thread's next call. The argument is still left unmodified when
+  ///  fields are ignored or an exception is thrown.
+  ///
+  /// @param value The new value for object's data member `reuse_fields_`.
+  ///
+  inline void reuse_fields(bool value) {reuse_fields_ = value;}
+
   /// @brief Sets value of object's data member `field_parsers_` to `value`.
   ///
   /// @param value The new value for object's data member `field_parsers_`.
@@ -266,6 +484,7 @@ class FieldParser {
   inline void field_parsers(
       const std::unordered_map<int, std::function<void(std::string*)>>& value) {
     field_parsers_ = value;
+    compile_field_plan();
   }
   
   /// @brief Sets value of object's data member `field_parsers_` to `value`.
@@ -275,6 +494,7 @@ class FieldParser {
   inline void field_parsers(
       std::unordered_map<int, std::function<void(std::string*)>>&& value) {
     field_parsers_ = value;
+    compile_field_plan();
   }
 
   /// @brief Adds a field parser to object's data member `field_parsers`.
@@ -286,10 +506,82 @@ class FieldParser {
   inline void add_parser(int number,
                          const std::function<void(std::string*)>& value) {
     field_parsers_[number] = value;
+    compile_field_plan();
+  }
+  /// @}
+
+  /// @name Statistics:
+  ///
+  /// @{
+
+  /// @brief Returns the work done by all `FieldParser` objects on all threads
+  ///  since the last call of `reset_statistics`, counting each group of fields
+  ///  read as a row.
+  ///
+  /// @details Counts are only collected if the library is compiled with
+  ///  `STL_IOS_UTILITIES_STATISTICS` defined; otherwise they remain zero. A
+  ///  group whose field parser throws is not counted.
+  ///
+  static ParseStatistics statistics() {
+    return internal::statistics(StatisticsSource::kFieldParser);
+  }
+
+  /// @brief Restarts the counts returned by `statistics` from zero.
+  ///
+  static void reset_statistics() {
+    internal::reset_statistics(StatisticsSource::kFieldParser);
   }
   /// @}
 
  private:
+  /// Rebuilds `char_classes_` from `delimiters_`, `terminators_`, and
+  /// `masked_`.
+  void compile_char_classes();
+
+  /// Rebuilds `field_plan_` from `field_parsers_`.
+  void compile_field_plan();
+
+  /// Reads fields from `source` as documented for `parse_fields`.
+  template <typename Source>
+  void read_fields(Source* source,
+                   std::vector<std::string>* fields,
+                   int requested_field_number) const;
+
+  /// Reads fields from `source` into the arena of `fields` as documented for
+  /// `parse_fields`.
+  template <typename Source>
+  void read_fields(Source* source,
+                   ArenaRow* fields,
+                   int requested_field_number) const;
+
+  /// Reads groups of fields from `source` into `batch` as documented for
+  /// `parse_fields`.
+  template <typename Source>
+  std::size_t read_groups(Source* source,
+                          RowBatch* batch,
+                          int requested_field_number,
+                          std::size_t max_groups) const;
+
+  /// Reads fields from `source` as documented for `try_parse_fields`.
+  template <typename Source>
+  ParseStatus try_read_fields(Source* source,
+                              std::vector<std::string>* fields,
+                              int requested_field_number) const;
+
+  /// Reads up to `requested_field_number` fields from `source`, each into the
+  /// string returned by `next_field(index)`, processes them, and returns the
+  /// number of fields read. Stops at the first empty field. Describes the
+  /// outcome in `status`.
+  template <typename Source, typename NextField>
+  int read_group(Source* source,
+                 int requested_field_number,
+                 NextField next_field,
+                 ParseStatus* status) const;
+
+  /// Returns whether a group of fields read with outcome `status` is stored,
+  /// or throws the exception corresponding to an error.
+  bool store_group(const ParseStatus& status) const;
+
   /// Set of field separating characters.
   std::unordered_set<char> delimiters_{'\t'};
   /// Set of characters which interrupt the parsing of input data.
@@ -302,9 +594,17 @@ class FieldParser {
   /// Indicates whether violation of requested field numbers should result in
   /// the read fields to be ignored.
   bool ignore_underfull_data_{true};
+  /// Indicates whether strings of previously read fields are reused.
+  bool reuse_fields_{false};
   /// A map from field numbers (starting at 1) to field parsing functions which
   /// are applied to the corresponding fields.
   std::unordered_map<int, std::function<void(std::string*)>> field_parsers_;
+  /// Field parsers indexed by field number minus one, compiled from
+  /// `field_parsers_`. Fields without a parser map to an empty function.
+  std::vector<std::function<void(std::string*)>> field_plan_;
+  /// Classes of characters compiled from `delimiters_`, `terminators_`, and
+  /// `masked_`.
+  CharClassTable char_classes_;
 };
 
 } // namespace stl_ios_utilities
@@ -0,0 +1,128 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#ifndef STL_IOS_UTILITIES_FIELD_VIEW_H_
+#define STL_IOS_UTILITIES_FIELD_VIEW_H_
+
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+namespace stl_ios_utilities {
+
+/// @brief A non-owning reference to the characters of a field.
+///
+/// @details Produced by parsers that do not copy fields out of their input,
+///  such as `DelimitedRowParser::parse_row` with an
+///  *std::vector<FieldView>* argument. A `FieldView` is only valid as long as
+///  the memory it refers to; parsers document how long that is.
+///
+///  `FieldView` is trivially copyable.
+///
+class FieldView {
+ public:
+  /// @name Constructors:
+  ///
+  /// @{
+
+  /// @brief Refers to an empty field.
+  ///
+  FieldView() = default;
+
+  /// @brief Refers to the `size` characters starting at `data`.
+  ///
+  FieldView(const char* data, std::size_t size) : data_{data}, size_{size} {}
+  /// @}
+
+  /// @name Accessors:
+  ///
+  /// @{
+
+  /// @brief Returns a pointer to the first character of the field.
+  ///
+  inline const char* data() const {return data_;}
+
+  /// @brief Returns the number of characters in the field.
+  ///
+  inline std::size_t size() const {return size_;}
+
+  /// @brief Indicates whether the field is empty.
+  ///
+  inline bool empty() const {return size_ == 0;}
+
+  /// @brief Returns a pointer to the first character of the field.
+  ///
+  inline const char* begin() const {return data_;}
+
+  /// @brief Returns a pointer past the last character of the field.
+  ///
+  inline const char* end() const {return data_ + size_;}
+
+  /// @brief Returns the character at position `i`.
+  ///
+  inline char operator[](std::size_t i) const {return data_[i];}
+
+  /// @brief Returns a copy of the field's characters.
+  ///
+  inline std::string str() const {return std::string(data_, size_);}
+  /// @}
+
+ private:
+  const char* data_{nullptr};
+  std::size_t size_{0};
+};
+
+/// @brief Indicates whether both fields consist of the same characters.
+///
+inline bool operator==(const FieldView& lhs, const FieldView& rhs) {
+  return (lhs.size() == rhs.size()
+          && (lhs.size() == 0
+              || std::memcmp(lhs.data(), rhs.data(), lhs.size()) == 0));
+}
+
+inline bool operator!=(const FieldView& lhs, const FieldView& rhs) {
+  return !(lhs == rhs);
+}
+
+inline bool operator==(const FieldView& lhs, const std::string& rhs) {
+  return lhs == FieldView(rhs.data(), rhs.size());
+}
+
+inline bool operator==(const std::string& lhs, const FieldView& rhs) {
+  return rhs == lhs;
+}
+
+inline bool operator!=(const FieldView& lhs, const std::string& rhs) {
+  return !(lhs == rhs);
+}
+
+inline bool operator!=(const std::string& lhs, const FieldView& rhs) {
+  return !(rhs == lhs);
+}
+
+/// @brief Writes the field's characters to `os`.
+///
+inline std::ostream& operator<<(std::ostream& os, const FieldView& field) {
+  return os.write(field.data(), field.size());
+}
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_FIELD_VIEW_H_
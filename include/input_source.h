@@ -0,0 +1,234 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef STL_IOS_UTILITIES_INPUT_SOURCE_H_
+#define STL_IOS_UTILITIES_INPUT_SOURCE_H_
+
+#include <climits>
+#include <cstddef>
+#include <ios>
+#include <istream>
+#include <streambuf>
+
+namespace stl_ios_utilities {
+
+namespace internal {
+
+// Exposes the get area of an arbitrary `std::streambuf`. Pointers to protected
+// members may be formed through a derived class and then applied to any object
+// of the base class.
+class StreambufAccess : public std::streambuf {
+ public:
+  static char* next(std::streambuf* buf) {
+    return (buf->*&StreambufAccess::gptr)();
+  }
+  static char* end(std::streambuf* buf) {
+    return (buf->*&StreambufAccess::egptr)();
+  }
+  static void advance(std::streambuf* buf, int n) {
+    (buf->*&StreambufAccess::gbump)(n);
+  }
+};
+
+} // namespace internal
+
+/// @brief Input source reading blocks of characters directly out of the buffer
+///  of an *std::istream* object.
+///
+/// @details The source exposes the characters currently buffered by the
+///  stream's *std::streambuf* as a contiguous window which parsers tokenize in
+///  place. Characters are only extracted from the stream once they were
+///  consumed, so that the stream is left exactly where parsing stopped and can
+///  be used with other stream operations in between.
+///
+///  The stream's state is updated as *std::istream::get* would: `eofbit` and
+///  `failbit` are set when the end of the stream is reached, and `badbit` is
+///  set (and the exception rethrown, if requested via
+///  *std::ios::exceptions*) when the underlying *std::streambuf* throws.
+///
+///  Streams whose buffer does not expose a get area are read one character at
+///  a time.
+///
+class StreamSource {
+ public:
+  /// @name Constructors:
+  ///
+  /// @{
+
+  /// @brief Prepares `is` for input the way *std::istream::get* does.
+  ///
+  explicit StreamSource(std::istream* is)
+      : is_{is}, buf_{is->rdbuf()} {
+    std::istream::sentry sentry{*is, true};
+    good_ = static_cast<bool>(sentry);
+    if (good_) {
+      sync_window();
+    }
+  }
+  /// @}
+
+  /// @name Window operations:
+  ///
+  /// @{
+
+  /// @brief Beginning of the currently available characters.
+  ///
+  inline const char* begin() const {return begin_;}
+
+  /// @brief End of the currently available characters.
+  ///
+  inline const char* end() const {return end_;}
+
+  /// @brief Extracts the first `n` characters of the window from the stream.
+  ///
+  /// @details The characters remain valid until the next call of `refill`.
+  ///
+  void consume(std::size_t n) {
+    begin_ += n;
+    if (single_) {
+      return;
+    }
+    while (n > static_cast<std::size_t>(INT_MAX)) {
+      internal::StreambufAccess::advance(buf_, INT_MAX);
+      n -= INT_MAX;
+    }
+    internal::StreambufAccess::advance(buf_, static_cast<int>(n));
+  }
+
+  /// @brief Makes more characters available once the window was consumed.
+  ///
+  /// @return Returns `false` if the end of the stream was reached or the stream
+  ///  could not be read from.
+  ///
+  bool refill() {
+    if (!good_) {
+      return false;
+    }
+    try {
+      single_ = false;
+      if (std::streambuf::traits_type::eq_int_type(
+              buf_->sgetc(), std::streambuf::traits_type::eof())) {
+        good_ = false;
+        is_->setstate(std::ios_base::eofbit | std::ios_base::failbit);
+        return false;
+      }
+      sync_window();
+      if (begin_ == end_) {
+        // unbuffered stream; take a single character
+        single_char_ = std::streambuf::traits_type::to_char_type(
+            buf_->sbumpc());
+        single_ = true;
+        begin_ = &single_char_;
+        end_ = begin_ + 1;
+      }
+    } catch (...) {
+      good_ = false;
+      if (is_->exceptions() & std::ios_base::badbit) {
+        try {
+          is_->setstate(std::ios_base::badbit);
+        } catch (const std::ios_base::failure&) {}
+        throw;
+      }
+      is_->setstate(std::ios_base::badbit);
+      return false;
+    }
+    return true;
+  }
+  /// @}
+
+ private:
+  void sync_window() {
+    begin_ = internal::StreambufAccess::next(buf_);
+    end_ = internal::StreambufAccess::end(buf_);
+  }
+
+  std::istream* is_;
+  std::streambuf* buf_;
+  bool good_{false};
+  bool single_{false};
+  char single_char_{'\0'};
+  const char* begin_{nullptr};
+  const char* end_{nullptr};
+};
+
+/// @brief Input source reading from a contiguous range of characters in
+///  memory, such as a `MappedFile`.
+///
+/// @details The whole range is exposed as a single window which parsers
+///  tokenize in place, so that no characters are copied before they are
+///  parsed. Once a parser attempted to read past the end of the range, the
+///  source evaluates to `false`, mirroring the `eofbit` and `failbit` of an
+///  *std::istream* object.
+///
+///  The range must outlive the source. `MemorySource` is copyable and
+///  movable.
+///
+class MemorySource {
+ public:
+  /// @name Constructors:
+  ///
+  /// @{
+
+  /// @brief Reads the `size` characters starting at `data`.
+  ///
+  MemorySource(const char* data, std::size_t size)
+      : begin_{data}, end_{data + size} {}
+  /// @}
+
+  /// @name Window operations:
+  ///
+  /// @{
+
+  /// @brief Beginning of the characters not yet consumed.
+  ///
+  inline const char* begin() const {return begin_;}
+
+  /// @brief End of the range.
+  ///
+  inline const char* end() const {return end_;}
+
+  /// @brief Discards the first `n` characters of the window.
+  ///
+  inline void consume(std::size_t n) {begin_ += n;}
+
+  /// @brief Records an attempt to read past the end of the range.
+  ///
+  /// @return Always returns `false`, as there are no more characters.
+  ///
+  inline bool refill() {
+    exhausted_ = true;
+    return false;
+  }
+  /// @}
+
+  /// @brief Returns `false` if a parser attempted to read past the end of the
+  ///  range.
+  ///
+  inline explicit operator bool() const {return !exhausted_;}
+
+ private:
+  const char* begin_;
+  const char* end_;
+  bool exhausted_{false};
+};
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_INPUT_SOURCE_H_
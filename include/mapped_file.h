@@ -0,0 +1,110 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#ifndef STL_IOS_UTILITIES_MAPPED_FILE_H_
+#define STL_IOS_UTILITIES_MAPPED_FILE_H_
+
+#include "input_source.h"
+
+#include <cstddef>
+#include <string>
+
+namespace stl_ios_utilities {
+
+/// @brief A read-only file mapped into memory.
+///
+/// @details The file is mapped with *mmap* and the kernel is advised that it
+///  will be read sequentially, so that parsers reading from a `MemorySource`
+///  over the mapping tokenize the file straight out of the page cache. On
+///  platforms without *mmap* the file is read into memory instead.
+///
+///  Throws an exception of type `stl_ios_utilities::FileError` if the file
+///  cannot be opened or mapped.
+///
+///  `MappedFile` is movable, but not copyable.
+///
+/// @usage
+///
+/// ```
+/// stl_ios_utilities::MappedFile file{"data.tsv"};
+/// stl_ios_utilities::MemorySource source{file.source()};
+/// stl_ios_utilities::DelimitedRowParser parser;
+/// std::vector<std::string> row;
+/// while (parser.parse_row(&source, &row)) {
+///   // process row
+/// }
+/// ```
+///
+class MappedFile {
+ public:
+  /// @name Constructors:
+  ///
+  /// @{
+
+  /// @brief Creates an empty mapping, which another one may be moved into.
+  ///
+  MappedFile() = default;
+
+  /// @brief Maps the file at `path` into memory.
+  ///
+  explicit MappedFile(const std::string& path);
+
+  MappedFile(const MappedFile& other) = delete;
+  MappedFile(MappedFile&& other) noexcept;
+  /// @}
+
+  /// @name Assignment:
+  ///
+  /// @{
+
+  MappedFile& operator=(const MappedFile& other) = delete;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+  /// @}
+
+  ~MappedFile();
+
+  /// @name Accessors:
+  ///
+  /// @{
+
+  /// @brief Returns a pointer to the first character of the file.
+  ///
+  inline const char* data() const {return data_;}
+
+  /// @brief Returns the number of characters in the file.
+  ///
+  inline std::size_t size() const {return size_;}
+
+  /// @brief Returns an input source reading the whole file.
+  ///
+  inline MemorySource source() const {return MemorySource{data_, size_};}
+  /// @}
+
+ private:
+  void release();
+
+  const char* data_{nullptr};
+  std::size_t size_{0};
+  /// Holds the file's contents where *mmap* is unavailable.
+  std::string contents_;
+};
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_MAPPED_FILE_H_
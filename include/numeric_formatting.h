@@ -0,0 +1,556 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef STL_IOS_UTILITIES_NUMERIC_FORMATTING_H_
+#define STL_IOS_UTILITIES_NUMERIC_FORMATTING_H_
+
+#include "numeric_parsing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+namespace stl_ios_utilities {
+
+namespace internal {
+
+// The numbers 0 to 99 as two digits each, back to back.
+inline const char* digit_pairs() {
+  static const char kPairs[201]{
+      "00010203040506070809101112131415161718192021222324252627282930313233"
+      "34353637383940414243444546474849505152535455565758596061626364656667"
+      "6869707172737475767778798081828384858687888990919293949596979899"};
+  return kPairs;
+}
+
+// Writes the decimal digits of `value` to the characters right before `end`
+// and returns a pointer to the first of them. Two digits are produced per
+// division.
+inline char* format_unsigned(std::uint64_t value, char* end) {
+  const char* pairs{digit_pairs()};
+  while (value >= 100) {
+    std::size_t pair{static_cast<std::size_t>(value % 100)};
+    value /= 100;
+    end -= 2;
+    std::memcpy(end, pairs + 2 * pair, 2);
+  }
+  if (value >= 10) {
+    end -= 2;
+    std::memcpy(end, pairs + 2 * value, 2);
+  } else {
+    *(--end) = static_cast<char>('0' + value);
+  }
+  return end;
+}
+
+// Appends the decimal representation of `value` to `out`.
+template <typename T>
+void append_integer(T value, std::string* out) {
+  using Unsigned = typename std::make_unsigned<T>::type;
+  char buffer[24];
+  char* end{buffer + sizeof(buffer)};
+  bool negative{value < T{0}};
+  // the magnitude of the most negative value only fits the unsigned type
+  Unsigned magnitude{negative
+                     ? static_cast<Unsigned>(0 - static_cast<Unsigned>(value))
+                     : static_cast<Unsigned>(value)};
+  char* begin{format_unsigned(magnitude, end)};
+  if (negative) {
+    *(--begin) = '-';
+  }
+  out->append(begin, end);
+}
+
+// A number `f` times 2^`e` with a 64-bit significand, on which the Grisu
+// algorithm computes (Loitsch, "Printing Floating-Point Numbers Quickly and
+// Accurately with Integers", PLDI 2010).
+struct DiyFp {
+  std::uint64_t f;
+  int e;
+};
+
+// Returns the product of `x` and `y`, rounded to the upper 64 bits of the
+// product of their significands.
+inline DiyFp multiply(DiyFp x, DiyFp y) {
+  constexpr std::uint64_t kLow{0xFFFFFFFFu};
+  std::uint64_t a{x.f >> 32};
+  std::uint64_t b{x.f & kLow};
+  std::uint64_t c{y.f >> 32};
+  std::uint64_t d{y.f & kLow};
+  std::uint64_t ac{a * c};
+  std::uint64_t bc{b * c};
+  std::uint64_t ad{a * d};
+  std::uint64_t bd{b * d};
+  std::uint64_t middle{(bd >> 32) + (ad & kLow) + (bc & kLow)
+                       + (std::uint64_t{1} << 31)};
+  return DiyFp{ac + (ad >> 32) + (bc >> 32) + (middle >> 32),
+               x.e + y.e + 64};
+}
+
+// Shifts the significand of `x` until its highest bit is set.
+inline DiyFp normalize(DiyFp x) {
+  while ((x.f & (std::uint64_t{0xFFC} << 52)) == 0) {
+    x.f <<= 10;
+    x.e -= 10;
+  }
+  while ((x.f & (std::uint64_t{1} << 63)) == 0) {
+    x.f <<= 1;
+    x.e -= 1;
+  }
+  return x;
+}
+
+// A normalized power of ten, 10^`decimal_exponent` ~ `significand` times
+// 2^`binary_exponent`.
+struct CachedPower {
+  std::uint64_t significand;
+  int binary_exponent;
+  int decimal_exponent;
+};
+
+// Every eighth power of ten from 10^-348 to 10^340, rounded to 64 bits.
+inline const CachedPower* cached_powers() {
+  static const CachedPower kPowers[87]{
+      {0xfa8fd5a0081c0288ULL, -1220, -348},
+      {0xbaaee17fa23ebf76ULL, -1193, -340},
+      {0x8b16fb203055ac76ULL, -1166, -332},
+      {0xcf42894a5dce35eaULL, -1140, -324},
+      {0x9a6bb0aa55653b2dULL, -1113, -316},
+      {0xe61acf033d1a45dfULL, -1087, -308},
+      {0xab70fe17c79ac6caULL, -1060, -300},
+      {0xff77b1fcbebcdc4fULL, -1034, -292},
+      {0xbe5691ef416bd60cULL, -1007, -284},
+      {0x8dd01fad907ffc3cULL, -980, -276},
+      {0xd3515c2831559a83ULL, -954, -268},
+      {0x9d71ac8fada6c9b5ULL, -927, -260},
+      {0xea9c227723ee8bcbULL, -901, -252},
+      {0xaecc49914078536dULL, -874, -244},
+      {0x823c12795db6ce57ULL, -847, -236},
+      {0xc21094364dfb5637ULL, -821, -228},
+      {0x9096ea6f3848984fULL, -794, -220},
+      {0xd77485cb25823ac7ULL, -768, -212},
+      {0xa086cfcd97bf97f4ULL, -741, -204},
+      {0xef340a98172aace5ULL, -715, -196},
+      {0xb23867fb2a35b28eULL, -688, -188},
+      {0x84c8d4dfd2c63f3bULL, -661, -180},
+      {0xc5dd44271ad3cdbaULL, -635, -172},
+      {0x936b9fcebb25c996ULL, -608, -164},
+      {0xdbac6c247d62a584ULL, -582, -156},
+      {0xa3ab66580d5fdaf6ULL, -555, -148},
+      {0xf3e2f893dec3f126ULL, -529, -140},
+      {0xb5b5ada8aaff80b8ULL, -502, -132},
+      {0x87625f056c7c4a8bULL, -475, -124},
+      {0xc9bcff6034c13053ULL, -449, -116},
+      {0x964e858c91ba2655ULL, -422, -108},
+      {0xdff9772470297ebdULL, -396, -100},
+      {0xa6dfbd9fb8e5b88fULL, -369, -92},
+      {0xf8a95fcf88747d94ULL, -343, -84},
+      {0xb94470938fa89bcfULL, -316, -76},
+      {0x8a08f0f8bf0f156bULL, -289, -68},
+      {0xcdb02555653131b6ULL, -263, -60},
+      {0x993fe2c6d07b7facULL, -236, -52},
+      {0xe45c10c42a2b3b06ULL, -210, -44},
+      {0xaa242499697392d3ULL, -183, -36},
+      {0xfd87b5f28300ca0eULL, -157, -28},
+      {0xbce5086492111aebULL, -130, -20},
+      {0x8cbccc096f5088ccULL, -103, -12},
+      {0xd1b71758e219652cULL, -77, -4},
+      {0x9c40000000000000ULL, -50, 4},
+      {0xe8d4a51000000000ULL, -24, 12},
+      {0xad78ebc5ac620000ULL, 3, 20},
+      {0x813f3978f8940984ULL, 30, 28},
+      {0xc097ce7bc90715b3ULL, 56, 36},
+      {0x8f7e32ce7bea5c70ULL, 83, 44},
+      {0xd5d238a4abe98068ULL, 109, 52},
+      {0x9f4f2726179a2245ULL, 136, 60},
+      {0xed63a231d4c4fb27ULL, 162, 68},
+      {0xb0de65388cc8ada8ULL, 189, 76},
+      {0x83c7088e1aab65dbULL, 216, 84},
+      {0xc45d1df942711d9aULL, 242, 92},
+      {0x924d692ca61be758ULL, 269, 100},
+      {0xda01ee641a708deaULL, 295, 108},
+      {0xa26da3999aef774aULL, 322, 116},
+      {0xf209787bb47d6b85ULL, 348, 124},
+      {0xb454e4a179dd1877ULL, 375, 132},
+      {0x865b86925b9bc5c2ULL, 402, 140},
+      {0xc83553c5c8965d3dULL, 428, 148},
+      {0x952ab45cfa97a0b3ULL, 455, 156},
+      {0xde469fbd99a05fe3ULL, 481, 164},
+      {0xa59bc234db398c25ULL, 508, 172},
+      {0xf6c69a72a3989f5cULL, 534, 180},
+      {0xb7dcbf5354e9beceULL, 561, 188},
+      {0x88fcf317f22241e2ULL, 588, 196},
+      {0xcc20ce9bd35c78a5ULL, 614, 204},
+      {0x98165af37b2153dfULL, 641, 212},
+      {0xe2a0b5dc971f303aULL, 667, 220},
+      {0xa8d9d1535ce3b396ULL, 694, 228},
+      {0xfb9b7cd9a4a7443cULL, 720, 236},
+      {0xbb764c4ca7a44410ULL, 747, 244},
+      {0x8bab8eefb6409c1aULL, 774, 252},
+      {0xd01fef10a657842cULL, 800, 260},
+      {0x9b10a4e5e9913129ULL, 827, 268},
+      {0xe7109bfba19c0c9dULL, 853, 276},
+      {0xac2820d9623bf429ULL, 880, 284},
+      {0x80444b5e7aa7cf85ULL, 907, 292},
+      {0xbf21e44003acdd2dULL, 933, 300},
+      {0x8e679c2f5e44ff8fULL, 960, 308},
+      {0xd433179d9c8cb841ULL, 986, 316},
+      {0x9e19db92b4e31ba9ULL, 1013, 324},
+      {0xeb96bf6ebadf77d9ULL, 1039, 332},
+      {0xaf87023b9bf0ee6bULL, 1066, 340}};
+  return kPowers;
+}
+
+// Returns the cached power of ten by which a normalized number with binary
+// exponent `e` is scaled so that the binary exponent of the product lies
+// between -60 and -32.
+inline const CachedPower& cached_power(int e) {
+  int min_exponent{-60 - (e + 64)};
+  int k{static_cast<int>(std::ceil((min_exponent + 63) * 0.30102999566398114))};
+  return cached_powers()[(348 + k - 1) / 8 + 1];
+}
+
+// Moves the last of the `count` digits in `digits` towards `w`, as long as the
+// result stays within the unsafe interval, and returns whether the digits are
+// the closest ones to `w` of their length in the safe interval, given the
+// distances of `w` and of the digits from the upper bound of the unsafe
+// interval.
+inline bool round_weed(char* digits, int count, std::uint64_t distance_high_w,
+                       std::uint64_t unsafe_interval, std::uint64_t rest,
+                       std::uint64_t ten_kappa, std::uint64_t unit) {
+  std::uint64_t small_distance{distance_high_w - unit};
+  std::uint64_t big_distance{distance_high_w + unit};
+  while (rest < small_distance && unsafe_interval - rest >= ten_kappa
+         && (rest + ten_kappa < small_distance
+             || small_distance - rest >= rest + ten_kappa - small_distance)) {
+    --digits[count - 1];
+    rest += ten_kappa;
+  }
+  // the digits are ambiguous if the next lower ones could be closer to `w`
+  if (rest < big_distance && unsafe_interval - rest >= ten_kappa
+      && (rest + ten_kappa < big_distance
+          || big_distance - rest > rest + ten_kappa - big_distance)) {
+    return false;
+  }
+  return 2 * unit <= rest && rest <= unsafe_interval - 4 * unit;
+}
+
+// Generates the shortest digits within (`low`, `high`) of scaled numbers
+// whose binary exponents lie between -60 and -32, closest to `w`. Stores
+// their count and the decimal exponent of the digit after the last one, and
+// returns `false` if the imprecision of the scaled numbers makes the digits
+// uncertain.
+inline bool generate_digits(DiyFp low, DiyFp w, DiyFp high, char* digits,
+                            int* count, int* kappa) {
+  // the bounds are off by at most one unit each
+  std::uint64_t unit{1};
+  DiyFp too_low{low.f - unit, low.e};
+  DiyFp too_high{high.f + unit, high.e};
+  std::uint64_t unsafe_interval{too_high.f - too_low.f};
+  int shift{-w.e};
+  std::uint64_t one{std::uint64_t{1} << shift};
+  std::uint32_t integrals{static_cast<std::uint32_t>(too_high.f >> shift)};
+  std::uint64_t fractionals{too_high.f & (one - 1)};
+  std::uint32_t divisor{1};
+  (*kappa) = 1;
+  while (divisor <= integrals / 10) {
+    divisor *= 10;
+    ++(*kappa);
+  }
+  (*count) = 0;
+  while (*kappa > 0) {
+    digits[(*count)++] = static_cast<char>('0' + integrals / divisor);
+    integrals %= divisor;
+    --(*kappa);
+    std::uint64_t rest{(static_cast<std::uint64_t>(integrals) << shift)
+                       + fractionals};
+    if (rest < unsafe_interval) {
+      return round_weed(digits, *count, too_high.f - w.f, unsafe_interval,
+                        rest, static_cast<std::uint64_t>(divisor) << shift,
+                        unit);
+    }
+    divisor /= 10;
+  }
+  while (true) {
+    fractionals *= 10;
+    unit *= 10;
+    unsafe_interval *= 10;
+    digits[(*count)++] = static_cast<char>('0' + (fractionals >> shift));
+    fractionals &= one - 1;
+    --(*kappa);
+    if (fractionals < unsafe_interval) {
+      return round_weed(digits, *count, (too_high.f - w.f) * unit,
+                        unsafe_interval, fractionals, one, unit);
+    }
+  }
+}
+
+// Stores the shortest digits which read back as the positive, finite
+// `value` of an IEEE 754 type with `Bits` as its representation, their count,
+// and the decimal exponent of the first digit, using the Grisu3 algorithm.
+// Returns `false` for the about 0.5% of values for which it cannot prove the
+// digits to be the shortest and closest ones.
+template <typename Bits, typename T>
+bool grisu_digits(T value, char* digits, int* count, int* exponent) {
+  constexpr int kSignificandBits{std::numeric_limits<T>::digits - 1};
+  constexpr int kBias{std::numeric_limits<T>::max_exponent - 1
+                      + kSignificandBits};
+  constexpr Bits kHidden{Bits{1} << kSignificandBits};
+  Bits bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  int biased{static_cast<int>((bits >> kSignificandBits)
+                              & ((Bits{1} << (sizeof(Bits) * 8 - 1
+                                              - kSignificandBits)) - 1))};
+  DiyFp v{bits & (kHidden - 1), 1 - kBias};
+  if (biased > 0) {
+    v.f += kHidden;
+    v.e = biased - kBias;
+  }
+  // the boundaries halfway to the neighboring values, the lower of which is
+  // closer at powers of two
+  DiyFp plus{normalize(DiyFp{(v.f << 1) + 1, v.e - 1})};
+  DiyFp minus{(v.f << 1) - 1, v.e - 1};
+  if (v.f == kHidden && biased > 1) {
+    minus = DiyFp{(v.f << 2) - 1, v.e - 2};
+  }
+  minus.f <<= minus.e - plus.e;
+  minus.e = plus.e;
+  DiyFp w{normalize(v)};
+
+  const CachedPower& power = cached_power(w.e);
+  DiyFp scale{power.significand, power.binary_exponent};
+  int kappa;
+  if (!generate_digits(multiply(minus, scale), multiply(w, scale),
+                       multiply(plus, scale), digits, count, &kappa)) {
+    return false;
+  }
+  (*exponent) = kappa - power.decimal_exponent + (*count) - 1;
+  return true;
+}
+
+inline bool shortest_digits(double value, char* digits, int* count,
+                            int* exponent) {
+  return grisu_digits<std::uint64_t>(value, digits, count, exponent);
+}
+
+inline bool shortest_digits(float value, char* digits, int* count,
+                            int* exponent) {
+  return grisu_digits<std::uint32_t>(value, digits, count, exponent);
+}
+
+inline bool shortest_digits(long double, char*, int*, int*) {
+  return false;
+}
+
+// Prints `value` in scientific notation with `precision` digits after the
+// decimal point to `buffer` and returns the number of characters printed.
+inline int print_scientific(double value, int precision, char* buffer,
+                            std::size_t size) {
+  return std::snprintf(buffer, size, "%.*e", precision, value);
+}
+
+inline int print_scientific(long double value, int precision, char* buffer,
+                            std::size_t size) {
+  return std::snprintf(buffer, size, "%.*Le", precision, value);
+}
+
+// Writes the sign, the `count` significant digits in `digits`, and the
+// decimal `exponent` of the first digit as a number to `out`, in fixed
+// notation unless the exponent is below -4 or not below `max_exponent`, and
+// returns a pointer past the last character written.
+inline char* layout_decimal(bool negative, const char* digits, int count,
+                            int exponent, int max_exponent, char* out) {
+  if (negative) {
+    *out++ = '-';
+  }
+  if (exponent < -4 || exponent >= max_exponent) {
+    *out++ = digits[0];
+    if (count > 1) {
+      *out++ = '.';
+      out = std::copy(digits + 1, digits + count, out);
+    }
+    *out++ = 'e';
+    *out++ = exponent < 0 ? '-' : '+';
+    unsigned magnitude{static_cast<unsigned>(exponent < 0 ? -exponent
+                                                          : exponent)};
+    if (magnitude < 10) {
+      *out++ = '0';
+    }
+    char buffer[8];
+    char* end{buffer + sizeof(buffer)};
+    out = std::copy(format_unsigned(magnitude, end), end, out);
+  } else if (exponent < 0) {
+    *out++ = '0';
+    *out++ = '.';
+    out = std::fill_n(out, -exponent - 1, '0');
+    out = std::copy(digits, digits + count, out);
+  } else if (count <= exponent + 1) {
+    out = std::copy(digits, digits + count, out);
+    out = std::fill_n(out, exponent + 1 - count, '0');
+  } else {
+    out = std::copy(digits, digits + exponent + 1, out);
+    *out++ = '.';
+    out = std::copy(digits + exponent + 1, digits + count, out);
+  }
+  return out;
+}
+
+// Prints `value` in scientific notation with `precision` significant digits
+// and stores the sign, the digits, and the decimal exponent of the first
+// digit. `digits` must hold `precision` characters.
+template <typename T>
+void print_digits(T value, int precision, bool* negative, char* digits,
+                  int* exponent) {
+  using Printed = typename std::conditional<
+      std::is_same<T, long double>::value, long double, double>::type;
+  char printed[64];
+  int length{print_scientific(static_cast<Printed>(value), precision - 1,
+                              printed, sizeof(printed))};
+  // `[-]d<decimal point>ddd...e<sign>dd`, with the locale's decimal point
+  (*negative) = printed[0] == '-';
+  int count{0};
+  int position{0};
+  for (; printed[position] != 'e'; ++position) {
+    if (is_digit(printed[position]) && count < precision) {
+      digits[count++] = printed[position];
+    }
+  }
+  bool negative_exponent{printed[++position] == '-'};
+  (*exponent) = 0;
+  for (++position; position < length; ++position) {
+    (*exponent) = (*exponent) * 10 + (printed[position] - '0');
+  }
+  (*exponent) = negative_exponent ? -(*exponent) : (*exponent);
+}
+
+// Appends the representation of `value` with the fewest significant digits
+// which `parse_floating_point` reads back as `value`, or `nan`, `inf`, or
+// `-inf`.
+//
+// The digits of `float` and `double` values are generated by Grisu3 (see
+// `grisu_digits`). For the values it rejects, and for `long double`, the C
+// library prints the maximum number of digits, of which only the digits and
+// the exponent are read, so that the locale does not matter. Candidates with
+// fewer digits are rounded from those, which yields the correctly rounded
+// candidate unless the dropped digits are exactly a half, in which case the
+// candidate is printed by the C library as well, and the first candidate
+// read back as `value` is the shortest. Numbers are laid out without the
+// locale.
+template <typename T>
+void append_floating_point(T value, std::string* out) {
+  if (std::isnan(value)) {
+    out->append("nan");
+    return;
+  } else if (std::isinf(value)) {
+    out->append(value < 0 ? "-inf" : "inf");
+    return;
+  }
+  constexpr int kMaxDigits{std::numeric_limits<T>::max_digits10};
+  bool negative{std::signbit(value)};
+  char text[64];
+  char candidate[24];
+  int count;
+  int exponent;
+  if (value == 0) {
+    out->append(negative ? "-0" : "0");
+    return;
+  } else if (shortest_digits(negative ? -value : value, candidate, &count,
+                             &exponent)) {
+    while (count > 1 && candidate[count - 1] == '0') {
+      --count;
+    }
+    out->append(text, layout_decimal(negative, candidate, count, exponent,
+                                     kMaxDigits, text));
+    return;
+  }
+
+  char digits[kMaxDigits];
+  print_digits(value, kMaxDigits, &negative, digits, &exponent);
+  for (int precision = 1; precision <= kMaxDigits; ++precision) {
+    int candidate_exponent{exponent};
+    std::copy(digits, digits + precision, candidate);
+    if (precision < kMaxDigits && digits[precision] >= '5') {
+      bool half{digits[precision] == '5'
+                && std::count(digits + precision + 1, digits + kMaxDigits,
+                              '0') == kMaxDigits - precision - 1};
+      if (half) {
+        print_digits(value, precision, &negative, candidate,
+                     &candidate_exponent);
+      } else {
+        int i{precision - 1};
+        while (i >= 0 && candidate[i] == '9') {
+          candidate[i--] = '0';
+        }
+        if (i >= 0) {
+          ++candidate[i];
+        } else {
+          candidate[0] = '1';
+          ++candidate_exponent;
+        }
+      }
+    }
+    int significant{precision};
+    while (significant > 1 && candidate[significant - 1] == '0') {
+      --significant;
+    }
+    char* end{layout_decimal(negative, candidate, significant,
+                             candidate_exponent, kMaxDigits, text)};
+    T parsed;
+    // the maximum number of digits always reads back as `value`
+    if (precision == kMaxDigits
+        || (parse_floating_point(text, end, &parsed) && parsed == value)) {
+      out->append(text, end);
+      return;
+    }
+  }
+}
+
+// Appends `units` times 10^-`scale` with exactly `scale` digits after the
+// decimal point.
+inline void append_fixed_point(std::int64_t units, unsigned scale,
+                               std::string* out) {
+  std::uint64_t magnitude{units < 0
+                          ? 0 - static_cast<std::uint64_t>(units)
+                          : static_cast<std::uint64_t>(units)};
+  std::uint64_t divisor{integer_powers_of_ten()[scale]};
+  if (units < 0) {
+    out->push_back('-');
+  }
+  char buffer[24];
+  char* end{buffer + sizeof(buffer)};
+  out->append(format_unsigned(magnitude / divisor, end), end);
+  if (scale > 0) {
+    // leading zeros of the fraction are produced by the added power of ten
+    char* fraction{format_unsigned(magnitude % divisor + divisor, end)};
+    out->push_back('.');
+    out->append(fraction + 1, end);
+  }
+}
+
+} // namespace internal
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_NUMERIC_FORMATTING_H_
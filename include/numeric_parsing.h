@@ -0,0 +1,407 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef STL_IOS_UTILITIES_NUMERIC_PARSING_H_
+#define STL_IOS_UTILITIES_NUMERIC_PARSING_H_
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+// Eight digits are validated and converted at once by arithmetic on a 64-bit
+// word holding them, which assumes the first character in the lowest byte.
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__) \
+    && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define STL_IOS_UTILITIES_SWAR_DIGITS
+#endif
+
+namespace stl_ios_utilities {
+
+namespace internal {
+
+// Powers of ten which are exactly representable as `double`.
+constexpr int kMaxExactPowerOfTen{22};
+
+inline const double* exact_powers_of_ten() {
+  static const double kPowers[kMaxExactPowerOfTen + 1]{
+      1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+      1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  return kPowers;
+}
+
+// Powers of ten which fit into `std::uint64_t`.
+inline const std::uint64_t* integer_powers_of_ten() {
+  static const std::uint64_t kPowers[20]{
+      1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+      10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+      100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+      100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+      100000000000000000ULL, 1000000000000000000ULL,
+      10000000000000000000ULL};
+  return kPowers;
+}
+
+inline bool is_digit(char c) {
+  return static_cast<unsigned>(c - '0') <= 9;
+}
+
+// Stores the value of the eight characters at `position` in `value` if all of
+// them are decimal digits. Returns `false` otherwise.
+inline bool parse_eight_digits(const char* position, std::uint32_t* value) {
+#ifdef STL_IOS_UTILITIES_SWAR_DIGITS
+  std::uint64_t chunk;
+  std::memcpy(&chunk, position, sizeof(chunk));
+  // a byte is a digit if its high nibble is 3 and stays 3 when adding 6
+  if (((chunk & 0xF0F0F0F0F0F0F0F0ULL)
+       | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4))
+      != 0x3333333333333333ULL) {
+    return false;
+  }
+  // combines pairs, then quadruples of digits, then both halves
+  chunk -= 0x3030303030303030ULL;
+  chunk = (chunk * 10) + (chunk >> 8);
+  chunk = (((chunk & 0x000000FF000000FFULL) * 0x000F424000000064ULL)
+           + (((chunk >> 16) & 0x000000FF000000FFULL)
+              * 0x0000271000000001ULL)) >> 32;
+  (*value) = static_cast<std::uint32_t>(chunk);
+  return true;
+#else
+  std::uint32_t result{0};
+  for (int i = 0; i < 8; ++i) {
+    if (!is_digit(position[i])) {
+      return false;
+    }
+    result = result * 10 + static_cast<std::uint32_t>(position[i] - '0');
+  }
+  (*value) = result;
+  return true;
+#endif
+}
+
+// Reads at most `max_digits` decimal digits beginning at `*position`,
+// appending them to `*value`, and advances `*position` past them. Returns the
+// number of digits read. The caller bounds `max_digits` so that `*value`
+// cannot overflow.
+inline int read_digits(const char** position, const char* end, int max_digits,
+                       std::uint64_t* value) {
+  const char* current{*position};
+  const char* limit{end - current > max_digits ? current + max_digits : end};
+  std::uint64_t result{*value};
+  std::uint32_t eight;
+  while (limit - current >= 8 && parse_eight_digits(current, &eight)) {
+    result = result * 100000000ULL + eight;
+    current += 8;
+  }
+  while (current != limit && is_digit(*current)) {
+    result = result * 10 + static_cast<unsigned>(*current - '0');
+    ++current;
+  }
+  int count{static_cast<int>(current - *position)};
+  (*position) = current;
+  (*value) = result;
+  return count;
+}
+
+// Converts decimal digits in [first, last), preceded by an optional sign, to
+// an integer. Returns `false` if they do not represent a value of type `T`.
+template <typename T>
+bool parse_integer(const char* first, const char* last, T* value) {
+  const char* position{first};
+  bool negative{false};
+  if (position != last && (*position == '-' || *position == '+')) {
+    negative = (*position == '-');
+    ++position;
+  }
+  if (position == last || (negative && !std::is_signed<T>::value)) {
+    return false;
+  }
+  while (position != last && *position == '0') {
+    ++position;
+  }
+  // nineteen digits always fit into 64 bits, a twentieth one may
+  std::uint64_t magnitude{0};
+  read_digits(&position, last, 19, &magnitude);
+  if (position != last) {
+    unsigned digit{static_cast<unsigned>(*position - '0')};
+    if (digit > 9 || position + 1 != last
+        || magnitude > (std::numeric_limits<std::uint64_t>::max() - digit)
+                       / 10) {
+      return false;
+    }
+    magnitude = magnitude * 10 + digit;
+  }
+  using Unsigned = typename std::make_unsigned<T>::type;
+  std::uint64_t limit{static_cast<Unsigned>(std::numeric_limits<T>::max())};
+  if (negative) {
+    limit += 1;
+  }
+  if (magnitude > limit) {
+    return false;
+  }
+  (*value) = (negative ? static_cast<T>(0 - static_cast<Unsigned>(magnitude))
+                       : static_cast<T>(magnitude));
+  return true;
+}
+
+// Converts a decimal number in [first, last) with at most `scale` significant
+// digits after the decimal point to an integral number of units of
+// 10^-`scale`. Further digits after the decimal point must be zeros. Returns
+// `false` if the characters do not represent such a number, or its units do
+// not fit into `std::int64_t`.
+inline bool parse_fixed_point(const char* first, const char* last,
+                              unsigned scale, std::int64_t* units) {
+  const char* position{first};
+  bool negative{false};
+  if (position != last && (*position == '-' || *position == '+')) {
+    negative = (*position == '-');
+    ++position;
+  }
+  const char* digits_begin{position};
+  while (position != last && *position == '0') {
+    ++position;
+  }
+  std::uint64_t integer{0};
+  read_digits(&position, last, 19, &integer);
+  bool has_digits{position != digits_begin};
+  std::uint64_t fraction{0};
+  if (position != last && *position == '.') {
+    ++position;
+    const char* fraction_begin{position};
+    int count{read_digits(&position, last, static_cast<int>(scale),
+                          &fraction)};
+    fraction *= integer_powers_of_ten()[scale - count];
+    while (position != last && *position == '0') {
+      ++position;
+    }
+    has_digits = has_digits || position != fraction_begin;
+  }
+  if (!has_digits || position != last) {
+    return false;
+  }
+  std::uint64_t limit{
+      static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())};
+  if (negative) {
+    limit += 1;
+  }
+  std::uint64_t unit{integer_powers_of_ten()[scale]};
+  if (integer > (limit - fraction) / unit) {
+    return false;
+  }
+  std::uint64_t magnitude{integer * unit + fraction};
+  (*units) = (negative ? static_cast<std::int64_t>(0 - magnitude)
+                       : static_cast<std::int64_t>(magnitude));
+  return true;
+}
+
+// Converts null-terminated strings as *std::strtod* does, for each
+// floating-point type.
+inline void string_to_floating_point(const char* s, float* value) {
+  (*value) = std::strtof(s, nullptr);
+}
+
+inline void string_to_floating_point(const char* s, double* value) {
+  (*value) = std::strtod(s, nullptr);
+}
+
+inline void string_to_floating_point(const char* s, long double* value) {
+  (*value) = std::strtold(s, nullptr);
+}
+
+// Matches the characters in [first, last) to `word`, ignoring case.
+inline bool matches_word(const char* first, const char* last,
+                         const char* word) {
+  for (; first != last; ++first, ++word) {
+    if (*word == '\0' || (*first | 0x20) != *word) {
+      return false;
+    }
+  }
+  return *word == '\0';
+}
+
+// Converts a decimal floating-point number in [first, last) to the nearest
+// value of type `T`. Accepted are an optional sign followed by digits with an
+// optional decimal point and an optional exponent, or by `inf`, `infinity`,
+// or `nan` in any case. Returns `false` if the characters do not represent
+// such a number or its magnitude is too large for `T`.
+//
+// Numbers with at most nineteen significant digits whose value follows from a
+// single correctly rounded multiplication or division by an exactly
+// representable power of ten are converted directly. Others are rewritten as
+// digits and exponent without decimal point, which the C library converts
+// correctly rounded and independently of the locale.
+template <typename T>
+bool parse_floating_point(const char* first, const char* last, T* value) {
+  const char* position{first};
+  bool negative{false};
+  if (position != last && (*position == '-' || *position == '+')) {
+    negative = (*position == '-');
+    ++position;
+  }
+  if (position != last && !is_digit(*position) && *position != '.') {
+    if (matches_word(position, last, "inf")
+        || matches_word(position, last, "infinity")) {
+      (*value) = std::numeric_limits<T>::infinity();
+    } else if (matches_word(position, last, "nan")) {
+      (*value) = std::numeric_limits<T>::quiet_NaN();
+    } else {
+      return false;
+    }
+    (*value) = negative ? -(*value) : (*value);
+    return true;
+  }
+
+  // significant digits are accumulated as long as they fit into 64 bits
+  const char* integer_begin{position};
+  while (position != last && *position == '0') {
+    ++position;
+  }
+  std::uint64_t mantissa{0};
+  int significant{read_digits(&position, last, 19, &mantissa)};
+  bool exact{true};
+  while (position != last && is_digit(*position)) {
+    exact = false;
+    ++position;
+  }
+  const char* integer_end{position};
+  const char* fraction_begin{position};
+  const char* fraction_end{position};
+  if (position != last && *position == '.') {
+    ++position;
+    fraction_begin = position;
+    if (significant == 0) {
+      while (position != last && *position == '0') {
+        ++position;
+      }
+    }
+    significant += read_digits(&position, last, 19 - significant, &mantissa);
+    while (position != last && is_digit(*position)) {
+      exact = false;
+      ++position;
+    }
+    fraction_end = position;
+  }
+  if (integer_begin == integer_end && fraction_begin == fraction_end) {
+    return false;
+  }
+  long long exponent{0};
+  if (position != last && (*position == 'e' || *position == 'E')) {
+    ++position;
+    bool negative_exponent{false};
+    if (position != last && (*position == '-' || *position == '+')) {
+      negative_exponent = (*position == '-');
+      ++position;
+    }
+    if (position == last) {
+      return false;
+    }
+    for (; position != last && is_digit(*position); ++position) {
+      // saturates far beyond the exponents of any floating-point type
+      if (exponent < 100000) {
+        exponent = exponent * 10 + (*position - '0');
+      }
+    }
+    exponent = negative_exponent ? -exponent : exponent;
+  }
+  if (position != last) {
+    return false;
+  }
+  exponent -= (fraction_end - fraction_begin);
+
+  // A product or quotient of exactly representable operands is correctly
+  // rounded, provided intermediate results are not kept in wider registers.
+  constexpr bool kFastPath{FLT_EVAL_METHOD == 0
+                           || std::is_same<T, long double>::value};
+  constexpr int kMaxPower{
+      std::numeric_limits<T>::digits * 100 / 233 < kMaxExactPowerOfTen
+          ? std::numeric_limits<T>::digits * 100 / 233
+          : kMaxExactPowerOfTen};
+  constexpr std::uint64_t kMaxMantissa{
+      std::numeric_limits<T>::digits >= 64
+          ? std::numeric_limits<std::uint64_t>::max()
+          : (1ULL << (std::numeric_limits<T>::digits % 64))};
+  if (exact && mantissa == 0) {
+    (*value) = negative ? -T{0} : T{0};
+    return true;
+  } else if (kFastPath && exact && mantissa <= kMaxMantissa) {
+    // a mantissa small enough may absorb part of a large exponent exactly
+    std::uint64_t scaled{mantissa};
+    long long power_exponent{exponent};
+    while (power_exponent > kMaxPower && scaled <= kMaxMantissa / 10) {
+      scaled *= 10;
+      --power_exponent;
+    }
+    if (power_exponent >= -kMaxPower && power_exponent <= kMaxPower) {
+      T result{static_cast<T>(scaled)};
+      T power{static_cast<T>(exact_powers_of_ten()[
+          power_exponent < 0 ? -power_exponent : power_exponent])};
+      result = (power_exponent < 0) ? result / power : result * power;
+      (*value) = negative ? -result : result;
+      return true;
+    }
+  }
+
+  // `[-]digits[e-]exponent` contains no locale-specific decimal point
+  char buffer[128];
+  std::string long_number;
+  std::size_t length{static_cast<std::size_t>(
+      (integer_end - integer_begin) + (fraction_end - fraction_begin))};
+  char* number{buffer};
+  // sign, digits, 'e', exponent sign, at most 20 exponent digits, '\0'
+  if (length + 24 > sizeof(buffer)) {
+    long_number.resize(length + 24);
+    number = &long_number[0];
+  }
+  char* out{number};
+  (*out++) = negative ? '-' : '+';
+  out = std::copy(integer_begin, integer_end, out);
+  out = std::copy(fraction_begin, fraction_end, out);
+  (*out++) = 'e';
+  if (exponent < 0) {
+    (*out++) = '-';
+  }
+  unsigned long long magnitude{static_cast<unsigned long long>(
+      exponent < 0 ? -exponent : exponent)};
+  char* exponent_begin{out};
+  do {
+    (*out++) = static_cast<char>('0' + magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude > 0);
+  std::reverse(exponent_begin, out);
+  (*out) = '\0';
+  T result;
+  string_to_floating_point(number, &result);
+  if (std::isinf(result)) {
+    return false;
+  }
+  (*value) = result;
+  return true;
+}
+
+} // namespace internal
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_NUMERIC_PARSING_H_
@@ -0,0 +1,185 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef STL_IOS_UTILITIES_PARALLEL_ROW_PARSER_H_
+#define STL_IOS_UTILITIES_PARALLEL_ROW_PARSER_H_
+
+#include "delimited_row_parser.h"
+#include "mapped_file.h"
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+/// @brief Parses rows of delimited data in memory, such as a `MappedFile`,
+///  on several threads at once.
+///
+/// @details The data is split into chunks of `chunk_size` characters. Each
+///  chunk is extended to begin right after a newline character and to end
+///  right after the newline character that completes its last row, so that
+///  every row belongs to exactly one chunk. Threads take chunks one after the
+///  other and parse them with their own copy of the `DelimitedRowParser`
+///  passed to the constructor, thereby applying the same options and field
+///  parsers. Field parsers must therefore be safe to call concurrently.
+///
+///  Rows are passed to a handler, either in their original order, or in the
+///  order in which their chunks finished parsing. Either way, one thread at a
+///  time hands over the rows of parsed chunks while the others keep parsing,
+///  and at most two chunks per thread are parsed ahead of the rows being
+///  handled, so that the memory held by parsed rows is bounded.
+///
+///  If the parser reads quoted fields (see
+///  `DelimitedRowParser::quote_fields`), a chunk may begin inside a quoted
+///  field that contains newline characters. Before parsing, each chunk is
+///  then scanned in parallel for its first newline character outside of
+///  quoted fields under both assumptions, that it begins inside or outside
+///  of a quoted field, and for the parity of its quotes. A sequential pass
+///  over the chunks' parities then picks the correct assumption for each
+///  chunk. This relies on quotes occurring only around quoted fields and,
+///  doubled, inside them.
+///
+///  `ParallelRowParser` is copyable and movable.
+///
+/// @usage
+///
+/// ```
+/// stl_ios_utilities::MappedFile file{"data.tsv"};
+/// stl_ios_utilities::ParallelRowParser parser{
+///     stl_ios_utilities::DelimitedRowParser{}};
+/// parser.parse(file, stl_ios_utilities::ParallelRowParser::Order::kOriginal,
+///              [](std::vector<std::string>* row) {
+///                // process row
+///              });
+/// ```
+///
+class ParallelRowParser {
+ public:
+  /// @brief Order in which rows are passed to the handler.
+  ///
+  enum class Order {
+    /// Rows are handled in the order in which they appear in the data.
+    kOriginal,
+    /// Rows of a chunk are handled in order, and chunks in no particular
+    /// order once they are parsed.
+    kUnordered};
+
+  /// @brief Function receiving each parsed row. It may move the row's fields.
+  ///
+  using RowHandler = std::function<void(std::vector<std::string>* row)>;
+
+  /// @name Constructors:
+  ///
+  /// @{
+
+  ParallelRowParser() = default;
+
+  /// @brief Parses rows like `parser`.
+  ///
+  explicit ParallelRowParser(const DelimitedRowParser& parser)
+      : parser_{parser} {}
+  /// @}
+
+  /// @name Accessors:
+  ///
+  /// @{
+
+  /// @brief Returns the parser copied by each thread.
+  ///
+  inline const DelimitedRowParser& parser() const {return parser_;}
+
+  /// @brief Returns the number of threads parsing rows (`0` for one thread
+  ///  per hardware thread).
+  ///
+  inline unsigned thread_count() const {return thread_count_;}
+
+  /// @brief Returns the number of characters per chunk before chunks are
+  ///  aligned to row boundaries.
+  ///
+  inline std::size_t chunk_size() const {return chunk_size_;}
+  /// @}
+
+  /// @name Mutators:
+  ///
+  /// @{
+
+  /// @brief Sets the parser copied by each thread.
+  ///
+  inline void parser(const DelimitedRowParser& value) {parser_ = value;}
+
+  /// @brief Sets the number of threads parsing rows (`0` for one thread per
+  ///  hardware thread). Default value is `0`.
+  ///
+  inline void thread_count(unsigned value) {thread_count_ = value;}
+
+  /// @brief Sets the number of characters per chunk. Values below `1` are
+  ///  treated as `1`. Default value is 4 MiB.
+  ///
+  inline void chunk_size(std::size_t value) {chunk_size_ = value;}
+  /// @}
+
+  /// @name Parsing:
+  ///
+  /// @{
+
+  /// @brief Parses all rows of the `size` characters at `data` and passes
+  ///  them to `handler`.
+  ///
+  /// @details Each line, including the last one if it is not terminated by a
+  ///  newline character, is parsed by `DelimitedRowParser::parse_row`. Rows
+  ///  the parser ignores are not passed to `handler`. `handler` is never
+  ///  called concurrently and may therefore access shared state. Other
+  ///  threads keep parsing chunks while it runs.
+  ///
+  ///  If parsing a row, or `handler`, throws an exception, no further chunks
+  ///  are started and the first exception is rethrown once all threads
+  ///  finished. Rows handled before remain handled.
+  ///
+  /// @param data Pointer to the first character of the data.
+  ///
+  /// @param size Number of characters in the data.
+  ///
+  /// @param order Order in which rows are passed to `handler`.
+  ///
+  /// @param handler Function receiving each row.
+  ///
+  void parse(const char* data, std::size_t size, Order order,
+             const RowHandler& handler) const;
+
+  /// @brief Parses all rows of `file` as documented for `parse(const char*
+  ///  data, std::size_t size, Order order, const RowHandler& handler)`.
+  ///
+  inline void parse(const MappedFile& file, Order order,
+                    const RowHandler& handler) const {
+    parse(file.data(), file.size(), order, handler);
+  }
+  /// @}
+
+ private:
+  DelimitedRowParser parser_;
+  unsigned thread_count_{0};
+  std::size_t chunk_size_{std::size_t{1} << 22};
+};
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_PARALLEL_ROW_PARSER_H_
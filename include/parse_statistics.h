@@ -0,0 +1,185 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef STL_IOS_UTILITIES_PARSE_STATISTICS_H_
+#define STL_IOS_UTILITIES_PARSE_STATISTICS_H_
+
+#include "parse_status.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#ifdef STL_IOS_UTILITIES_STATISTICS
+#include <atomic>
+#endif
+
+namespace stl_ios_utilities {
+
+/// @brief Counts of the work done by all parsers of one class, as returned by
+///  `DelimitedRowParser::statistics` and `FieldParser::statistics`.
+///
+/// @details For `FieldParser`, a row is a group of fields read by one call.
+///  Every row read is either accepted, ignored, or rejected with an exception
+///  or non-ok `ParseStatus`. Time spent tokenizing excludes the time spent in
+///  field parsers.
+///
+///  Statistics are only collected if the library is compiled with
+///  `STL_IOS_UTILITIES_STATISTICS` defined (CMake option of the same name).
+///  Otherwise all counts remain zero and recording them compiles to nothing.
+///
+struct ParseStatistics {
+  std::uint64_t rows_read{0};
+  std::uint64_t rows_accepted{0};
+  std::uint64_t rows_ignored{0};
+  std::uint64_t rows_rejected{0};
+  std::uint64_t bytes_consumed{0};
+  /// @brief Number of fields of accepted rows.
+  std::uint64_t fields_produced{0};
+  std::chrono::nanoseconds tokenize_time{0};
+  std::chrono::nanoseconds field_parser_time{0};
+};
+
+/// @brief Whether parsers collect `ParseStatistics`.
+///
+#ifdef STL_IOS_UTILITIES_STATISTICS
+constexpr bool kParseStatisticsEnabled{true};
+#else
+constexpr bool kParseStatisticsEnabled{false};
+#endif
+
+/// @brief The class of parsers whose statistics are recorded.
+///
+enum class StatisticsSource {kDelimitedRowParser, kFieldParser};
+
+namespace internal {
+
+/// @brief Returns the statistics recorded for `source` by all threads since
+///  the last call of `reset_statistics(source)`.
+///
+ParseStatistics statistics(StatisticsSource source);
+
+/// @brief Makes `statistics(source)` count from zero again.
+///
+void reset_statistics(StatisticsSource source);
+
+#ifdef STL_IOS_UTILITIES_STATISTICS
+
+/// @brief Counters of one source written by a single thread.
+///
+/// @details The owning thread updates counters with relaxed loads and stores
+///  rather than read-modify-write operations, which cost no more than
+///  updating plain integers, while other threads may still read them without
+///  a data race.
+///
+class StatisticsShard {
+ public:
+  enum Counter {
+    kRowsRead, kRowsAccepted, kRowsIgnored, kRowsRejected, kBytesConsumed,
+    kFieldsProduced, kTokenizeNanoseconds, kFieldParserNanoseconds,
+    kCounterCount};
+
+  inline void add(Counter counter, std::uint64_t value) {
+    counters_[counter].store(
+        counters_[counter].load(std::memory_order_relaxed) + value,
+        std::memory_order_relaxed);
+  }
+
+  inline std::uint64_t get(Counter counter) const {
+    return counters_[counter].load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<std::uint64_t> counters_[kCounterCount] = {};
+};
+
+/// @brief Returns the calling thread's shard for `source`.
+///
+StatisticsShard* local_statistics_shard(StatisticsSource source);
+
+#endif // STL_IOS_UTILITIES_STATISTICS
+
+/// @brief Records the statistics of reading one row on the calling thread.
+///
+/// @details The time between construction and `finish`, less the time spent
+///  in `call_field_parser`, counts as tokenizing. All member functions are
+///  empty, apart from calling field parsers, unless
+///  `STL_IOS_UTILITIES_STATISTICS` is defined.
+///
+class StatisticsRecorder {
+ public:
+#ifdef STL_IOS_UTILITIES_STATISTICS
+  using Clock = std::chrono::steady_clock;
+
+  explicit StatisticsRecorder(StatisticsSource source)
+      : shard_{local_statistics_shard(source)}, start_{Clock::now()} {}
+
+  /// @brief Calls `field_parser(field)` and records the time it took.
+  ///
+  template <typename FieldParser, typename... Args>
+  void call_field_parser(FieldParser&& field_parser, Args&&... args) {
+    Clock::time_point start{Clock::now()};
+    field_parser(std::forward<Args>(args)...);
+    std::chrono::nanoseconds elapsed{Clock::now() - start};
+    field_parser_time_ += elapsed;
+    shard_->add(StatisticsShard::kFieldParserNanoseconds, elapsed.count());
+  }
+
+  /// @brief Records a row which ended with `code` after `bytes` characters,
+  ///  of which `fields` fields are stored if it is accepted.
+  ///
+  void finish(ParseStatus::Code code, std::size_t bytes, int fields) {
+    std::chrono::nanoseconds elapsed{Clock::now() - start_};
+    shard_->add(StatisticsShard::kTokenizeNanoseconds,
+                (elapsed - field_parser_time_).count());
+    shard_->add(StatisticsShard::kRowsRead, 1);
+    shard_->add(StatisticsShard::kBytesConsumed, bytes);
+    if (code == ParseStatus::Code::kOk) {
+      shard_->add(StatisticsShard::kRowsAccepted, 1);
+      shard_->add(StatisticsShard::kFieldsProduced, fields);
+    } else if (code == ParseStatus::Code::kIgnored) {
+      shard_->add(StatisticsShard::kRowsIgnored, 1);
+    } else {
+      shard_->add(StatisticsShard::kRowsRejected, 1);
+    }
+  }
+
+ private:
+  StatisticsShard* shard_;
+  Clock::time_point start_;
+  std::chrono::nanoseconds field_parser_time_{0};
+#else
+  explicit StatisticsRecorder(StatisticsSource) {}
+
+  template <typename FieldParser, typename... Args>
+  void call_field_parser(FieldParser&& field_parser, Args&&... args) {
+    field_parser(std::forward<Args>(args)...);
+  }
+
+  void finish(ParseStatus::Code, std::size_t, int) {}
+#endif
+};
+
+} // namespace internal
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_PARSE_STATISTICS_H_
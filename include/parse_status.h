@@ -0,0 +1,105 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef STL_IOS_UTILITIES_PARSE_STATUS_H_
+#define STL_IOS_UTILITIES_PARSE_STATUS_H_
+
+#include <cstddef>
+#include <string>
+
+namespace stl_ios_utilities {
+
+/// @brief Outcome of the non-throwing parse operations
+///  `DelimitedRowParser::try_parse_row` and `FieldParser::try_parse_fields`.
+///
+/// @details Describes malformed input with a code, the number of fields and
+///  an offset, rather than with an exception, so that inputs with many
+///  malformed rows can be parsed at the cost of a comparison per row. A
+///  message is only built when `message` is called.
+///
+struct ParseStatus {
+  /// @brief Indicates what happened to the row or fields that were read.
+  ///
+  enum class Code {
+    /// Fields were stored.
+    kOk,
+    /// The row or fields were skipped as requested by the parser's options.
+    kIgnored,
+    /// Fewer fields than required were read.
+    kMissingFields,
+    /// More fields than allowed were read.
+    kUnexpectedFields,
+    /// A field contained no characters.
+    kEmptyField,
+    /// The input ended inside a quoted field.
+    kUnterminatedQuote};
+
+  /// @brief Returns `true` if fields were stored.
+  ///
+  inline bool ok() const {return code == Code::kOk;}
+
+  /// @brief Returns a description of the status.
+  ///
+  /// @details For statuses of `DelimitedRowParser`, it is the message of the
+  ///  exception `DelimitedRowParser::parse_row` would have thrown. The
+  ///  exceptions of `FieldParser::parse_fields` keep their own, less
+  ///  detailed messages.
+  ///
+  std::string message() const {
+    switch (code) {
+      case Code::kOk:
+        return "fields read.";
+      case Code::kIgnored:
+        return "fields ignored.";
+      case Code::kMissingFields:
+        return "missing field(s) in input data; detected only "
+               + std::to_string(field_count) + " out of "
+               + std::to_string(expected_fields) + " fields.";
+      case Code::kUnexpectedFields:
+        return "too many field(s) in input row. Expected no more than "
+               + std::to_string(expected_fields) + " fields.";
+      case Code::kEmptyField:
+        return "field " + std::to_string(field_count) + " at offset "
+               + std::to_string(offset) + " is empty.";
+      case Code::kUnterminatedQuote:
+        return "quoted field " + std::to_string(field_count)
+               + " not terminated before end of input at offset "
+               + std::to_string(offset) + ".";
+    }
+    return std::string{};
+  }
+
+  Code code{Code::kOk};
+  /// Number of fields read. For `Code::kUnexpectedFields`, reading may have
+  /// stopped at the first unexpected field. For `Code::kEmptyField`, the
+  /// number of the empty field (starting at 1). For
+  /// `Code::kUnterminatedQuote`, the number of the quoted field.
+  int field_count{0};
+  /// Minimum or maximum number of fields which was violated, if any.
+  int expected_fields{0};
+  /// For errors, the offset of the offending field, or of the end of the
+  /// fields for `Code::kMissingFields` and `Code::kUnterminatedQuote`, counted
+  /// in characters from where reading began.
+  std::size_t offset{0};
+};
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_PARSE_STATUS_H_
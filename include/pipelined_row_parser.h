@@ -0,0 +1,168 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef STL_IOS_UTILITIES_PIPELINED_ROW_PARSER_H_
+#define STL_IOS_UTILITIES_PIPELINED_ROW_PARSER_H_
+
+#include "delimited_row_parser.h"
+
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+/// @brief Parses rows of delimited data from an *std::istream* object in
+///  concurrent stages, so that reading, tokenizing, and applying field
+///  parsers overlap.
+///
+/// @details Intended for input which cannot be split up front, such as pipes.
+///  A reader thread reads blocks of `block_size` characters, extended to the
+///  end of the last row they contain. A tokenizer thread splits blocks into
+///  rows, applying the options of the `DelimitedRowParser` passed to the
+///  constructor. A pool of `transform_threads` threads copies the fields and
+///  applies the parser's field parsers, which must therefore be safe to call
+///  concurrently. Rows are handed to a handler on the calling thread in their
+///  original order.
+///
+///  Stages are connected by lock-free `BoundedQueue` objects. At most
+///  `block_count` blocks, together with the rows parsed from them, are in
+///  flight at any time, so that memory use is fixed regardless of the size
+///  of the input.
+///
+///  Since blocks are split at newline characters, quoted fields (see
+///  `DelimitedRowParser::quote_fields`) must not contain newline characters.
+///
+///  `PipelinedRowParser` is copyable and movable.
+///
+/// @usage
+///
+/// ```
+/// stl_ios_utilities::PipelinedRowParser parser{
+///     stl_ios_utilities::DelimitedRowParser{}};
+/// parser.parse(&std::cin, [](std::vector<std::string>* row) {
+///   // process row
+/// });
+/// ```
+///
+class PipelinedRowParser {
+ public:
+  /// @brief Function receiving each parsed row. It may move the row's fields.
+  ///
+  using RowHandler = std::function<void(std::vector<std::string>* row)>;
+
+  /// @name Constructors:
+  ///
+  /// @{
+
+  PipelinedRowParser() = default;
+
+  /// @brief Parses rows like `parser`.
+  ///
+  explicit PipelinedRowParser(const DelimitedRowParser& parser)
+      : parser_{parser} {}
+  /// @}
+
+  /// @name Accessors:
+  ///
+  /// @{
+
+  /// @brief Returns the parser whose options and field parsers are applied.
+  ///
+  inline const DelimitedRowParser& parser() const {return parser_;}
+
+  /// @brief Returns the number of threads applying field parsers (`0` for
+  ///  all hardware threads not taken by the reader and tokenizer).
+  ///
+  inline unsigned transform_threads() const {return transform_threads_;}
+
+  /// @brief Returns the number of characters read per block.
+  ///
+  inline std::size_t block_size() const {return block_size_;}
+
+  /// @brief Returns the maximum number of blocks in flight.
+  ///
+  inline std::size_t block_count() const {return block_count_;}
+  /// @}
+
+  /// @name Mutators:
+  ///
+  /// @{
+
+  /// @brief Sets the parser whose options and field parsers are applied.
+  ///
+  inline void parser(const DelimitedRowParser& value) {parser_ = value;}
+
+  /// @brief Sets the number of threads applying field parsers (`0` for all
+  ///  hardware threads not taken by the reader and tokenizer, but at least
+  ///  one). Default value is `0`.
+  ///
+  inline void transform_threads(unsigned value) {transform_threads_ = value;}
+
+  /// @brief Sets the number of characters read per block. Values below `1`
+  ///  are treated as `1`. Default value is 1 MiB.
+  ///
+  inline void block_size(std::size_t value) {block_size_ = value;}
+
+  /// @brief Sets the maximum number of blocks in flight. Values below `2` are
+  ///  treated as `2`. Default value is `16`.
+  ///
+  inline void block_count(std::size_t value) {block_count_ = value;}
+  /// @}
+
+  /// @name Parsing:
+  ///
+  /// @{
+
+  /// @brief Parses all rows of `is` and passes them to `handler`.
+  ///
+  /// @details Each line, including the last one if it is not terminated by a
+  ///  newline character, is parsed as by `DelimitedRowParser::parse_row`.
+  ///  Rows the parser ignores are not passed to `handler`. `is` is read with
+  ///  *std::istream::read* until its end, after which it evaluates to
+  ///  `false`.
+  ///
+  ///  If reading `is`, parsing a row, or `handler` throws an exception, all
+  ///  stages stop and the first exception is rethrown once their threads
+  ///  finished. Rows handled before remain handled; `is` may have been read
+  ///  past the row that caused the exception.
+  ///
+  /// @param is Pointer to the input stream containing delimited data.
+  ///
+  /// @param handler Function receiving each row, called on the calling
+  ///  thread.
+  ///
+  /// @return Returns a reference to `is`.
+  ///
+  std::istream& parse(std::istream* is, const RowHandler& handler) const;
+  /// @}
+
+ private:
+  DelimitedRowParser parser_;
+  unsigned transform_threads_{0};
+  std::size_t block_size_{std::size_t{1} << 20};
+  std::size_t block_count_{16};
+};
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_PIPELINED_ROW_PARSER_H_
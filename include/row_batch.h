@@ -0,0 +1,162 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef STL_IOS_UTILITIES_ROW_BATCH_H_
+#define STL_IOS_UTILITIES_ROW_BATCH_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+/// @brief Reusable container of rows of fields filled by the batch operations
+///  `DelimitedRowParser::parse_rows` and `FieldParser::parse_fields`.
+///
+/// @details Fields of all rows are stored back to back in a single
+///  *std::vector<std::string>* object, and each row is recorded by the index
+///  one past its last field. Clearing a batch keeps its strings, so that
+///  refilling it with rows of similar widths reuses their capacity and does
+///  not allocate memory once all strings are large enough.
+///
+///  `RowBatch` is copyable and movable.
+///
+/// @usage
+///
+/// ```
+/// stl_ios_utilities::DelimitedRowParser parser;
+/// stl_ios_utilities::RowBatch batch;
+/// while (parser.parse_rows(&std::cin, &batch, 1024) > 0) {
+///   for (std::size_t i = 0; i < batch.size(); ++i) {
+///     for (const std::string& field : batch[i]) {
+///       // process field
+///     }
+///   }
+/// }
+/// ```
+///
+class RowBatch {
+ public:
+  /// @brief View of the fields of one row of a `RowBatch`.
+  ///
+  /// @details Valid until the batch is modified.
+  ///
+  class Row {
+   public:
+    Row(const std::string* begin, const std::string* end)
+        : begin_{begin}, end_{end} {}
+
+    inline const std::string* begin() const {return begin_;}
+    inline const std::string* end() const {return end_;}
+    inline std::size_t size() const {return end_ - begin_;}
+    inline bool empty() const {return begin_ == end_;}
+
+    /// @brief Returns the field at index `column` (starting at 0).
+    ///
+    inline const std::string& operator[](std::size_t column) const {
+      return begin_[column];
+    }
+
+   private:
+    const std::string* begin_;
+    const std::string* end_;
+  };
+
+  /// @name Accessors:
+  ///
+  /// @{
+
+  /// @brief Returns the number of rows.
+  ///
+  inline std::size_t size() const {return row_ends_.size();}
+
+  /// @brief Indicates whether the batch holds no rows.
+  ///
+  inline bool empty() const {return row_ends_.empty();}
+
+  /// @brief Returns the row at index `index` (starting at 0).
+  ///
+  inline Row operator[](std::size_t index) const {
+    const std::string* fields{fields_.data()};
+    return Row{fields + (index > 0 ? row_ends_[index - 1] : 0),
+               fields + row_ends_[index]};
+  }
+
+  /// @brief Returns the number of fields of all rows.
+  ///
+  inline std::size_t field_count() const {return field_count_;}
+  /// @}
+
+  /// @name Modifiers:
+  ///
+  /// @{
+
+  /// @brief Removes all rows, keeping the strings that stored their fields.
+  ///
+  inline void clear() {
+    row_ends_.clear();
+    field_count_ = 0;
+    return;
+  }
+
+  /// @brief Appends an empty field to the row being built and returns a
+  ///  pointer to it.
+  ///
+  /// @details The field reuses the string, and its capacity, of a field
+  ///  removed by `clear` or `discard_row`, if there is one. The pointer is
+  ///  valid until the next call of `add_field`.
+  ///
+  inline std::string* add_field() {
+    if (field_count_ < fields_.size()) {
+      fields_[field_count_].clear();
+    } else {
+      fields_.emplace_back();
+    }
+    return &fields_[field_count_++];
+  }
+
+  /// @brief Completes the row being built from the fields added since the
+  ///  previous row was completed or discarded.
+  ///
+  inline void finish_row() {
+    row_ends_.push_back(field_count_);
+    return;
+  }
+
+  /// @brief Removes the fields added since the previous row was completed or
+  ///  discarded.
+  ///
+  inline void discard_row() {
+    field_count_ = row_ends_.empty() ? 0 : row_ends_.back();
+    return;
+  }
+  /// @}
+
+ private:
+  // fields of all rows, followed by strings kept for reuse
+  std::vector<std::string> fields_;
+  std::size_t field_count_{0};
+  // `row_ends_[i]` is the index one past the last field of row `i`
+  std::vector<std::size_t> row_ends_;
+};
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_ROW_BATCH_H_
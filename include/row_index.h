@@ -0,0 +1,303 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef STL_IOS_UTILITIES_ROW_INDEX_H_
+#define STL_IOS_UTILITIES_ROW_INDEX_H_
+
+#include "delimited_row_parser.h"
+#include "mapped_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+/// @brief Offsets at which rows of delimited data begin, recorded for every
+///  row or every `stride`-th row, so that row `n` is found without reading
+///  the rows before it.
+///
+/// @details Rows are numbered from `0` in the order of the data and include
+///  rows a parser ignores. With `quote_fields` set, a row ends at the first
+///  newline character outside of quoted fields.
+///
+///  An index is built by `build`, or during a parse by calling `record` with
+///  the offset of each row before it is parsed. An index remembers the
+///  options its rows were split with, and an index built for a file carries
+///  the file's size and modification time. It may be saved to a sidecar file,
+///  from which `load` restores it as long as the file has not changed and
+///  rows are split and recorded the same way. Offsets are stored as
+///  variable-length differences, which takes one or two bytes per indexed
+///  row for typical row lengths.
+///
+///  `RowIndex` is copyable and movable.
+///
+class RowIndex {
+ public:
+  /// @name Constructors:
+  ///
+  /// @{
+
+  /// @brief Creates an empty index recording every `stride`-th row. Values
+  ///  below `1` are treated as `1`.
+  ///
+  explicit RowIndex(std::size_t stride = 1)
+      : stride_{stride > 0 ? stride : 1} {}
+
+  /// @brief Creates an empty index recording every `stride`-th row of data
+  ///  whose rows are split with the delimiter and quoting options of
+  ///  `parser`. Values of `stride` below `1` are treated as `1`.
+  ///
+  RowIndex(const DelimitedRowParser& parser, std::size_t stride)
+      : stride_{stride > 0 ? stride : 1},
+        delimiter_{parser.delimiter()},
+        quote_{parser.quote()},
+        quote_fields_{parser.quote_fields()} {}
+
+  /// @brief Builds an index of the `size` characters at `data`, splitting
+  ///  rows with the delimiter and quoting options of `parser`.
+  ///
+  static RowIndex build(const DelimitedRowParser& parser, const char* data,
+                        std::size_t size, std::size_t stride = 1);
+
+  /// @brief Builds an index of the file at `path`, which is stamped with the
+  ///  file's size and modification time.
+  ///
+  /// @details Throws an exception of type `stl_ios_utilities::FileError` if
+  ///  the file cannot be read.
+  ///
+  static RowIndex build(const DelimitedRowParser& parser,
+                        const std::string& path, std::size_t stride = 1);
+  /// @}
+
+  /// @name Accessors:
+  ///
+  /// @{
+
+  /// @brief Returns the number of rows between indexed rows.
+  ///
+  inline std::size_t stride() const {return stride_;}
+
+  /// @brief Returns the number of rows recorded.
+  ///
+  inline std::size_t row_count() const {return row_count_;}
+
+  /// @brief Returns the offsets of rows `0`, `stride`, `2 * stride`, etc.
+  ///
+  inline const std::vector<std::uint64_t>& offsets() const {return offsets_;}
+
+  /// @brief Returns whether rows are split with the options of `parser`.
+  ///
+  /// @details Without `quote_fields`, rows end at each newline character
+  ///  regardless of the delimiter and quote.
+  ///
+  inline bool splits_like(const DelimitedRowParser& parser) const {
+    return quote_fields_ == parser.quote_fields()
+           && (!quote_fields_ || (quote_ == parser.quote()
+                                  && delimiter_ == parser.delimiter()));
+  }
+
+  /// @brief Returns the size of the indexed file, if any.
+  ///
+  inline std::uint64_t file_size() const {return file_size_;}
+
+  /// @brief Returns the modification time of the indexed file in nanoseconds
+  ///  since the epoch, if any.
+  ///
+  inline std::int64_t file_time() const {return file_time_;}
+
+  /// @brief Returns the path of the sidecar file of the data file at `path`,
+  ///  which is `path` followed by `.rowidx`.
+  ///
+  static std::string sidecar_path(const std::string& path) {
+    return path + ".rowidx";
+  }
+  /// @}
+
+  /// @name Building:
+  ///
+  /// @{
+
+  /// @brief Counts a row beginning at `offset`, which is recorded if the
+  ///  number of rows counted before is a multiple of `stride`.
+  ///
+  /// @details Offsets must be passed in increasing order.
+  ///
+  inline void record(std::uint64_t offset) {
+    if (this->row_count_ % this->stride_ == 0) {
+      this->offsets_.push_back(offset);
+    }
+    ++this->row_count_;
+  }
+  /// @}
+
+  /// @name Lookup:
+  ///
+  /// @{
+
+  /// @brief Returns the offset of the last indexed row not after `row`, and
+  ///  stores its number in `*indexed_row`.
+  ///
+  /// @details Throws an exception of type
+  ///  `stl_ios_utilities::InvalidArgument` if `row` is not below
+  ///  `row_count()`.
+  ///
+  std::uint64_t locate(std::size_t row, std::size_t* indexed_row) const;
+  /// @}
+
+  /// @name Persistence:
+  ///
+  /// @{
+
+  /// @brief Writes the index to the file at `index_path`, replacing it.
+  ///
+  /// @details The index is written to a uniquely named temporary file next
+  ///  to `index_path`, which is then renamed, so that readers never see a
+  ///  partial index and concurrent writers do not interfere. Throws an
+  ///  exception of type `stl_ios_utilities::FileError` if the file cannot be
+  ///  written.
+  ///
+  void save(const std::string& index_path) const;
+
+  /// @brief Reads the index at `index_path` into `*index` if it was built for
+  ///  the file at `data_path` in its current state, splitting rows like
+  ///  `parser` and recording every `stride`-th row.
+  ///
+  /// @return Returns `false`, leaving `*index` untouched, if the index is
+  ///  missing or malformed, stamped with a different size or modification
+  ///  time than the file at `data_path` has, or built with other options.
+  ///
+  static bool load(const std::string& index_path,
+                   const std::string& data_path,
+                   const DelimitedRowParser& parser, std::size_t stride,
+                   RowIndex* index);
+  /// @}
+
+ private:
+  friend class IndexedRowReader;
+
+  // Reads the index like `load`, given the size and modification time the
+  // data file had before it was read.
+  static bool load(const std::string& index_path, std::uint64_t file_size,
+                   std::int64_t file_time, const DelimitedRowParser& parser,
+                   std::size_t stride, RowIndex* index);
+
+  std::size_t stride_{1};
+  std::size_t row_count_{0};
+  std::uint64_t file_size_{0};
+  std::int64_t file_time_{0};
+  char delimiter_{'\t'};
+  char quote_{'"'};
+  bool quote_fields_{false};
+  std::vector<std::uint64_t> offsets_;
+};
+
+/// @brief Reads ranges of rows of a file mapped into memory, starting from the
+///  nearest row recorded in a `RowIndex` instead of the beginning of the file.
+///
+/// @details On construction, the index is loaded from the file's sidecar
+///  file (see `RowIndex::sidecar_path`) if it is current and was built with
+///  the parser's delimiter and quoting options and the requested stride, and
+///  otherwise built from the mapped file and saved to it. The file's size
+///  and modification time are taken before it is mapped, so that a change
+///  of the file in between makes the sidecar file stale instead of matching
+///  another version of the file. If the sidecar file cannot be written, the
+///  index is kept in memory only. Rows between the indexed row and the first
+///  requested row are skipped by looking for their ends only; the requested
+///  rows are parsed as by `DelimitedRowParser::parse_row`.
+///
+///  Throws an exception of type `stl_ios_utilities::FileError` if the file
+///  cannot be read.
+///
+///  `IndexedRowReader` is movable, but not copyable.
+///
+/// @usage
+///
+/// ```
+/// stl_ios_utilities::IndexedRowReader reader{
+///     "data.tsv", stl_ios_utilities::DelimitedRowParser{}, 64};
+/// std::vector<std::string> row;
+/// reader.read_row(1000000, &row);
+/// ```
+///
+class IndexedRowReader {
+ public:
+  /// @brief Function receiving each parsed row. It may move the row's fields.
+  ///
+  using RowHandler = std::function<void(std::vector<std::string>* row)>;
+
+  /// @name Constructors:
+  ///
+  /// @{
+
+  /// @brief Reads the file at `path` with `parser`, using an index recording
+  ///  every `stride`-th row if none is current.
+  ///
+  IndexedRowReader(const std::string& path, const DelimitedRowParser& parser,
+                   std::size_t stride = 1);
+  /// @}
+
+  /// @name Accessors:
+  ///
+  /// @{
+
+  /// @brief Returns the index of the file.
+  ///
+  inline const RowIndex& index() const {return index_;}
+
+  /// @brief Returns the number of rows of the file.
+  ///
+  inline std::size_t row_count() const {return index_.row_count();}
+  /// @}
+
+  /// @name Reading:
+  ///
+  /// @{
+
+  /// @brief Parses rows `first` to `first + count - 1`, as far as they
+  ///  exist, and passes those the parser does not ignore to `handler`.
+  ///
+  /// @return Returns the number of rows parsed, including ignored ones.
+  ///
+  std::size_t read_rows(std::size_t first, std::size_t count,
+                        const RowHandler& handler);
+
+  /// @brief Parses row `row` into `*fields`, replacing its contents.
+  ///
+  /// @details Throws an exception of type
+  ///  `stl_ios_utilities::InvalidArgument` if `row` is not below
+  ///  `row_count()`.
+  ///
+  /// @return Returns `false` if the parser ignores the row.
+  ///
+  bool read_row(std::size_t row, std::vector<std::string>* fields);
+  /// @}
+
+ private:
+  MappedFile file_;
+  DelimitedRowParser parser_;
+  RowIndex index_;
+};
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_ROW_INDEX_H_
@@ -0,0 +1,307 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef STL_IOS_UTILITIES_ROW_RANGE_H_
+#define STL_IOS_UTILITIES_ROW_RANGE_H_
+
+#include "delimited_row_parser.h"
+#include "field_view.h"
+#include "input_source.h"
+#include "parse_statistics.h"
+
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+namespace internal {
+
+// Indicates whether all characters of `is` were read, reading at most one
+// buffer of it to find out.
+inline bool exhausted(std::istream* is) {
+  return std::istream::traits_type::eq_int_type(
+      is->peek(), std::istream::traits_type::eof());
+}
+
+inline bool exhausted(MemorySource* source) {
+  return source->begin() == source->end();
+}
+
+} // namespace internal
+
+/// @ingroup Parsers
+/// @brief Range of the rows of an *std::istream* object or `MemorySource`,
+///  read lazily by a `DelimitedRowParser` while it is iterated over.
+///
+/// @details Each increment of an iterator reads the next row the parser does
+///  not ignore, so that the input is never read past the row most recently
+///  handed out, except for the one buffer needed to detect its end. Breaking
+///  out of a loop over the range therefore leaves the remaining rows in the
+///  input. A final newline character does not begin an additional empty row.
+///
+///  Rows are tokenized without copying their fields (see `FieldView`).
+///  Filters added with `filter` are applied to these views, and only rows
+///  passing all of them are copied into *std::vector<std::string>* objects,
+///  to which the field parsers of the parser are applied. With `select`, only
+///  the chosen columns are copied and parsed. Rows discarded by a filter, and
+///  columns left out by a projection, are thus never materialized. If the
+///  parser itself selects columns (see `DelimitedRowParser::select_columns`),
+///  filters and `select` refer to the fields it stores by their positions.
+///
+///  Iterators refer to the range, which must outlive them and of which only
+///  one iteration may be in progress at a time. Exceptions thrown by the
+///  parser, by filters, or by field parsers are propagated by `begin` and by
+///  the increment operators.
+///
+///  `RowRange` is copyable and movable.
+///
+/// @usage
+///
+/// ```
+/// stl_ios_utilities::DelimitedRowParser parser;
+/// for (std::vector<std::string>& row :
+///      stl_ios_utilities::rows(&parser, &std::cin)
+///          .filter([](const std::vector<stl_ios_utilities::FieldView>& row) {
+///            return row.size() > 2 && row[2] == "keep";
+///          })
+///          .select({1, 3})) {
+///   // process row[0] and row[1], the first and third fields
+/// }
+/// ```
+///
+template <typename Source>
+class RowRange {
+ public:
+  /// @brief Predicate deciding whether a row, tokenized into views of its
+  ///  fields, is passed on.
+  ///
+  using Filter = std::function<bool(const std::vector<FieldView>& row)>;
+
+  /// @brief Input iterator over the rows of a `RowRange`.
+  ///
+  /// @details All iterators of a range share its current row, which they
+  ///  return as a modifiable reference so that its fields may be moved.
+  ///
+  class Iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::vector<std::string>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::vector<std::string>*;
+    using reference = std::vector<std::string>&;
+
+    /// @brief Creates an end iterator.
+    ///
+    Iterator() = default;
+
+    /// @brief Creates an iterator at the current row of `*range`.
+    ///
+    explicit Iterator(RowRange* range) : range_{range} {}
+
+    inline reference operator*() const {return range_->row_;}
+    inline pointer operator->() const {return &range_->row_;}
+
+    /// @brief Reads the next row, or becomes an end iterator if there is
+    ///  none.
+    ///
+    Iterator& operator++() {
+      if (!range_->next()) {
+        range_ = nullptr;
+      }
+      return (*this);
+    }
+
+    Iterator operator++(int) {
+      Iterator previous{*this};
+      ++(*this);
+      return previous;
+    }
+
+    inline bool operator==(const Iterator& other) const {
+      return range_ == other.range_;
+    }
+
+    inline bool operator!=(const Iterator& other) const {
+      return range_ != other.range_;
+    }
+
+   private:
+    RowRange* range_{nullptr};
+  };
+
+  /// @name Constructors:
+  ///
+  /// @{
+
+  /// @brief Reads rows of `source` with `parser`.
+  ///
+  /// @details Both must outlive the range. `parser` is used by reference, so
+  ///  that changes of its options take effect from the next row on, except
+  ///  for its field parsers, which are fixed when `begin()` is called.
+  ///
+  RowRange(DelimitedRowParser* parser, Source* source)
+      : parser_{parser}, source_{source} {}
+  /// @}
+
+  /// @name Composition:
+  ///
+  /// @{
+
+  /// @brief Returns a copy of the range which additionally only passes on
+  ///  rows for which `predicate` returns `true`.
+  ///
+  /// @details Filters are applied in the order in which they were added,
+  ///  before any field is copied. The views are only valid during the call of
+  ///  `predicate`.
+  ///
+  RowRange filter(Filter predicate) const {
+    RowRange range{*this};
+    range.filters_.push_back(std::move(predicate));
+    return range;
+  }
+
+  /// @brief Returns a copy of the range whose rows consist of the fields of
+  ///  `columns` (starting at 1), in the given order.
+  ///
+  /// @details Columns which a row does not have are stored as empty fields.
+  ///  Field parsers are applied by the columns' numbers in the input. Filters
+  ///  still receive all fields of a row.
+  ///
+  RowRange select(std::vector<int> columns) const {
+    RowRange range{*this};
+    range.columns_ = std::move(columns);
+    range.select_columns_ = true;
+    return range;
+  }
+  /// @}
+
+  /// @name Iteration:
+  ///
+  /// @{
+
+  /// @brief Reads the first row passing all filters and returns an iterator
+  ///  at it, or `end()` if there is none.
+  ///
+  /// @details Copies the field parsers of the parser, which are applied to
+  ///  the rows read until `begin()` is called again.
+  ///
+  Iterator begin() {
+    compile_column_plan();
+    return next() ? Iterator{this} : Iterator{};
+  }
+
+  inline Iterator end() {return Iterator{};}
+  /// @}
+
+ private:
+  // Reads rows until one the parser does not ignore passes all filters, and
+  // stores it in `row_`. Returns `false` at the end of the input.
+  bool next() {
+    while (!internal::exhausted(source_)) {
+      views_.clear();
+      parser_->parse_row(source_, &views_);
+      if (views_.empty() || !passes_filters()) {
+        continue;
+      }
+      if (select_columns_) {
+        row_.resize(columns_.size());
+        for (std::size_t i = 0; i < columns_.size(); ++i) {
+          store_field(columns_[i], &row_[i]);
+        }
+      } else {
+        row_.resize(views_.size());
+        for (std::size_t i = 0; i < views_.size(); ++i) {
+          store_field(static_cast<int>(i) + 1, &row_[i]);
+        }
+      }
+      return true;
+    }
+    return false;
+  }
+
+  bool passes_filters() const {
+    for (const Filter& predicate : filters_) {
+      if (!predicate(views_)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Copies the field at position `column` (starting at 1) of the current row
+  // into `*field` and applies its field parser, if any.
+  void store_field(int column, std::string* field) {
+    if (column >= 1 && static_cast<std::size_t>(column) <= views_.size()) {
+      const FieldView& view = views_[column - 1];
+      field->assign(view.data(), view.size());
+    } else {
+      field->clear();
+    }
+    if (column >= 1 && static_cast<std::size_t>(column) <= column_plan_.size()
+        && column_plan_[column - 1]) {
+      internal::StatisticsRecorder recorder{
+          StatisticsSource::kDelimitedRowParser};
+      recorder.call_field_parser(column_plan_[column - 1], field);
+    }
+  }
+
+  // Rebuilds `column_plan_` from the field parsers of `parser_`; the views
+  // only hold the columns selected by the parser, if any.
+  void compile_column_plan() {
+    column_plan_ = parser_->stored_column_plan();
+  }
+
+  DelimitedRowParser* parser_;
+  Source* source_;
+  std::vector<Filter> filters_;
+  std::vector<int> columns_;
+  bool select_columns_{false};
+  // field parsers, indexed by position in `views_`
+  std::vector<std::function<void(std::string*)>> column_plan_;
+  std::vector<FieldView> views_;
+  std::vector<std::string> row_;
+};
+
+/// @brief Returns a range of the rows of `is`, read lazily by `parser`.
+///
+/// @see `RowRange`
+///
+inline RowRange<std::istream> rows(DelimitedRowParser* parser,
+                                   std::istream* is) {
+  return RowRange<std::istream>{parser, is};
+}
+
+/// @brief Returns a range of the rows of `source`, read lazily by `parser`.
+///
+/// @see `RowRange`
+///
+inline RowRange<MemorySource> rows(DelimitedRowParser* parser,
+                                   MemorySource* source) {
+  return RowRange<MemorySource>{parser, source};
+}
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_ROW_RANGE_H_
@@ -0,0 +1,435 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef STL_IOS_UTILITIES_ROW_SCANNER_H_
+#define STL_IOS_UTILITIES_ROW_SCANNER_H_
+
+#include "boundary_search.h"
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+/// @brief Location of a field within the row most recently tokenized by a
+///  `RowScanner`.
+///
+struct FieldSpan {
+  /// Offset of the field's first character from the beginning of the row.
+  std::size_t offset;
+  /// Number of characters in the field.
+  std::size_t length;
+};
+
+/// @brief Block-oriented tokenizer splitting rows of delimited data into
+///  fields.
+///
+/// @details `RowScanner::scan` searches the window of characters made
+///  available by an input source (such as `StreamSource`) for delimiters and
+///  newline characters and records the location of each field of the row. A
+///  row lying entirely within the source's window is tokenized in place; the
+///  portion of a row straddling the end of the window is carried over into an
+///  internal buffer before the source is refilled.
+///
+///  A source provides the member functions `begin()` and `end()` delimiting
+///  its window, `consume(std::size_t n)` which discards the first `n`
+///  characters of the window, and `refill()` which makes more characters
+///  available once the window is empty and returns `false` at the end of
+///  input.
+///
+///  `RowScanner` is copyable and movable.
+///
+class RowScanner {
+ public:
+  /// @brief Indicates how the most recently scanned row ended.
+  ///
+  enum class RowEnd {
+    /// The row was terminated by a newline character.
+    kNewline,
+    /// The source ran out of input.
+    kEndOfInput,
+    /// The requested maximum number of delimiters was read.
+    kDelimiterLimit,
+    /// The source ran out of input inside a quoted field.
+    kOpenQuote};
+
+  /// @name Scanning:
+  ///
+  /// @{
+
+  /// @brief Tokenizes the next row of `source`.
+  ///
+  /// @details Consumes characters from `source` up to and including the next
+  ///  newline character, or until the end of input. If `delimiter_limit` is
+  ///  positive, scanning stops right after the `delimiter_limit`-th delimiter
+  ///  and the rest of the row remains in `source`.
+  ///
+  ///  Field boundaries are located with `find_boundary`, which examines
+  ///  blocks of characters at once on CPUs supporting SIMD instructions.
+  ///
+  ///  Data and field locations remain valid until the next call of `scan` or
+  ///  until `source` is refilled by another party.
+  ///
+  /// @param source Pointer to the input source.
+  ///
+  /// @param delimiter The character separating fields.
+  ///
+  /// @param delimiter_limit Maximum number of delimiters to consume (`0` for
+  ///  no limit).
+  ///
+  template <typename Source>
+  RowEnd scan(Source* source, char delimiter, std::size_t delimiter_limit = 0);
+
+  /// @brief Continues tokenizing a row after `scan` stopped at its delimiter
+  ///  limit.
+  ///
+  /// @details Appends the locations of the row's remaining fields to those
+  ///  already found, as if `scan` had been called with `delimiter_limit` in
+  ///  the first place, which counts all delimiters of the row. The source
+  ///  must not have been modified in between.
+  ///
+  /// @param source Pointer to the input source.
+  ///
+  /// @param delimiter The character separating fields.
+  ///
+  /// @param delimiter_limit Maximum number of delimiters of the row to
+  ///  consume (`0` for no limit).
+  ///
+  template <typename Source>
+  RowEnd resume(Source* source, char delimiter,
+                std::size_t delimiter_limit = 0);
+
+  /// @brief Consumes the rest of a row after `scan` stopped at its delimiter
+  ///  limit, up to and including the next newline character, without
+  ///  tokenizing it.
+  ///
+  /// @details Returns `RowEnd::kNewline`, or `RowEnd::kEndOfInput` if no
+  ///  newline character follows. Field locations are left as they are, but
+  ///  their data may no longer be valid.
+  ///
+  /// @param source Pointer to the input source.
+  ///
+  template <typename Source>
+  RowEnd skip_row(Source* source);
+
+  /// @brief Tokenizes the next row of `source`, which may contain fields
+  ///  quoted as described in RFC 4180.
+  ///
+  /// @details Behaves like `scan`, except that a field beginning with `quote`
+  ///  extends to the next `quote` which is not doubled, and may contain
+  ///  delimiters and newline characters. Its location refers to its contents
+  ///  without the enclosing quotes and with doubled quotes reduced to one.
+  ///  Characters between the closing quote and the next delimiter or newline
+  ///  character are kept as they are, as are quotes in fields which do not
+  ///  begin with one.
+  ///
+  ///  Only the first character of each field is compared to `quote`, so that
+  ///  rows without quoted fields are tokenized in place as by `scan`. From
+  ///  the first quoted field on, the rest of the row is copied into an
+  ///  internal buffer.
+  ///
+  /// @param source Pointer to the input source.
+  ///
+  /// @param delimiter The character separating fields.
+  ///
+  /// @param quote The character enclosing quoted fields.
+  ///
+  /// @param delimiter_limit Maximum number of delimiters outside of quoted
+  ///  fields to consume (`0` for no limit).
+  ///
+  template <typename Source>
+  RowEnd scan_quoted(Source* source, char delimiter, char quote,
+                     std::size_t delimiter_limit = 0);
+  /// @}
+
+  /// @name Accessors:
+  ///
+  /// @{
+
+  /// @brief Returns a pointer to the characters of the most recently scanned
+  ///  row. Field offsets are relative to this pointer.
+  ///
+  inline const char* data() const {return data_;}
+
+  /// @brief Returns the locations of the fields of the most recently scanned
+  ///  row. Always contains at least one (possibly empty) field.
+  ///
+  inline const std::vector<FieldSpan>& fields() const {return fields_;}
+
+  /// @brief Returns the number of characters consumed from the source by the
+  ///  most recent scan, including the newline character or delimiter it
+  ///  stopped after, if any.
+  ///
+  inline std::size_t consumed() const {return consumed_;}
+  /// @}
+
+ private:
+  // Continues `scan_quoted` at the quoted field beginning at the front of
+  // `source`, after the first `delimiter_count` delimiters of the row were
+  // consumed and `consumed_` characters of it copied to `unquoted_`.
+  template <typename Source>
+  RowEnd unquote_row(Source* source, char delimiter, char quote,
+                     std::size_t delimiter_limit, std::size_t delimiter_count);
+
+  const char* data_{nullptr};
+  std::string carry_;
+  // the row being scanned once it contains a quoted field
+  std::string unquoted_;
+  std::vector<FieldSpan> fields_;
+  std::size_t consumed_{0};
+};
+
+template <typename Source>
+RowScanner::RowEnd RowScanner::scan(Source* source,
+                                    char delimiter,
+                                    std::size_t delimiter_limit) {
+  fields_.clear();
+  carry_.clear();
+  consumed_ = 0;
+  return resume(source, delimiter, delimiter_limit);
+}
+
+template <typename Source>
+RowScanner::RowEnd RowScanner::resume(Source* source,
+                                      char delimiter,
+                                      std::size_t delimiter_limit) {
+  // The first `consumed_` characters of the row were consumed already, and
+  // those not carried over lie right before the source's window. Each field
+  // found so far ended with a delimiter.
+  std::size_t row_length{consumed_};
+  std::size_t field_start{consumed_};
+  std::size_t delimiter_count{fields_.size()};
+  if (source->begin() == source->end() && carry_.size() < row_length) {
+    carry_.append(source->begin() - (row_length - carry_.size()),
+                  source->begin());
+  }
+
+  // Searches window after window for field boundaries. Field offsets count
+  // from the beginning of the row, regardless of which window they were found
+  // in. Whatever remains of the window when no row end was found is carried
+  // over before the source is refilled.
+  while (source->begin() != source->end() || source->refill()) {
+    const char* begin{source->begin()};
+    const char* end{source->end()};
+    const char* position{begin};
+    // beginning of the characters of the row which were not carried over
+    const char* row_begin{begin - (row_length - carry_.size())};
+    while (true) {
+      const char* boundary{find_boundary(position, end, delimiter)};
+      if (boundary == end) {
+        break;
+      }
+      std::size_t offset{row_length + (boundary - begin)};
+      fields_.push_back(FieldSpan{field_start, offset - field_start});
+      field_start = offset + 1;
+      position = boundary + 1;
+      RowEnd row_end;
+      if (*boundary == '\n') {
+        row_end = RowEnd::kNewline;
+      } else if (++delimiter_count == delimiter_limit) {
+        row_end = RowEnd::kDelimiterLimit;
+      } else {
+        continue;
+      }
+      if (carry_.empty()) {
+        data_ = row_begin;
+      } else {
+        carry_.append(row_begin, position);
+        data_ = carry_.data();
+      }
+      consumed_ = field_start;
+      source->consume(position - begin);
+      return row_end;
+    }
+    carry_.append(row_begin, end);
+    row_length += end - begin;
+    source->consume(end - begin);
+  }
+  fields_.push_back(FieldSpan{field_start, row_length - field_start});
+  data_ = carry_.data();
+  consumed_ = row_length;
+  return RowEnd::kEndOfInput;
+}
+
+template <typename Source>
+RowScanner::RowEnd RowScanner::skip_row(Source* source) {
+  while (source->begin() != source->end() || source->refill()) {
+    const char* begin{source->begin()};
+    std::size_t available{static_cast<std::size_t>(source->end() - begin)};
+    const void* newline{std::memchr(begin, '\n', available)};
+    if (newline != nullptr) {
+      std::size_t length{
+          static_cast<std::size_t>(static_cast<const char*>(newline) - begin)
+          + 1};
+      consumed_ += length;
+      source->consume(length);
+      return RowEnd::kNewline;
+    }
+    consumed_ += available;
+    source->consume(available);
+  }
+  return RowEnd::kEndOfInput;
+}
+
+template <typename Source>
+RowScanner::RowEnd RowScanner::scan_quoted(Source* source,
+                                           char delimiter,
+                                           char quote,
+                                           std::size_t delimiter_limit) {
+  fields_.clear();
+  carry_.clear();
+  std::size_t row_length{0};
+  std::size_t field_start{0};
+  std::size_t delimiter_count{0};
+  bool at_field_start{true};
+
+  // Searches for field boundaries like `scan`, looking at the first character
+  // of each field on the way. The row so far is unmodified by quoting, so
+  // that it is copied as it is when a quoted field is found.
+  while (source->begin() != source->end() || source->refill()) {
+    const char* begin{source->begin()};
+    const char* end{source->end()};
+    const char* position{begin};
+    while (true) {
+      if (at_field_start) {
+        if (position == end) {
+          break;
+        } else if (*position == quote) {
+          unquoted_.assign(carry_);
+          unquoted_.append(begin, position);
+          consumed_ = row_length + (position - begin);
+          source->consume(position - begin);
+          return unquote_row(source, delimiter, quote, delimiter_limit,
+                             delimiter_count);
+        }
+        at_field_start = false;
+      }
+      const char* boundary{find_boundary(position, end, delimiter)};
+      if (boundary == end) {
+        break;
+      }
+      std::size_t offset{row_length + (boundary - begin)};
+      fields_.push_back(FieldSpan{field_start, offset - field_start});
+      field_start = offset + 1;
+      position = boundary + 1;
+      RowEnd row_end;
+      if (*boundary == '\n') {
+        row_end = RowEnd::kNewline;
+      } else if (++delimiter_count == delimiter_limit) {
+        row_end = RowEnd::kDelimiterLimit;
+      } else {
+        at_field_start = true;
+        continue;
+      }
+      if (carry_.empty()) {
+        data_ = begin;
+      } else {
+        carry_.append(begin, position);
+        data_ = carry_.data();
+      }
+      consumed_ = field_start;
+      source->consume(position - begin);
+      return row_end;
+    }
+    carry_.append(begin, end);
+    row_length += end - begin;
+    source->consume(end - begin);
+  }
+  fields_.push_back(FieldSpan{field_start, row_length - field_start});
+  data_ = carry_.data();
+  consumed_ = row_length;
+  return RowEnd::kEndOfInput;
+}
+
+template <typename Source>
+RowScanner::RowEnd RowScanner::unquote_row(Source* source,
+                                           char delimiter,
+                                           char quote,
+                                           std::size_t delimiter_limit,
+                                           std::size_t delimiter_count) {
+  // `kClosingQuote` follows a quote inside a quoted field, which either ends
+  // the field or is doubled
+  enum class State {kFieldStart, kUnquoted, kQuoted, kClosingQuote};
+  State state{State::kFieldStart};
+  std::size_t field_start{unquoted_.size()};
+  while (source->begin() != source->end() || source->refill()) {
+    const char* begin{source->begin()};
+    const char* end{source->end()};
+    const char* position{begin};
+    while (position != end) {
+      if (state == State::kFieldStart) {
+        if (*position == quote) {
+          ++position;
+          state = State::kQuoted;
+        } else {
+          state = State::kUnquoted;
+        }
+      } else if (state == State::kQuoted) {
+        const void* found{std::memchr(position, quote, end - position)};
+        const char* stop{found == nullptr
+                         ? end : static_cast<const char*>(found)};
+        unquoted_.append(position, stop);
+        position = stop;
+        if (stop != end) {
+          ++position;
+          state = State::kClosingQuote;
+        }
+      } else if (state == State::kClosingQuote) {
+        if (*position == quote) {
+          unquoted_.push_back(quote);
+          ++position;
+          state = State::kQuoted;
+        } else {
+          state = State::kUnquoted;
+        }
+      } else {
+        const char* boundary{find_boundary(position, end, delimiter)};
+        unquoted_.append(position, boundary);
+        position = boundary;
+        if (boundary == end) {
+          break;
+        }
+        ++position;
+        fields_.push_back(
+            FieldSpan{field_start, unquoted_.size() - field_start});
+        field_start = unquoted_.size();
+        if (*boundary == '\n' || ++delimiter_count == delimiter_limit) {
+          data_ = unquoted_.data();
+          consumed_ += position - begin;
+          source->consume(position - begin);
+          return *boundary == '\n' ? RowEnd::kNewline
+                                   : RowEnd::kDelimiterLimit;
+        }
+        state = State::kFieldStart;
+      }
+    }
+    consumed_ += end - begin;
+    source->consume(end - begin);
+  }
+  fields_.push_back(FieldSpan{field_start, unquoted_.size() - field_start});
+  data_ = unquoted_.data();
+  return state == State::kQuoted ? RowEnd::kOpenQuote : RowEnd::kEndOfInput;
+}
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_ROW_SCANNER_H_
@@ -27,7 +27,22 @@
 #ifndef STL_IOS_UTILITIES_STL_IOS_UTILITIES_H_
 #define STL_IOS_UTILITIES_STL_IOS_UTILITIES_H_
 
+#include "arena.h"
+#include "column_batch.h"
 #include "delimited_row_parser.h"
+#include "delimited_row_writer.h"
+#include "field_converter.h"
+#include "field_formatter.h"
 #include "field_parser.h"
+#include "field_view.h"
+#include "mapped_file.h"
+#include "parallel_row_parser.h"
+#include "parse_statistics.h"
+#include "parse_status.h"
+#include "pipelined_row_parser.h"
+#include "row_batch.h"
+#include "row_index.h"
+#include "row_range.h"
+#include "typed_row_parser.h"
 
 #endif // STL_IOS_UTILITIES_STL_IOS_UTILITIES_H_
\ No newline at end of file
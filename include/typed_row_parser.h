@@ -0,0 +1,215 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#ifndef STL_IOS_UTILITIES_TYPED_ROW_PARSER_H_
+#define STL_IOS_UTILITIES_TYPED_ROW_PARSER_H_
+
+#include "delimited_row_parser.h"
+#include "exceptions.h"
+#include "field_converter.h"
+#include "field_view.h"
+#include "input_source.h"
+
+#include <cstddef>
+#include <istream>
+#include <sstream>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+namespace internal {
+
+// compile-time sequence of indices, as *std::index_sequence* of C++14
+template <std::size_t... Is>
+struct IndexSequence {};
+
+template <std::size_t N, std::size_t... Is>
+struct MakeIndexSequence : MakeIndexSequence<N - 1, N - 1, Is...> {};
+
+template <std::size_t... Is>
+struct MakeIndexSequence<0, Is...> {
+  using type = IndexSequence<Is...>;
+};
+
+} // namespace internal
+
+/// @ingroup Parsers
+/// @brief A Parser for reading rows of delimited data whose columns have the
+///  types `Ts...` into *std::tuple<Ts...>* objects.
+///
+/// @details Rows are tokenized by a `DelimitedRowParser` without copying
+///  fields (see `FieldView`), and each field is converted directly from the
+///  input's characters into the corresponding tuple element by
+///  `FieldConverter<T>::convert`. The number of columns is fixed by the number
+///  of template arguments.
+///
+///  `TypedRowParser` is copyable and movable.
+///
+/// @usage
+///
+/// ```
+/// stl_ios_utilities::TypedRowParser<std::string, int, double> parser;
+/// std::tuple<std::string, int, double> row;
+/// while (parser.parse_row(&ifs, &row)) {
+///   // process std::get<0>(row), std::get<1>(row), std::get<2>(row)
+/// }
+/// ```
+///
+template <typename... Ts>
+class TypedRowParser {
+  static_assert(sizeof...(Ts) > 0,
+                "TypedRowParser requires at least one column type.");
+
+ public:
+  /// @brief The type rows are read into.
+  ///
+  using Row = std::tuple<Ts...>;
+
+  /// @brief The number of columns of each row.
+  ///
+  static constexpr std::size_t kColumns{sizeof...(Ts)};
+
+  /// @name Constructors:
+  ///
+  /// @{
+
+  TypedRowParser() {
+    parser_.enforce_min_fields(false);
+    parser_.ignore_underfull_row(false);
+    parser_.max_fields(static_cast<int>(kColumns));
+  }
+
+  TypedRowParser(const TypedRowParser& other) = default;
+  TypedRowParser(TypedRowParser&& other) = default;
+  /// @}
+
+  /// @name Assignment:
+  ///
+  /// @{
+
+  TypedRowParser& operator=(const TypedRowParser& other) = default;
+  TypedRowParser& operator=(TypedRowParser&& other) = default;
+  /// @}
+
+  /// @name Accessors:
+  ///
+  /// @{
+
+  /// @brief Returns the delimiter separating fields.
+  ///
+  inline char delimiter() const {return parser_.delimiter();}
+  /// @}
+
+  /// @name Modifiers:
+  ///
+  /// @{
+
+  /// @brief Sets the delimiter separating fields to `value`.
+  ///
+  inline void delimiter(char value) {parser_.delimiter(value);}
+  /// @}
+
+  /// @name Stream operations:
+  ///
+  /// @{
+
+  /// @brief Reads a data row and converts its fields into the elements of
+  ///  `row`.
+  ///
+  /// @details Throws an exception of type `DelimitedRowParser::MissingFields`
+  ///  if the row has fewer than `kColumns` fields, of type
+  ///  `DelimitedRowParser::UnexpectedFields` if it has more, and of type
+  ///  `stl_ios_utilities::InvalidField` if a field cannot be converted. An
+  ///  empty row at the end of input, such as after the newline character
+  ///  terminating the last row, is not read. In all these cases, `row` is not
+  ///  modified.
+  ///
+  ///  Elements of type `FieldView` are valid as documented for
+  ///  `DelimitedRowParser::parse_row`.
+  ///
+  /// @param is Pointer to the input stream containing delimited data.
+  ///
+  /// @param row Tuple in which the converted fields are stored.
+  ///
+  /// @return Returns a reference to the input stream `is` after extraction of
+  ///  the delimited row.
+  ///
+  std::istream& parse_row(std::istream* is, Row* row) {
+    parser_.parse_row(is, &fields_);
+    store_row(static_cast<bool>(*is), row);
+    return (*is);
+  }
+
+  /// @brief Reads a data row from an in-memory source and converts its fields
+  ///  into the elements of `row`.
+  ///
+  /// @details Behaves like `parse_row(std::istream* is, Row* row)`.
+  ///
+  /// @param source Pointer to the input source containing delimited data.
+  ///
+  /// @param row Tuple in which the converted fields are stored.
+  ///
+  /// @return Returns a reference to `source` after extraction of the delimited
+  ///  row. It evaluates to `false` once the end of its data was reached.
+  ///
+  MemorySource& parse_row(MemorySource* source, Row* row) {
+    parser_.parse_row(source, &fields_);
+    store_row(static_cast<bool>(*source), row);
+    return (*source);
+  }
+  /// @}
+
+ private:
+  // Converts `fields_` into `row`, unless they are the empty row at the end of
+  // input.
+  void store_row(bool more_input, Row* row) {
+    if (fields_.size() < kColumns) {
+      if (!more_input && fields_.size() == 1 && fields_[0].empty()) {
+        return;
+      }
+      std::stringstream error_message;
+      error_message << "missing field(s) in input data; detected only "
+                    << fields_.size() << " out of " << kColumns << " fields.";
+      throw DelimitedRowParser::MissingFields(error_message.str());
+    }
+    convert(typename internal::MakeIndexSequence<kColumns>::type{});
+    std::swap(converted_, *row);
+  }
+
+  template <std::size_t... Is>
+  void convert(internal::IndexSequence<Is...>) {
+    // expands to one conversion per column, in order
+    int expansion[]{(FieldConverter<Ts>::convert(
+                         fields_[Is], &std::get<Is>(converted_)), 0)...};
+    static_cast<void>(expansion);
+  }
+
+  DelimitedRowParser parser_;
+  std::vector<FieldView> fields_;
+  Row converted_;
+};
+
+template <typename... Ts>
+constexpr std::size_t TypedRowParser<Ts...>::kColumns;
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_TYPED_ROW_PARSER_H_
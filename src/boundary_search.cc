@@ -0,0 +1,104 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include "boundary_search.h"
+
+#ifdef STL_IOS_UTILITIES_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace stl_ios_utilities {
+
+namespace internal {
+
+const char* find_boundary_scalar(const char* first,
+                                 const char* last,
+                                 char delimiter) {
+  while (first != last && *first != '\n' && *first != delimiter) {
+    ++first;
+  }
+  return first;
+}
+
+#ifdef STL_IOS_UTILITIES_X86_KERNELS
+// Each kernel compares a block of characters against broadcast copies of the
+// delimiter and `\n` at once and locates the first match from the resulting
+// bit mask. Tails shorter than a block are handed to the next narrower kernel.
+
+__attribute__((target("sse2")))
+const char* find_boundary_sse2(const char* first,
+                               const char* last,
+                               char delimiter) {
+  const __m128i newlines{_mm_set1_epi8('\n')};
+  const __m128i delimiters{_mm_set1_epi8(delimiter)};
+  while (last - first >= 16) {
+    __m128i block{_mm_loadu_si128(reinterpret_cast<const __m128i*>(first))};
+    unsigned mask{static_cast<unsigned>(_mm_movemask_epi8(
+        _mm_or_si128(_mm_cmpeq_epi8(block, newlines),
+                     _mm_cmpeq_epi8(block, delimiters))))};
+    if (mask != 0) {
+      return first + __builtin_ctz(mask);
+    }
+    first += 16;
+  }
+  return find_boundary_scalar(first, last, delimiter);
+}
+
+__attribute__((target("avx2")))
+const char* find_boundary_avx2(const char* first,
+                               const char* last,
+                               char delimiter) {
+  const __m256i newlines{_mm256_set1_epi8('\n')};
+  const __m256i delimiters{_mm256_set1_epi8(delimiter)};
+  while (last - first >= 32) {
+    __m256i block{
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first))};
+    unsigned mask{static_cast<unsigned>(_mm256_movemask_epi8(
+        _mm256_or_si256(_mm256_cmpeq_epi8(block, newlines),
+                        _mm256_cmpeq_epi8(block, delimiters))))};
+    if (mask != 0) {
+      return first + __builtin_ctz(mask);
+    }
+    first += 32;
+  }
+  return find_boundary_sse2(first, last, delimiter);
+}
+
+bool cpu_supports_avx2() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+}
+#endif
+
+BoundarySearch select_boundary_search() {
+#ifdef STL_IOS_UTILITIES_X86_KERNELS
+  if (cpu_supports_avx2()) {
+    return find_boundary_avx2;
+  }
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2")) {
+    return find_boundary_sse2;
+  }
+#endif
+  return find_boundary_scalar;
+}
+
+} // namespace internal
+
+} // namespace stl_ios_utilities
@@ -0,0 +1,350 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include "char_class_table.h"
+
+#include <array>
+#include <cstring>
+#include <string>
+#include <unordered_set>
+
+#ifdef STL_IOS_UTILITIES_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace stl_ios_utilities {
+
+namespace {
+
+// Builds the nibble tables of the set of characters whose class satisfies
+// `member`.
+template <typename Predicate>
+NibbleTable compile_nibble_table(const std::array<CharClass, 256>& classes,
+                                 Predicate member) {
+  NibbleTable table;
+  std::memset(&table, 0, sizeof(table));
+  table.rounds = 1;
+
+  // low nibbles of the set's characters for each high nibble
+  unsigned low_sets[16];
+  for (int high = 0; high < 16; ++high) {
+    low_sets[high] = 0;
+    for (int low = 0; low < 16; ++low) {
+      if (member(classes[(high << 4) | low])) {
+        low_sets[high] |= 1u << low;
+      }
+    }
+  }
+
+  // one bucket per distinct non-empty set of low nibbles
+  unsigned buckets[16];
+  int bucket_count{0};
+  for (int high = 0; high < 16; ++high) {
+    if (low_sets[high] == 0) {
+      continue;
+    }
+    int bucket{0};
+    while (bucket < bucket_count && buckets[bucket] != low_sets[high]) {
+      ++bucket;
+    }
+    if (bucket == bucket_count) {
+      buckets[bucket_count++] = low_sets[high];
+    }
+    int round{bucket / 8};
+    unsigned char bit{static_cast<unsigned char>(1u << (bucket % 8))};
+    table.high[round][high] |= bit;
+    for (int low = 0; low < 16; ++low) {
+      if (low_sets[high] & (1u << low)) {
+        table.low[round][low] |= bit;
+      }
+    }
+  }
+  if (bucket_count > 8) {
+    table.rounds = 2;
+  }
+  return table;
+}
+
+bool is_stop(CharClass char_class) {
+  return (char_class == CharClass::kDelimiter
+          || char_class == CharClass::kTerminator);
+}
+
+bool is_masked(CharClass char_class) {
+  return char_class == CharClass::kMasked;
+}
+
+#ifdef STL_IOS_UTILITIES_X86_KERNELS
+// Indices of the set bits of each 8-bit mask, used to compact the kept bytes
+// of an 8-byte group with a single shuffle.
+struct CompactionTable {
+  unsigned char indices[256][8];
+
+  CompactionTable() {
+    for (int mask = 0; mask < 256; ++mask) {
+      int count{0};
+      for (int bit = 0; bit < 8; ++bit) {
+        if (mask & (1 << bit)) {
+          indices[mask][count++] = static_cast<unsigned char>(bit);
+        }
+      }
+      while (count < 8) {
+        indices[mask][count++] = 0x80;
+      }
+    }
+  }
+};
+
+const CompactionTable& compaction_table() {
+  static const CompactionTable table;
+  return table;
+}
+
+struct Ssse3NibbleTable {
+  __m128i low[2];
+  __m128i high[2];
+  int rounds;
+};
+
+__attribute__((target("ssse3")))
+inline Ssse3NibbleTable load_ssse3(const NibbleTable& table) {
+  Ssse3NibbleTable loaded;
+  for (int round = 0; round < 2; ++round) {
+    loaded.low[round] = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(table.low[round]));
+    loaded.high[round] = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(table.high[round]));
+  }
+  loaded.rounds = table.rounds;
+  return loaded;
+}
+
+// bit mask of the bytes of `block` which belong to the set of `table`
+__attribute__((target("ssse3")))
+inline unsigned classify_ssse3(__m128i block, const Ssse3NibbleTable& table) {
+  const __m128i nibble{_mm_set1_epi8(0x0f)};
+  __m128i low{_mm_and_si128(block, nibble)};
+  __m128i high{_mm_and_si128(_mm_srli_epi16(block, 4), nibble)};
+  __m128i hits{_mm_and_si128(_mm_shuffle_epi8(table.low[0], low),
+                             _mm_shuffle_epi8(table.high[0], high))};
+  if (table.rounds == 2) {
+    hits = _mm_or_si128(hits,
+                        _mm_and_si128(_mm_shuffle_epi8(table.low[1], low),
+                                      _mm_shuffle_epi8(table.high[1], high)));
+  }
+  return ~static_cast<unsigned>(_mm_movemask_epi8(
+      _mm_cmpeq_epi8(hits, _mm_setzero_si128()))) & 0xffffu;
+}
+
+// appends the bytes of `block` selected by the 16-bit mask `keep` to `field`
+__attribute__((target("ssse3")))
+inline void append_compacted(__m128i block, unsigned keep,
+                             std::string* field) {
+  const CompactionTable& table{compaction_table()};
+  char compacted[16];
+  __m128i low_indices{_mm_loadl_epi64(
+      reinterpret_cast<const __m128i*>(table.indices[keep & 0xff]))};
+  __m128i high_indices{_mm_add_epi8(
+      _mm_loadl_epi64(
+          reinterpret_cast<const __m128i*>(table.indices[keep >> 8])),
+      _mm_set1_epi8(8))};
+  int low_count{__builtin_popcount(keep & 0xff)};
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(compacted),
+                   _mm_shuffle_epi8(block, low_indices));
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(compacted + low_count),
+                   _mm_shuffle_epi8(block, high_indices));
+  field->append(compacted, low_count + __builtin_popcount(keep >> 8));
+}
+
+// Appends the bytes of the 16-byte group at `first` preceding the first stop
+// byte indicated by `stops` to `field`, leaving out bytes indicated by
+// `masked`. Returns the number of bytes preceding the stop byte, or 16.
+__attribute__((target("ssse3")))
+inline int append_group(const char* first, __m128i block,
+                        unsigned stops, unsigned masked,
+                        std::string* field) {
+  int prefix{stops != 0 ? __builtin_ctz(stops) : 16};
+  unsigned prefix_bits{(1u << prefix) - 1};
+  if ((masked & prefix_bits) == 0) {
+    field->append(first, prefix);
+  } else {
+    append_compacted(block, ~masked & prefix_bits, field);
+  }
+  return prefix;
+}
+#endif
+
+} // namespace
+
+namespace internal {
+
+const char* scan_field_scalar(const char* first,
+                              const char* last,
+                              const CharClassTable& table,
+                              std::string* field) {
+  const char* run{first};
+  for (; first != last; ++first) {
+    CharClass char_class{table[*first]};
+    if (char_class == CharClass::kOrdinary) {
+      continue;
+    }
+    field->append(run, first);
+    run = first + 1;
+    if (char_class != CharClass::kMasked) {
+      return first;
+    }
+  }
+  field->append(run, last);
+  return last;
+}
+
+#ifdef STL_IOS_UTILITIES_X86_KERNELS
+__attribute__((target("ssse3")))
+const char* scan_field_ssse3(const char* first,
+                             const char* last,
+                             const CharClassTable& table,
+                             std::string* field) {
+  Ssse3NibbleTable stop_table{load_ssse3(table.stop_table())};
+  Ssse3NibbleTable masked_table{load_ssse3(table.masked_table())};
+  bool has_masked{table.has_masked()};
+  while (last - first >= 16) {
+    __m128i block{_mm_loadu_si128(reinterpret_cast<const __m128i*>(first))};
+    unsigned stops{classify_ssse3(block, stop_table)};
+    unsigned masked{has_masked ? classify_ssse3(block, masked_table) : 0};
+    int prefix{append_group(first, block, stops, masked, field)};
+    first += prefix;
+    if (prefix < 16) {
+      return first;
+    }
+  }
+  return scan_field_scalar(first, last, table, field);
+}
+
+__attribute__((target("avx2")))
+const char* scan_field_avx2(const char* first,
+                            const char* last,
+                            const CharClassTable& table,
+                            std::string* field) {
+  // shuffles operate on each 128-bit lane separately, so that both lanes hold
+  // a copy of the tables
+  const NibbleTable* tables[2]{&table.stop_table(), &table.masked_table()};
+  __m256i low[2][2];
+  __m256i high[2][2];
+  for (int set = 0; set < 2; ++set) {
+    for (int round = 0; round < 2; ++round) {
+      low[set][round] = _mm256_broadcastsi128_si256(_mm_loadu_si128(
+          reinterpret_cast<const __m128i*>(tables[set]->low[round])));
+      high[set][round] = _mm256_broadcastsi128_si256(_mm_loadu_si128(
+          reinterpret_cast<const __m128i*>(tables[set]->high[round])));
+    }
+  }
+  const __m256i nibble{_mm256_set1_epi8(0x0f)};
+  const __m256i zero{_mm256_setzero_si256()};
+  int set_count{table.has_masked() ? 2 : 1};
+  while (last - first >= 32) {
+    __m256i block{
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first))};
+    __m256i low_nibbles{_mm256_and_si256(block, nibble)};
+    __m256i high_nibbles{
+        _mm256_and_si256(_mm256_srli_epi16(block, 4), nibble)};
+    unsigned masks[2]{0, 0};
+    for (int set = 0; set < set_count; ++set) {
+      __m256i hits{_mm256_and_si256(
+          _mm256_shuffle_epi8(low[set][0], low_nibbles),
+          _mm256_shuffle_epi8(high[set][0], high_nibbles))};
+      if (tables[set]->rounds == 2) {
+        hits = _mm256_or_si256(hits, _mm256_and_si256(
+            _mm256_shuffle_epi8(low[set][1], low_nibbles),
+            _mm256_shuffle_epi8(high[set][1], high_nibbles)));
+      }
+      masks[set] = ~static_cast<unsigned>(
+          _mm256_movemask_epi8(_mm256_cmpeq_epi8(hits, zero)));
+    }
+    if (masks[0] == 0 && masks[1] == 0) {
+      field->append(first, 32);
+      first += 32;
+      continue;
+    }
+    int prefix{append_group(first, _mm256_castsi256_si128(block),
+                            masks[0] & 0xffff, masks[1] & 0xffff, field)};
+    if (prefix == 16) {
+      prefix += append_group(first + 16, _mm256_extracti128_si256(block, 1),
+                             masks[0] >> 16, masks[1] >> 16, field);
+    }
+    first += prefix;
+    if (prefix < 32) {
+      return first;
+    }
+  }
+  return scan_field_ssse3(first, last, table, field);
+}
+
+bool cpu_supports_ssse3() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("ssse3");
+}
+#endif
+
+FieldScan select_field_scan() {
+#ifdef STL_IOS_UTILITIES_X86_KERNELS
+  if (cpu_supports_avx2()) {
+    return scan_field_avx2;
+  } else if (cpu_supports_ssse3()) {
+    return scan_field_ssse3;
+  }
+#endif
+  return scan_field_scalar;
+}
+
+} // namespace internal
+
+CharClassTable::CharClassTable() {
+  compile({}, {}, {});
+}
+
+void CharClassTable::compile(const std::unordered_set<char>& delimiters,
+                             const std::unordered_set<char>& terminators,
+                             const std::unordered_set<char>& masked) {
+  classes_.fill(CharClass::kOrdinary);
+  for (char c : masked) {
+    classes_[static_cast<unsigned char>(c)] = CharClass::kMasked;
+  }
+  for (char c : delimiters) {
+    classes_[static_cast<unsigned char>(c)] = CharClass::kDelimiter;
+  }
+  for (char c : terminators) {
+    classes_[static_cast<unsigned char>(c)] = CharClass::kTerminator;
+  }
+  stop_table_ = compile_nibble_table(classes_, is_stop);
+  masked_table_ = compile_nibble_table(classes_, is_masked);
+  has_masked_ = false;
+  for (CharClass char_class : classes_) {
+    has_masked_ = has_masked_ || is_masked(char_class);
+  }
+  return;
+}
+
+const char* CharClassTable::scan_field(const char* first,
+                                       const char* last,
+                                       std::string* field) const {
+  static const internal::FieldScan scan{internal::select_field_scan()};
+  return scan(first, last, *this, field);
+}
+
+} // namespace stl_ios_utilities
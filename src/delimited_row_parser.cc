@@ -20,7 +20,11 @@
 
 #include "delimited_row_parser.h"
 
-#include <sstream>
+#include "exceptions.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace stl_ios_utilities {
@@ -31,80 +35,408 @@ bool is_overfilled(int max_fields, int field_count) {
   return (max_fields > 0 && field_count > max_fields);
 }
 
-// if row can fit more fields, appends field to row and clears field contents
-void process_field(
-    std::string* field,
-    std::vector<std::string>* row,
-    int field_count,
-    int max_fields,
-    const std::unordered_map<int, std::function<void(std::string*)>>&
-        field_parsers) {
-  if (!is_overfilled(max_fields, field_count)) {
-    if (field_parsers.count(field_count) > 0) {
-      field_parsers.at(field_count)(field);
-      row->push_back(std::move(*field));
-    } else {
-      row->push_back(std::move(*field));
-    }
-    (*field) = std::string{};
+} // namespace
+
+std::istream& DelimitedRowParser::parse_row(std::istream* is,
+                                            std::vector<std::string>* row) {
+  StreamSource source{is};
+  int field_count{scan_row(&source)};
+  if (field_count >= 0) {
+    store_row(field_count, row);
   }
-  return;
+  return (*is);
 }
 
-} // namespace
+MemorySource& DelimitedRowParser::parse_row(MemorySource* source,
+                                            std::vector<std::string>* row) {
+  int field_count{scan_row(source)};
+  if (field_count >= 0) {
+    store_row(field_count, row);
+  }
+  return (*source);
+}
+
+std::istream& DelimitedRowParser::parse_row(std::istream* is, ArenaRow* row) {
+  StreamSource source{is};
+  int field_count{scan_row(&source)};
+  if (field_count >= 0) {
+    store_row(field_count, row);
+  }
+  return (*is);
+}
+
+MemorySource& DelimitedRowParser::parse_row(MemorySource* source,
+                                            ArenaRow* row) {
+  int field_count{scan_row(source)};
+  if (field_count >= 0) {
+    store_row(field_count, row);
+  }
+  return (*source);
+}
 
 std::istream& DelimitedRowParser::parse_row(std::istream* is,
-                                            std::vector<std::string>* row) {
-  std::vector<std::string> tmp_row;
-  std::stringstream error_message;
-  std::string field;
-  int field_count{1};
-  char c;
-
-  // one by one reads letters and appends to field. Processes field and starts
-  // new field when delimiter encountered, and ends processing when '\n'
-  // encountered, or input stream evaluates to `false`. Checks min and max field
-  // bounds where appropriate.
-  while (is->get(c)) {
-    if (c == '\n') {
-      break;
-    } else if (c == this->delimiter_) {
-      process_field(&field, &tmp_row, field_count, this->max_fields_,
-                    this->field_parsers_);
-      field_count += 1;
-      if (is_overfilled(this->max_fields_, field_count)
-          && this->enforce_max_fields_) {
-        error_message << "too many field(s) in input row. Expected no more than "
-                      << this->max_fields_ << " fields.";
-        throw UnexpectedFields(error_message.str());
-      }
-    } else {
-      if (!is_overfilled(this->max_fields_, field_count)) {
-        field.push_back(c);
+                                            std::vector<FieldView>* row) {
+  StreamSource source{is};
+  int field_count{scan_row(&source)};
+  if (field_count >= 0) {
+    store_row(field_count, row);
+  }
+  return (*is);
+}
+
+MemorySource& DelimitedRowParser::parse_row(MemorySource* source,
+                                            std::vector<FieldView>* row) {
+  int field_count{scan_row(source)};
+  if (field_count >= 0) {
+    store_row(field_count, row);
+  }
+  return (*source);
+}
+
+ParseStatus DelimitedRowParser::try_parse_row(std::istream* is,
+                                              std::vector<std::string>* row) {
+  StreamSource source{is};
+  return try_read_row(&source, row);
+}
+
+ParseStatus DelimitedRowParser::try_parse_row(MemorySource* source,
+                                              std::vector<std::string>* row) {
+  return try_read_row(source, row);
+}
+
+ParseStatus DelimitedRowParser::try_parse_row(std::istream* is,
+                                              std::vector<FieldView>* row) {
+  StreamSource source{is};
+  return try_read_row(&source, row);
+}
+
+ParseStatus DelimitedRowParser::try_parse_row(MemorySource* source,
+                                              std::vector<FieldView>* row) {
+  return try_read_row(source, row);
+}
+
+std::size_t DelimitedRowParser::parse_rows(std::istream* is, RowBatch* batch,
+                                           std::size_t max_rows) {
+  StreamSource source{is};
+  return read_rows(&source, batch, max_rows);
+}
+
+std::size_t DelimitedRowParser::parse_rows(MemorySource* source,
+                                           RowBatch* batch,
+                                           std::size_t max_rows) {
+  return read_rows(source, batch, max_rows);
+}
+
+std::size_t DelimitedRowParser::parse_rows(std::istream* is,
+                                           ColumnBatch* batch,
+                                           std::size_t max_rows) {
+  StreamSource source{is};
+  return read_rows(&source, batch, max_rows);
+}
+
+std::size_t DelimitedRowParser::parse_rows(MemorySource* source,
+                                           ColumnBatch* batch,
+                                           std::size_t max_rows) {
+  return read_rows(source, batch, max_rows);
+}
+
+template <typename Source>
+int DelimitedRowParser::scan_row(Source* source) {
+  ParseStatus status;
+  int field_count{scan_row(source, &status)};
+  if (status.code == ParseStatus::Code::kUnexpectedFields) {
+    throw UnexpectedFields(status.message());
+  } else if (status.code == ParseStatus::Code::kMissingFields) {
+    throw MissingFields(status.message());
+  } else if (status.code == ParseStatus::Code::kUnterminatedQuote) {
+    throw UnterminatedQuote(status.message());
+  }
+  return field_count;
+}
+
+template <typename Source>
+int DelimitedRowParser::scan_row(Source* source, ParseStatus* status) {
+  internal::StatisticsRecorder recorder{StatisticsSource::kDelimitedRowParser};
+  // When too many fields are an error, scanning stops right after the
+  // delimiter which began the first unexpected field.
+  std::size_t delimiter_limit{0};
+  if (this->max_fields_ > 0 && this->enforce_max_fields_) {
+    delimiter_limit = static_cast<std::size_t>(this->max_fields_);
+  }
+  std::size_t predicate_limit{predicate_plan_.size()};
+  // whether the predicates were evaluated while scanning, and whether the
+  // row failed one of them
+  bool checked{predicate_plan_.empty()};
+  bool filtered{false};
+  RowScanner::RowEnd row_end;
+  if (this->quote_fields_) {
+    row_end = scanner_.scan_quoted(source, this->delimiter_, this->quote_,
+                                   delimiter_limit);
+  } else if (checked
+             || (delimiter_limit > 0 && delimiter_limit <= predicate_limit)) {
+    row_end = scanner_.scan(source, this->delimiter_, delimiter_limit);
+  } else {
+    // Scanning stops after the last column with a predicate, so that the
+    // rest of a row failing one is skipped without being tokenized. Rows
+    // whose numbers of fields may still be errors are tokenized completely
+    // instead, so that they are reported like in the other paths.
+    row_end = scanner_.scan(source, this->delimiter_, predicate_limit);
+    if (row_end == RowScanner::RowEnd::kDelimiterLimit) {
+      checked = true;
+      filtered = !satisfies_predicates(static_cast<int>(predicate_limit));
+      bool bounded{delimiter_limit > 0
+                   || (this->enforce_min_fields_
+                       && static_cast<std::size_t>(this->min_fields_)
+                              > predicate_limit)};
+      if (filtered && !bounded) {
+        row_end = scanner_.skip_row(source);
+      } else {
+        row_end = scanner_.resume(source, this->delimiter_, delimiter_limit);
       }
     }
   }
-  // test min and max field bounds and process last field whose processing
-  // wasn't triggered via encountering `\n`
-  if (field_count < this->min_fields_ && this->enforce_min_fields_) {
-    error_message << "missing field(s) in input data; detected only "
-                  << field_count << " out of " << this->min_fields_
-                  << " fields.";
-    throw MissingFields(error_message.str());
-  } else if (is_overfilled(this->max_fields_, field_count)
-             && this->enforce_max_fields_) {
-    error_message << "too many field(s) in input row. Expected no more than "
-                  << this->max_fields_ << " fields.";
-    throw UnexpectedFields(error_message.str());
+  int field_count{static_cast<int>(scanner_.fields().size())};
+  // the newline character or delimiter ending the row was consumed with it
+  std::size_t row_length{scanner_.consumed()};
+  if (row_end == RowScanner::RowEnd::kNewline) {
+    row_length -= 1;
+  }
+  status->field_count = field_count;
+
+  // test min and max field bounds and determine how many fields are stored, if
+  // the row is not ignored
+  if (row_end == RowScanner::RowEnd::kOpenQuote) {
+    status->code = ParseStatus::Code::kUnterminatedQuote;
+    status->offset = row_length;
+  } else if (row_end == RowScanner::RowEnd::kDelimiterLimit) {
+    status->code = ParseStatus::Code::kUnexpectedFields;
+    status->field_count = field_count + 1;
+    status->expected_fields = this->max_fields_;
+    status->offset = row_length;
+  } else if (field_count < this->min_fields_ && this->enforce_min_fields_) {
+    status->code = ParseStatus::Code::kMissingFields;
+    status->expected_fields = this->min_fields_;
+    status->offset = row_length;
+  } else if (filtered || (!checked && !satisfies_predicates(field_count))) {
+    status->code = ParseStatus::Code::kIgnored;
   } else if ((!is_overfilled(this->max_fields_, field_count)
               || !this->ignore_overfull_row_)
              && (field_count >= this->min_fields_
                  || !this->ignore_underfull_row_)) {
-    process_field(&field, &tmp_row, field_count, this->max_fields_,
-                  this->field_parsers_);
-    (*row) = std::move(tmp_row);
+    status->code = ParseStatus::Code::kOk;
+    if (is_overfilled(this->max_fields_, field_count)) {
+      field_count = this->max_fields_;
+    }
+  } else {
+    status->code = ParseStatus::Code::kIgnored;
   }
-  return (*is);
+  recorder.finish(status->code, scanner_.consumed(),
+                  stored_field_count(field_count));
+  return status->ok() ? field_count : -1;
+}
+
+// instantiated here for the `parse_row` templates defined in the header
+template int DelimitedRowParser::scan_row(StreamSource* source);
+template int DelimitedRowParser::scan_row(MemorySource* source);
+
+void DelimitedRowParser::store_row(int field_count,
+                                   std::vector<std::string>* row) {
+  const std::vector<std::function<void(std::string*)>>& plan = column_plan_;
+  internal::StatisticsRecorder recorder{StatisticsSource::kDelimitedRowParser};
+  auto apply_plan = [&plan, &recorder](int column, std::string* field) {
+    if (static_cast<std::size_t>(column) <= plan.size() && plan[column - 1]) {
+      recorder.call_field_parser(plan[column - 1], field);
+    }
+  };
+  store_row(field_count, row, apply_plan);
+  return;
+}
+
+template <typename Source, typename Row>
+ParseStatus DelimitedRowParser::try_read_row(Source* source, Row* row) {
+  ParseStatus status;
+  int field_count{scan_row(source, &status)};
+  if (field_count >= 0) {
+    store_row(field_count, row);
+  }
+  return status;
+}
+
+template <typename Source, typename Batch>
+std::size_t DelimitedRowParser::read_rows(Source* source, Batch* batch,
+                                          std::size_t max_rows) {
+  batch->clear();
+  while (batch->size() < max_rows
+         && (source->begin() != source->end() || source->refill())) {
+    int field_count{scan_row(source)};
+    if (field_count >= 0) {
+      store_row(field_count, batch);
+    }
+  }
+  return batch->size();
+}
+
+void DelimitedRowParser::store_row(int field_count, RowBatch* batch) {
+  const std::vector<std::function<void(std::string*)>>& plan = column_plan_;
+  internal::StatisticsRecorder recorder{StatisticsSource::kDelimitedRowParser};
+  auto store_field = [batch, &plan, &recorder](int column, const char* data,
+                                               std::size_t length) {
+    std::string* field{batch->add_field()};
+    field->assign(data, length);
+    if (static_cast<std::size_t>(column) <= plan.size() && plan[column - 1]) {
+      recorder.call_field_parser(plan[column - 1], field);
+    }
+  };
+  try {
+    visit_stored_fields(field_count, store_field);
+  } catch (...) {
+    batch->discard_row();
+    throw;
+  }
+  batch->finish_row();
+  return;
+}
+
+void DelimitedRowParser::store_row(int field_count, ColumnBatch* batch) {
+  auto store_field = [batch](int, const char* data, std::size_t length) {
+    batch->add_field(FieldView{data, length});
+  };
+  try {
+    visit_stored_fields(field_count, store_field);
+    batch->finish_row();
+  } catch (...) {
+    batch->discard_row();
+    throw;
+  }
+  return;
+}
+
+void DelimitedRowParser::store_row(int field_count, ArenaRow* row) {
+  const std::vector<std::function<void(std::string*)>>& plan = column_plan_;
+  internal::StatisticsRecorder recorder{StatisticsSource::kDelimitedRowParser};
+  // `row` is only modified once all field parsers succeeded
+  ArenaRow tmp_row{row->get_allocator()};
+  tmp_row.reserve(stored_field_count(field_count));
+  std::string& parsed_field = parsed_field_;
+  auto store_field = [&tmp_row, &parsed_field, &plan, &recorder](
+      int column, const char* data, std::size_t length) {
+    if (static_cast<std::size_t>(column) <= plan.size() && plan[column - 1]) {
+      parsed_field.assign(data, length);
+      recorder.call_field_parser(plan[column - 1], &parsed_field);
+      tmp_row.emplace_back(parsed_field.data(), parsed_field.size());
+    } else {
+      tmp_row.emplace_back(data, length);
+    }
+  };
+  visit_stored_fields(field_count, store_field);
+  row->swap(tmp_row);
+  return;
+}
+
+void DelimitedRowParser::store_row(int field_count,
+                                   std::vector<FieldView>* row) {
+  row->resize(stored_field_count(field_count));
+  FieldView* field{row->data()};
+  auto store_field = [&field](int, const char* data, std::size_t length) {
+    *field++ = FieldView{data, length};
+  };
+  visit_stored_fields(field_count, store_field);
+  return;
+}
+
+void DelimitedRowParser::select_columns(const std::vector<int>& columns) {
+  for (int column : columns) {
+    if (column < 1) {
+      throw InvalidArgument("Column numbers selected by `DelimitedRowParser`"
+                            " must be positive, but got: "
+                            + std::to_string(column) + '.');
+    }
+  }
+  selected_columns_ = columns;
+  return;
+}
+
+void DelimitedRowParser::select_columns(
+    const std::vector<std::string>& names,
+    const std::vector<std::string>& header) {
+  std::vector<int> columns;
+  columns.reserve(names.size());
+  for (const std::string& name : names) {
+    auto position = std::find(header.begin(), header.end(), name);
+    if (position == header.end()) {
+      throw InvalidArgument("Column '" + name + "' selected by"
+                            " `DelimitedRowParser` is missing from header.");
+    }
+    columns.push_back(static_cast<int>(position - header.begin()) + 1);
+  }
+  selected_columns_ = std::move(columns);
+  return;
+}
+
+void DelimitedRowParser::compile_column_plan() {
+  // column numbers below 1 never match a field; their parsers remain
+  // accessible through `field_parsers` but are left out of the plan
+  int width{0};
+  for (const auto& entry : this->field_parsers_) {
+    if (entry.first > width) {
+      width = entry.first;
+    }
+  }
+  column_plan_.assign(width, std::function<void(std::string*)>{});
+  for (const auto& entry : this->field_parsers_) {
+    if (entry.first > 0) {
+      column_plan_[entry.first - 1] = entry.second;
+    }
+  }
+  return;
+}
+
+std::vector<std::function<void(std::string*)>>
+DelimitedRowParser::stored_column_plan() const {
+  if (selected_columns_.empty()) {
+    return column_plan_;
+  }
+  std::vector<std::function<void(std::string*)>> plan;
+  plan.reserve(selected_columns_.size());
+  for (int column : selected_columns_) {
+    plan.push_back(static_cast<std::size_t>(column) <= column_plan_.size()
+                   ? column_plan_[column - 1]
+                   : std::function<void(std::string*)>{});
+  }
+  return plan;
+}
+
+void DelimitedRowParser::compile_predicate_plan() {
+  int width{0};
+  for (const auto& entry : this->field_predicates_) {
+    if (entry.first > width) {
+      width = entry.first;
+    }
+  }
+  predicate_plan_.assign(width, std::function<bool(const FieldView&)>{});
+  for (const auto& entry : this->field_predicates_) {
+    if (entry.first > 0) {
+      predicate_plan_[entry.first - 1] = entry.second;
+    }
+  }
+  return;
+}
+
+bool DelimitedRowParser::satisfies_predicates(int field_count) const {
+  const std::vector<FieldSpan>& spans = scanner_.fields();
+  for (std::size_t i = 0; i < predicate_plan_.size(); ++i) {
+    if (!predicate_plan_[i]) {
+      continue;
+    }
+    FieldView field;
+    if (i < static_cast<std::size_t>(field_count)) {
+      field = FieldView{scanner_.data() + spans[i].offset, spans[i].length};
+    }
+    if (!predicate_plan_[i](field)) {
+      return false;
+    }
+  }
+  return true;
 }
 
-} // namespace stl_ios_utilities
\ No newline at end of file
+} // namespace stl_ios_utilities
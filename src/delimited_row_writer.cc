@@ -0,0 +1,382 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "delimited_row_writer.h"
+
+#include "boundary_search.h"
+#include "exceptions.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define STL_IOS_UTILITIES_HAS_MMAP 1
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+namespace stl_ios_utilities {
+
+namespace internal {
+
+class OutputSink {
+ public:
+  virtual ~OutputSink() = default;
+
+  // Writes all of [`data`, `data + size`).
+  virtual void write(const char* data, std::size_t size) = 0;
+
+  virtual void flush() {}
+
+  virtual void close() {}
+};
+
+} // namespace internal
+
+namespace {
+
+class StreamSink : public internal::OutputSink {
+ public:
+  explicit StreamSink(std::ostream* os) : os_{os} {}
+
+  void write(const char* data, std::size_t size) override {
+    os_->write(data, static_cast<std::streamsize>(size));
+    this->check();
+  }
+
+  void flush() override {
+    os_->flush();
+    this->check();
+  }
+
+  void close() override {this->flush();}
+
+ private:
+  // throws if the stream's failbit or badbit is set
+  void check() const {
+    if (!(*os_)) {
+      throw FileError("Unable to write to stream in"
+                      " `stl_ios_utilities::DelimitedRowWriter`.");
+    }
+  }
+
+  std::ostream* os_;
+};
+
+#ifdef STL_IOS_UTILITIES_HAS_MMAP
+class FileDescriptorSink : public internal::OutputSink {
+ public:
+  explicit FileDescriptorSink(int fd) : fd_{fd} {}
+
+  void write(const char* data, std::size_t size) override {
+    while (size > 0) {
+      ssize_t written{::write(fd_, data, size)};
+      if (written < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        throw FileError("Unable to write to file descriptor `"
+                        + std::to_string(fd_) + "` in"
+                        " `stl_ios_utilities::DelimitedRowWriter`.");
+      }
+      data += written;
+      size -= static_cast<std::size_t>(written);
+    }
+  }
+
+ private:
+  int fd_;
+};
+
+// Writes to a file through a window mapped into memory, which is moved on
+// once filled. The file is extended by a window at a time and truncated to
+// the written characters when closed.
+class MappedFileSink : public internal::OutputSink {
+ public:
+  explicit MappedFileSink(const std::string& path) : path_{path} {
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (fd_ < 0) {
+      throw FileError("Unable to open `" + path + "` in"
+                      " `stl_ios_utilities::DelimitedRowWriter`.");
+    }
+  }
+
+  // the file is released even if a write failed before `close`
+  ~MappedFileSink() override {this->release();}
+
+  void write(const char* data, std::size_t size) override {
+    while (size > 0) {
+      if (window_ == nullptr || used_ == kWindowSize) {
+        this->map_next_window();
+      }
+      std::size_t count{std::min(size, kWindowSize - used_)};
+      std::memcpy(window_ + used_, data, count);
+      used_ += count;
+      data += count;
+      size -= count;
+    }
+  }
+
+  void close() override {
+    if (!this->release()) {
+      throw FileError("Unable to write to `" + path_ + "` in"
+                      " `stl_ios_utilities::DelimitedRowWriter`.");
+    }
+  }
+
+ private:
+  // a multiple of the page size on all supported platforms
+  static constexpr std::size_t kWindowSize{std::size_t{1} << 24};
+
+  // Unmaps the window, truncates the file to the written characters, which
+  // drops the unwritten part of the last window, and closes it. Returns
+  // `false` if truncating or closing the file failed.
+  bool release() {
+    if (window_ != nullptr) {
+      ::munmap(window_, kWindowSize);
+      window_ = nullptr;
+    }
+    if (fd_ < 0) {
+      return true;
+    }
+    int fd{fd_};
+    fd_ = -1;
+    bool truncated{
+        ::ftruncate(fd, static_cast<off_t>(offset_ + used_)) == 0};
+    return ::close(fd) == 0 && truncated;
+  }
+
+  void map_next_window() {
+    if (window_ != nullptr) {
+      ::munmap(window_, kWindowSize);
+      window_ = nullptr;
+      offset_ += kWindowSize;
+      used_ = 0;
+    }
+    off_t end{static_cast<off_t>(offset_ + kWindowSize)};
+#ifdef __linux__
+    // allocating the window's blocks up front reports a full disk here,
+    // instead of as a signal when writing to the mapping
+    bool extended{::posix_fallocate(fd_, static_cast<off_t>(offset_),
+                                    static_cast<off_t>(kWindowSize)) == 0};
+#else
+    bool extended{::ftruncate(fd_, end) == 0};
+#endif
+    void* address{extended
+                  ? ::mmap(nullptr, kWindowSize, PROT_READ | PROT_WRITE,
+                           MAP_SHARED, fd_, static_cast<off_t>(offset_))
+                  : MAP_FAILED};
+    if (address == MAP_FAILED) {
+      throw FileError("Unable to extend `" + path_ + "` to "
+                      + std::to_string(end) + " characters in"
+                      " `stl_ios_utilities::DelimitedRowWriter`.");
+    }
+    window_ = static_cast<char*>(address);
+  }
+
+  std::string path_;
+  int fd_{-1};
+  char* window_{nullptr};
+  // offset of the window in the file and number of characters written to it
+  std::size_t offset_{0};
+  std::size_t used_{0};
+};
+
+constexpr std::size_t MappedFileSink::kWindowSize;
+#else
+class FileSink : public internal::OutputSink {
+ public:
+  explicit FileSink(const std::string& path)
+      : path_{path}, ofs_{path, std::ios_base::binary | std::ios_base::trunc} {
+    if (!ofs_.is_open()) {
+      throw FileError("Unable to open `" + path + "` in"
+                      " `stl_ios_utilities::DelimitedRowWriter`.");
+    }
+  }
+
+  void write(const char* data, std::size_t size) override {
+    if (!ofs_.write(data, static_cast<std::streamsize>(size))) {
+      throw FileError("Unable to write to `" + path_ + "` in"
+                      " `stl_ios_utilities::DelimitedRowWriter`.");
+    }
+  }
+
+  void flush() override {ofs_.flush();}
+
+  void close() override {
+    ofs_.close();
+    if (ofs_.fail()) {
+      throw FileError("Unable to write to `" + path_ + "` in"
+                      " `stl_ios_utilities::DelimitedRowWriter`.");
+    }
+  }
+
+ private:
+  std::string path_;
+  std::ofstream ofs_;
+};
+#endif
+
+} // namespace
+
+DelimitedRowWriter::DelimitedRowWriter(std::ostream* os)
+    : sink_{new StreamSink{os}} {
+  this->buffer_.reserve(this->buffer_size_);
+}
+
+#ifdef STL_IOS_UTILITIES_HAS_MMAP
+DelimitedRowWriter::DelimitedRowWriter(int fd)
+    : sink_{new FileDescriptorSink{fd}} {
+  this->buffer_.reserve(this->buffer_size_);
+}
+
+DelimitedRowWriter::DelimitedRowWriter(const std::string& path)
+    : sink_{new MappedFileSink{path}} {
+  this->buffer_.reserve(this->buffer_size_);
+}
+#else
+DelimitedRowWriter::DelimitedRowWriter(int fd) {
+  throw FileError("Unable to write to file descriptor `" + std::to_string(fd)
+                  + "` on this platform in"
+                  " `stl_ios_utilities::DelimitedRowWriter`.");
+}
+
+DelimitedRowWriter::DelimitedRowWriter(const std::string& path)
+    : sink_{new FileSink{path}} {
+  this->buffer_.reserve(this->buffer_size_);
+}
+#endif
+
+DelimitedRowWriter::DelimitedRowWriter(DelimitedRowWriter&& other) noexcept
+    = default;
+
+DelimitedRowWriter& DelimitedRowWriter::operator=(
+    DelimitedRowWriter&& other) noexcept {
+  if (this != &other) {
+    try {
+      this->close();
+    } catch (...) {}
+    this->sink_ = std::move(other.sink_);
+    this->buffer_ = std::move(other.buffer_);
+    this->buffer_size_ = other.buffer_size_;
+    this->fields_in_row_ = other.fields_in_row_;
+    this->delimiter_ = other.delimiter_;
+    this->quote_ = other.quote_;
+    this->quote_fields_ = other.quote_fields_;
+  }
+  return *this;
+}
+
+DelimitedRowWriter::~DelimitedRowWriter() {
+  try {
+    this->close();
+  } catch (...) {}
+}
+
+void DelimitedRowWriter::buffer_size(std::size_t value) {
+  this->buffer_size_ = std::max<std::size_t>(value, 1);
+  this->buffer_.reserve(this->buffer_size_);
+}
+
+void DelimitedRowWriter::write_field(const char* value) {
+  this->begin_field();
+  this->append_text(value, std::strlen(value));
+}
+
+void DelimitedRowWriter::write_row(const std::vector<std::string>& row) {
+  for (const std::string& field : row) {
+    this->write_field(field);
+  }
+  this->end_row();
+}
+
+void DelimitedRowWriter::write_row(const std::vector<FieldView>& row) {
+  for (const FieldView& field : row) {
+    this->write_field(field);
+  }
+  this->end_row();
+}
+
+void DelimitedRowWriter::flush() {
+  if (this->sink_ != nullptr) {
+    this->write_buffer();
+    this->sink_->flush();
+  }
+}
+
+void DelimitedRowWriter::close() {
+  if (this->sink_ == nullptr) {
+    return;
+  }
+  // the sink is released even if writing to it fails
+  std::unique_ptr<internal::OutputSink> sink{std::move(this->sink_)};
+  sink->write(this->buffer_.data(), this->buffer_.size());
+  this->buffer_.clear();
+  sink->close();
+}
+
+void DelimitedRowWriter::append_text(const char* data, std::size_t size) {
+  const char* end{data + size};
+  bool quoted{this->quote_fields_ && size > 0
+              && (find_boundary(data, end, this->delimiter_) != end
+                  || std::memchr(data, this->quote_, size) != nullptr
+                  || std::memchr(data, '\r', size) != nullptr)};
+  if (!quoted) {
+    this->buffer_.append(data, size);
+    return;
+  }
+  this->buffer_.push_back(this->quote_);
+  const char* position{data};
+  while (position != end) {
+    const char* next{static_cast<const char*>(
+        std::memchr(position, this->quote_, end - position))};
+    if (next == nullptr) {
+      this->buffer_.append(position, end);
+      break;
+    }
+    this->buffer_.append(position, next + 1);
+    this->buffer_.push_back(this->quote_);
+    position = next + 1;
+  }
+  this->buffer_.push_back(this->quote_);
+}
+
+void DelimitedRowWriter::write_buffer() {
+  if (this->sink_ == nullptr) {
+    this->throw_closed();
+  }
+  this->sink_->write(this->buffer_.data(), this->buffer_.size());
+  this->buffer_.clear();
+}
+
+void DelimitedRowWriter::throw_closed() const {
+  throw std::logic_error("Writing to a closed or moved-from"
+                         " `stl_ios_utilities::DelimitedRowWriter`.");
+}
+
+} // namespace stl_ios_utilities
@@ -20,6 +20,7 @@
 
 #include "field_parser.h"
 
+#include <cstddef>
 #include <functional>
 #include <istream>
 #include <string>
@@ -30,25 +31,45 @@ namespace stl_ios_utilities {
 
 namespace {
 
-// parses field, if necessary, appends to fields, and clears field contents
-void process_field(
+// Returns the string at index `count` of `fields`, cleared but with its
+// capacity intact, or appends a new string if there is none.
+std::string* next_field(std::vector<std::string>* fields, int count) {
+  if (static_cast<std::size_t>(count) < fields->size()) {
+    (*fields)[count].clear();
+  } else {
+    fields->emplace_back();
+  }
+  return &(*fields)[count];
+}
+
+// Returns the strings of the calling thread which `parse_fields` reuses if
+// `reuse_fields_` is set.
+std::vector<std::string>* reused_fields() {
+  static thread_local std::vector<std::string> fields;
+  return &fields;
+}
+
+// Returns a string of the calling thread into which fields stored in an
+// `ArenaRow` are read, so that its capacity is reused across calls.
+std::string* arena_field_buffer() {
+  static thread_local std::string buffer;
+  return &buffer;
+}
+
+// checks that field is not empty and parses field, if necessary; returns
+// `false` if the field is empty
+bool process_field(
     std::string* field,
-    std::vector<std::string>* fields,
     int field_count,
-    const std::unordered_map<int, std::function<void(std::string*)>>&
-        field_parsers) {
+    const std::vector<std::function<void(std::string*)>>& field_plan,
+    internal::StatisticsRecorder* recorder) {
   if (field->length() == 0) {
-    throw EmptyField("No data read, after begin of execution of"
-                     " `stl_ios_utilities::parse_fields`, or after delimiter"
-                     " and before next delimiter, or terminator.");
-  } else if (field_parsers.count(field_count) > 0) {
-    field_parsers.at(field_count)(field);
-    fields->push_back(std::move(*field));
-  } else {
-    fields->push_back(std::move(*field));
+    return false;
+  } else if (static_cast<std::size_t>(field_count) <= field_plan.size()
+             && field_plan[field_count - 1]) {
+    recorder->call_field_parser(field_plan[field_count - 1], field);
   }
-  (*field) = std::string{};
-  return;
+  return true;
 }
 
 } // namespace
@@ -60,43 +81,308 @@ std::istream& FieldParser::parse_fields (std::istream* is,
     throw InvalidArgument("Must request a positive number of fields in"
                           "`stl_ios_utilities::FieldParser::parse_fields`.");
   }
+  StreamSource source{is};
+  read_fields(&source, fields, requested_field_number);
+  return (*is);
+}
+
+MemorySource& FieldParser::parse_fields (MemorySource* source,
+                                         std::vector<std::string>* fields,
+                                         int requested_field_number) const {
+  if (requested_field_number < 1) {
+    throw InvalidArgument("Must request a positive number of fields in"
+                          "`stl_ios_utilities::FieldParser::parse_fields`.");
+  }
+  read_fields(source, fields, requested_field_number);
+  return (*source);
+}
+
+std::istream& FieldParser::parse_fields (std::istream* is,
+                                         ArenaRow* fields,
+                                         int requested_field_number) const {
+  if (requested_field_number < 1) {
+    throw InvalidArgument("Must request a positive number of fields in"
+                          "`stl_ios_utilities::FieldParser::parse_fields`.");
+  }
+  StreamSource source{is};
+  read_fields(&source, fields, requested_field_number);
+  return (*is);
+}
+
+MemorySource& FieldParser::parse_fields (MemorySource* source,
+                                         ArenaRow* fields,
+                                         int requested_field_number) const {
+  if (requested_field_number < 1) {
+    throw InvalidArgument("Must request a positive number of fields in"
+                          "`stl_ios_utilities::FieldParser::parse_fields`.");
+  }
+  read_fields(source, fields, requested_field_number);
+  return (*source);
+}
+
+ParseStatus FieldParser::try_parse_fields (std::istream* is,
+                                           std::vector<std::string>* fields,
+                                           int requested_field_number) const {
+  if (requested_field_number < 1) {
+    throw InvalidArgument("Must request a positive number of fields in"
+                          "`stl_ios_utilities::FieldParser::parse_fields`.");
+  }
+  StreamSource source{is};
+  return try_read_fields(&source, fields, requested_field_number);
+}
+
+ParseStatus FieldParser::try_parse_fields (MemorySource* source,
+                                           std::vector<std::string>* fields,
+                                           int requested_field_number) const {
+  if (requested_field_number < 1) {
+    throw InvalidArgument("Must request a positive number of fields in"
+                          "`stl_ios_utilities::FieldParser::parse_fields`.");
+  }
+  return try_read_fields(source, fields, requested_field_number);
+}
+
+std::size_t FieldParser::parse_fields (std::istream* is,
+                                       RowBatch* batch,
+                                       int requested_field_number,
+                                       std::size_t max_groups) const {
+  if (requested_field_number < 1) {
+    throw InvalidArgument("Must request a positive number of fields in"
+                          "`stl_ios_utilities::FieldParser::parse_fields`.");
+  }
+  StreamSource source{is};
+  return read_groups(&source, batch, requested_field_number, max_groups);
+}
+
+std::size_t FieldParser::parse_fields (MemorySource* source,
+                                       RowBatch* batch,
+                                       int requested_field_number,
+                                       std::size_t max_groups) const {
+  if (requested_field_number < 1) {
+    throw InvalidArgument("Must request a positive number of fields in"
+                          "`stl_ios_utilities::FieldParser::parse_fields`.");
+  }
+  return read_groups(source, batch, requested_field_number, max_groups);
+}
+
+void FieldParser::compile_char_classes() {
+  char_classes_.compile(this->delimiters_, this->terminators_, this->masked_);
+  return;
+}
+
+void FieldParser::compile_field_plan() {
+  // field numbers below 1 never match a field and are left out of the plan
+  int width{0};
+  for (const auto& entry : this->field_parsers_) {
+    if (entry.first > width) {
+      width = entry.first;
+    }
+  }
+  field_plan_.assign(width, std::function<void(std::string*)>{});
+  for (const auto& entry : this->field_parsers_) {
+    if (entry.first > 0) {
+      field_plan_[entry.first - 1] = entry.second;
+    }
+  }
+  return;
+}
+
+template <typename Source>
+void FieldParser::read_fields(Source* source,
+                              std::vector<std::string>* fields,
+                              int requested_field_number) const {
+  // fields are read into reused strings, if requested, and `fields` is only
+  // modified once the requested fields were read
   std::vector<std::string> tmp_fields;
-  std::string field;
+  std::vector<std::string>* read{
+      this->reuse_fields_ ? reused_fields() : &tmp_fields};
+  ParseStatus status;
+  int field_count{read_group(
+      source, requested_field_number,
+      [read](int count) {return next_field(read, count);}, &status)};
+  if (store_group(status)) {
+    read->resize(field_count);
+    if (this->reuse_fields_) {
+      fields->swap(*read);
+    } else {
+      (*fields) = std::move(tmp_fields);
+    }
+  }
+  return;
+}
+
+template <typename Source>
+void FieldParser::read_fields(Source* source,
+                              ArenaRow* fields,
+                              int requested_field_number) const {
+  // each field is stored in the arena once the next one is requested, by
+  // which time it was processed; `fields` is only modified once the requested
+  // fields were read
+  ArenaRow read{fields->get_allocator()};
+  std::string* buffer{arena_field_buffer()};
+  buffer->clear();
+  ParseStatus status;
+  read_group(
+      source, requested_field_number,
+      [&read, buffer](int count) {
+        if (count > 0) {
+          read.emplace_back(buffer->data(), buffer->size());
+          buffer->clear();
+        }
+        return buffer;
+      }, &status);
+  if (store_group(status)) {
+    read.emplace_back(buffer->data(), buffer->size());
+    fields->swap(read);
+  }
+  return;
+}
+
+template <typename Source>
+std::size_t FieldParser::read_groups(Source* source,
+                                     RowBatch* batch,
+                                     int requested_field_number,
+                                     std::size_t max_groups) const {
+  batch->clear();
+  auto add_field = [batch](int) {return batch->add_field();};
+  while (batch->size() < max_groups
+         && (source->begin() != source->end() || source->refill())) {
+    // a group whose processing throws is not kept in the batch
+    bool store;
+    try {
+      ParseStatus status;
+      read_group(source, requested_field_number, add_field, &status);
+      store = store_group(status);
+    } catch (...) {
+      batch->discard_row();
+      throw;
+    }
+    if (store) {
+      batch->finish_row();
+    } else {
+      batch->discard_row();
+    }
+  }
+  return batch->size();
+}
+
+template <typename Source>
+ParseStatus FieldParser::try_read_fields(Source* source,
+                                         std::vector<std::string>* fields,
+                                         int requested_field_number) const {
+  std::vector<std::string> tmp_fields;
+  std::vector<std::string>* read{
+      this->reuse_fields_ ? reused_fields() : &tmp_fields};
+  ParseStatus status;
+  int field_count{read_group(
+      source, requested_field_number,
+      [read](int count) {return next_field(read, count);}, &status)};
+  if (status.ok()) {
+    read->resize(field_count);
+    if (this->reuse_fields_) {
+      fields->swap(*read);
+    } else {
+      (*fields) = std::move(tmp_fields);
+    }
+  }
+  return status;
+}
+
+template <typename Source, typename NextField>
+int FieldParser::read_group(Source* source,
+                            int requested_field_number,
+                            NextField next_field,
+                            ParseStatus* status) const {
+  internal::StatisticsRecorder recorder{StatisticsSource::kFieldParser};
+  std::string* field{next_field(0)};
   int field_count{0};
-  char c;
-
-  // Reads letters one by one and appends to field. If delimiter encountered,
-  // processes field and starts new field. If terminator encountered, or input
-  // stream evaluates to `false`, stops extracting letters.
-  while (is->get(c)) {
-    if ((this->terminators_).count(c) == 1) {
-      break;
-    } else if ((this->delimiters_).count(c) == 1) {
-      field_count += 1;
-      process_field(&field, &tmp_fields, field_count, this->field_parsers_);
-      if (field_count == requested_field_number) {
+  bool stopped{false};
+  // characters consumed so far, and where the current field began
+  std::size_t consumed{0};
+  std::size_t field_offset{0};
+
+  // Appends characters of the source's window to field, leaving out masked
+  // characters, until a delimiter or terminator is found. If delimiter
+  // encountered, processes field and starts new field. If terminator
+  // encountered, or source runs out of input, stops extracting characters.
+  // Characters are consumed before fields are processed, so that the source
+  // is left right after the delimiter if a field is empty or processing
+  // throws.
+  while (!stopped && (source->begin() != source->end() || source->refill())) {
+    const char* begin{source->begin()};
+    const char* end{source->end()};
+    const char* position{begin};
+    while (!stopped) {
+      position = char_classes_.scan_field(position, end, field);
+      if (position == end) {
         break;
       }
-    } else if ((this->masked_).count(c) == 0) {
-      field.push_back(c);
+      CharClass char_class{char_classes_[*position]};
+      ++position;
+      if (char_class == CharClass::kTerminator) {
+        stopped = true;
+      } else {
+        source->consume(position - begin);
+        consumed += position - begin;
+        begin = position;
+        field_count += 1;
+        if (!process_field(field, field_count, this->field_plan_, &recorder)) {
+          status->code = ParseStatus::Code::kEmptyField;
+          status->field_count = field_count;
+          status->offset = field_offset;
+          recorder.finish(status->code, consumed, field_count);
+          return field_count;
+        }
+        field_offset = consumed;
+        stopped = (field_count == requested_field_number);
+        if (!stopped) {
+          field = next_field(field_count);
+        }
+      }
     }
+    source->consume(position - begin);
+    consumed += position - begin;
   }
 
-  // Test field count and process last field whose processing wasn't triggered
-  // via encountering terminator or stream evaluating to `false`.
+  // Process last field whose processing wasn't triggered via encountering
+  // terminator or stream evaluating to `false`.
   if (field_count < requested_field_number) {
     field_count += 1;
-    process_field(&field, &tmp_fields, field_count, this->field_parsers_);
+    if (!process_field(field, field_count, this->field_plan_, &recorder)) {
+      status->code = ParseStatus::Code::kEmptyField;
+      status->field_count = field_count;
+      status->offset = field_offset;
+      recorder.finish(status->code, consumed, field_count);
+      return field_count;
+    }
+  }
+
+  // Test field count.
+  status->field_count = field_count;
+  status->expected_fields = requested_field_number;
+  status->offset = consumed;
+  if (field_count == requested_field_number) {
+    status->code = ParseStatus::Code::kOk;
+  } else if (this->enforce_field_number_) {
+    status->code = ParseStatus::Code::kMissingFields;
+  } else if (this->ignore_underfull_data_) {
+    status->code = ParseStatus::Code::kIgnored;
+  } else {
+    status->code = ParseStatus::Code::kOk;
   }
-  if (field_count < requested_field_number && this->enforce_field_number_) {
+  recorder.finish(status->code, consumed, field_count);
+  return field_count;
+}
+
+bool FieldParser::store_group(const ParseStatus& status) const {
+  if (status.code == ParseStatus::Code::kEmptyField) {
+    throw EmptyField("No data read, after begin of execution of"
+                     " `stl_ios_utilities::parse_fields`, or after delimiter"
+                     " and before next delimiter, or terminator.");
+  } else if (status.code == ParseStatus::Code::kMissingFields) {
     throw MissingFields("Too many fields requested by"
                         " `stl_ios_utilities::FieldParser::parse_row`.");
-  } else if (
-      (field_count < requested_field_number && !(this->ignore_underfull_data_))
-      || field_count == requested_field_number) {
-    (*fields) = std::move(tmp_fields);
   }
-  return (*is);
+  return status.ok();
 }
 
-} // namespace stl_ios_utilities
\ No newline at end of file
+} // namespace stl_ios_utilities
@@ -0,0 +1,116 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include "mapped_file.h"
+
+#include "exceptions.h"
+
+#include <string>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define STL_IOS_UTILITIES_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <sstream>
+#endif
+
+namespace stl_ios_utilities {
+
+#ifdef STL_IOS_UTILITIES_HAS_MMAP
+MappedFile::MappedFile(const std::string& path) {
+  int fd{::open(path.c_str(), O_RDONLY)};
+  if (fd < 0) {
+    throw FileError("Unable to open `" + path + "` in"
+                    " `stl_ios_utilities::MappedFile`.");
+  }
+  struct stat status;
+  if (::fstat(fd, &status) != 0) {
+    ::close(fd);
+    throw FileError("Unable to determine size of `" + path + "` in"
+                    " `stl_ios_utilities::MappedFile`.");
+  }
+  size_ = static_cast<std::size_t>(status.st_size);
+  if (size_ > 0) {
+    void* address{::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0)};
+    if (address == MAP_FAILED) {
+      ::close(fd);
+      throw FileError("Unable to map `" + path + "` into memory in"
+                      " `stl_ios_utilities::MappedFile`.");
+    }
+    ::madvise(address, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(address);
+  }
+  ::close(fd);
+}
+
+void MappedFile::release() {
+  if (data_ != nullptr && contents_.empty()) {
+    ::munmap(const_cast<char*>(data_), size_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+}
+#else
+MappedFile::MappedFile(const std::string& path) {
+  std::ifstream ifs{path, std::ios_base::binary};
+  if (!ifs.is_open()) {
+    throw FileError("Unable to open `" + path + "` in"
+                    " `stl_ios_utilities::MappedFile`.");
+  }
+  std::ostringstream contents;
+  contents << ifs.rdbuf();
+  contents_ = contents.str();
+  data_ = contents_.data();
+  size_ = contents_.size();
+}
+
+void MappedFile::release() {
+  contents_.clear();
+  data_ = nullptr;
+  size_ = 0;
+}
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+  (*this) = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    release();
+    contents_ = std::move(other.contents_);
+    data_ = (contents_.empty() ? other.data_ : contents_.data());
+    size_ = other.size_;
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.contents_.clear();
+  }
+  return (*this);
+}
+
+MappedFile::~MappedFile() {
+  release();
+}
+
+} // namespace stl_ios_utilities
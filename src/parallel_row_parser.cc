@@ -0,0 +1,293 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "parallel_row_parser.h"
+
+#include "boundary_search.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+namespace {
+
+using Rows = std::vector<std::vector<std::string>>;
+
+// Returns the offset of the first row beginning at or after `offset`, which is
+// right after the first newline character at or after `offset - 1`.
+std::size_t row_start(const char* data, std::size_t size, std::size_t offset) {
+  if (offset == 0 || offset >= size) {
+    return std::min(offset, size);
+  }
+  const void* newline{std::memchr(data + offset - 1, '\n', size - offset + 1)};
+  if (newline == nullptr) {
+    return size;
+  }
+  return static_cast<std::size_t>(static_cast<const char*>(newline) - data) + 1;
+}
+
+// Parity of the quotes in a segment of quoted data, and the offsets of the
+// first newline characters outside of quoted fields in it if the segment
+// begins outside (index 0) or inside (index 1) of a quoted field.
+struct SegmentScan {
+  bool odd_quotes{false};
+  std::size_t first_newline[2]{std::string::npos, std::string::npos};
+};
+
+// Scans [`begin`, `end`) of `data` under both assumptions about its quoting.
+// Since quotes only occur around and, doubled, inside quoted fields, a
+// newline character is outside of quoted fields if the number of quotes
+// before it in the segment has the parity of the assumption.
+SegmentScan scan_segment(const char* data, std::size_t begin, std::size_t end,
+                         char quote) {
+  SegmentScan scan;
+  const char* position{data + begin};
+  const char* last{data + end};
+  bool odd{false};
+  while (scan.first_newline[0] == std::string::npos
+         || scan.first_newline[1] == std::string::npos) {
+    // finds the next quote or newline character
+    position = find_boundary(position, last, quote);
+    if (position == last) {
+      break;
+    } else if (*position == quote) {
+      odd = !odd;
+    } else if (scan.first_newline[odd] == std::string::npos) {
+      scan.first_newline[odd] = static_cast<std::size_t>(position - data);
+    }
+    ++position;
+  }
+  scan.odd_quotes = odd != (std::count(position, last, quote) % 2 == 1);
+  return scan;
+}
+
+// Returns the offsets at which each of `chunk_count` chunks of `chunk_size`
+// characters of quoted data begins once aligned to rows, followed by `size`.
+// Segments are scanned on `thread_count` threads under both assumptions
+// about their quoting, after which the actual assumptions follow from the
+// parities of the preceding segments in a sequential pass.
+std::vector<std::size_t> align_quoted_chunks(const char* data,
+                                             std::size_t size,
+                                             std::size_t chunk_size,
+                                             std::size_t chunk_count,
+                                             char quote,
+                                             std::size_t thread_count) {
+  // segment `k` begins right before chunk `k`, so that its first newline
+  // character outside of quotes ends the row preceding the chunk
+  std::vector<SegmentScan> scans(chunk_count);
+  std::atomic<std::size_t> next_segment{0};
+  auto work = [&]() {
+    std::size_t k;
+    while ((k = next_segment.fetch_add(1)) < chunk_count) {
+      std::size_t begin{k == 0 ? 0 : k * chunk_size - 1};
+      std::size_t end{std::min((k + 1) * chunk_size - 1, size)};
+      scans[k] = scan_segment(data, begin, end, quote);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (std::size_t i = 1; i < thread_count; ++i) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<bool> inside(chunk_count);
+  bool odd{false};
+  for (std::size_t k = 0; k < chunk_count; ++k) {
+    inside[k] = odd;
+    odd = odd != scans[k].odd_quotes;
+  }
+  // a chunk without a row boundary begins where the next one does
+  std::vector<std::size_t> starts(chunk_count + 1, size);
+  for (std::size_t k = chunk_count - 1; k > 0; --k) {
+    std::size_t newline{scans[k].first_newline[inside[k]]};
+    starts[k] = newline == std::string::npos ? starts[k + 1] : newline + 1;
+  }
+  if (chunk_count > 0) {
+    starts[0] = 0;
+  }
+  return starts;
+}
+
+// State shared by the threads of one call of `ParallelRowParser::parse`.
+struct ChunkSchedule {
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::size_t next_chunk{0};
+  std::size_t next_delivery{0};
+  // parsed chunks waiting for their predecessors in the original order
+  std::map<std::size_t, Rows> completed;
+  // whether a thread is handing over completed chunks, which it does
+  // outside of `mutex`
+  bool delivering{false};
+  std::exception_ptr error;
+};
+
+} // namespace
+
+void ParallelRowParser::parse(const char* data, std::size_t size, Order order,
+                              const RowHandler& handler) const {
+  std::size_t chunk_size{std::max<std::size_t>(this->chunk_size_, 1)};
+  std::size_t chunk_count{size / chunk_size + (size % chunk_size > 0)};
+  std::size_t thread_count{this->thread_count_};
+  if (thread_count == 0) {
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+  thread_count = std::min(thread_count, chunk_count);
+  // parsing runs ahead of handling by at most `window` chunks, which wait for
+  // the thread handing over rows
+  std::size_t window{2 * thread_count};
+  ChunkSchedule schedule;
+
+  // chunks of quoted data cannot be aligned to rows by looking for the next
+  // newline character, which may be quoted, and are aligned up front
+  std::vector<std::size_t> quoted_starts;
+  if (this->parser_.quote_fields() && chunk_count > 0) {
+    quoted_starts = align_quoted_chunks(data, size, chunk_size, chunk_count,
+                                        this->parser_.quote(), thread_count);
+  }
+  auto chunk_start = [&](std::size_t chunk) {
+    return quoted_starts.empty() ? row_start(data, size, chunk * chunk_size)
+                                 : quoted_starts[chunk];
+  };
+
+  auto deliver = [&handler](Rows* rows) {
+    for (std::vector<std::string>& row : *rows) {
+      handler(&row);
+    }
+  };
+
+  // records the exception being handled, unless another one was first
+  auto fail = [&schedule]() {
+    std::lock_guard<std::mutex> lock{schedule.mutex};
+    if (!schedule.error) {
+      schedule.error = std::current_exception();
+    }
+    schedule.changed.notify_all();
+  };
+
+  // Hands over completed chunks until none is left, or, in the original
+  // order, until the next one is still being parsed. Chunks are taken out
+  // under the lock, but handled outside of it, so that other threads keep
+  // parsing in the meantime.
+  auto deliver_completed = [&]() {
+    std::vector<Rows> ready;
+    while (true) {
+      {
+        std::lock_guard<std::mutex> lock{schedule.mutex};
+        schedule.next_delivery += ready.size();
+        schedule.changed.notify_all();
+        ready.clear();
+        auto next = schedule.completed.begin();
+        while (!schedule.error && next != schedule.completed.end()
+               && (order == Order::kUnordered
+                   || next->first == schedule.next_delivery + ready.size())) {
+          ready.push_back(std::move(next->second));
+          next = schedule.completed.erase(next);
+        }
+        if (ready.empty()) {
+          schedule.delivering = false;
+          return;
+        }
+      }
+      for (Rows& rows : ready) {
+        deliver(&rows);
+      }
+    }
+  };
+
+  auto work = [&]() {
+    DelimitedRowParser parser{this->parser_};
+    std::vector<std::string> row;
+    while (true) {
+      std::size_t chunk;
+      {
+        std::unique_lock<std::mutex> lock{schedule.mutex};
+        schedule.changed.wait(lock, [&]() {
+          return schedule.error || schedule.next_chunk >= chunk_count
+                 || schedule.next_chunk < schedule.next_delivery + window;
+        });
+        if (schedule.error || schedule.next_chunk >= chunk_count) {
+          return;
+        }
+        chunk = schedule.next_chunk++;
+      }
+      try {
+        std::size_t begin{chunk_start(chunk)};
+        std::size_t end{chunk_start(chunk + 1)};
+        MemorySource source{data + begin, end - begin};
+        Rows rows;
+        // rows are never empty, unless the parser ignored them
+        while (source.begin() != source.end()) {
+          row.clear();
+          parser.parse_row(&source, &row);
+          if (!row.empty()) {
+            rows.push_back(std::move(row));
+          }
+        }
+        bool hand_over;
+        {
+          std::lock_guard<std::mutex> lock{schedule.mutex};
+          if (schedule.error) {
+            return;
+          }
+          schedule.completed[chunk] = std::move(rows);
+          // a thread already handing over chunks picks up this one
+          hand_over = !schedule.delivering;
+          schedule.delivering = true;
+        }
+        if (hand_over) {
+          deliver_completed();
+        }
+      } catch (...) {
+        fail();
+        return;
+      }
+    }
+  };
+
+  // the calling thread is one of the workers
+  std::vector<std::thread> threads;
+  for (std::size_t i = 1; i < thread_count; ++i) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  if (schedule.error) {
+    std::rethrow_exception(schedule.error);
+  }
+  return;
+}
+
+} // namespace stl_ios_utilities
@@ -0,0 +1,152 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "parse_statistics.h"
+
+#ifdef STL_IOS_UTILITIES_STATISTICS
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#endif
+
+namespace stl_ios_utilities {
+
+namespace internal {
+
+#ifdef STL_IOS_UTILITIES_STATISTICS
+
+namespace {
+
+using Totals = std::uint64_t[StatisticsShard::kCounterCount];
+
+// Shards of the threads recording statistics of one source, and the totals
+// of threads which exited.
+struct ShardRegistry {
+  std::mutex mutex;
+  std::vector<const StatisticsShard*> shards;
+  Totals retired{};
+  // totals at the most recent reset
+  Totals baseline{};
+};
+
+ShardRegistry* registry(StatisticsSource source) {
+  static ShardRegistry registries[2];
+  return &registries[static_cast<int>(source)];
+}
+
+// Registers a shard for the lifetime of its thread; its counts are kept in
+// the registry once the thread exits.
+class ShardOwner {
+ public:
+  explicit ShardOwner(StatisticsSource source) : registry_{registry(source)} {
+    std::lock_guard<std::mutex> lock{registry_->mutex};
+    registry_->shards.push_back(&shard_);
+  }
+
+  ~ShardOwner() {
+    std::lock_guard<std::mutex> lock{registry_->mutex};
+    for (int i = 0; i < StatisticsShard::kCounterCount; ++i) {
+      registry_->retired[i] += shard_.get(
+          static_cast<StatisticsShard::Counter>(i));
+    }
+    registry_->shards.erase(std::find(registry_->shards.begin(),
+                                      registry_->shards.end(), &shard_));
+  }
+
+  ShardOwner(const ShardOwner& other) = delete;
+  ShardOwner& operator=(const ShardOwner& other) = delete;
+
+  StatisticsShard* shard() {return &shard_;}
+
+ private:
+  ShardRegistry* registry_;
+  StatisticsShard shard_;
+};
+
+// sums the counts of all threads; `registry->mutex` must be locked
+void sum_totals(const ShardRegistry& registry, Totals* totals) {
+  for (int i = 0; i < StatisticsShard::kCounterCount; ++i) {
+    (*totals)[i] = registry.retired[i];
+    for (const StatisticsShard* shard : registry.shards) {
+      (*totals)[i] += shard->get(static_cast<StatisticsShard::Counter>(i));
+    }
+  }
+}
+
+} // namespace
+
+StatisticsShard* local_statistics_shard(StatisticsSource source) {
+  if (source == StatisticsSource::kDelimitedRowParser) {
+    static thread_local ShardOwner owner{source};
+    return owner.shard();
+  } else {
+    static thread_local ShardOwner owner{source};
+    return owner.shard();
+  }
+}
+
+ParseStatistics statistics(StatisticsSource source) {
+  ShardRegistry* shards{registry(source)};
+  Totals totals;
+  {
+    std::lock_guard<std::mutex> lock{shards->mutex};
+    sum_totals(*shards, &totals);
+    for (int i = 0; i < StatisticsShard::kCounterCount; ++i) {
+      totals[i] -= shards->baseline[i];
+    }
+  }
+  ParseStatistics result;
+  result.rows_read = totals[StatisticsShard::kRowsRead];
+  result.rows_accepted = totals[StatisticsShard::kRowsAccepted];
+  result.rows_ignored = totals[StatisticsShard::kRowsIgnored];
+  result.rows_rejected = totals[StatisticsShard::kRowsRejected];
+  result.bytes_consumed = totals[StatisticsShard::kBytesConsumed];
+  result.fields_produced = totals[StatisticsShard::kFieldsProduced];
+  result.tokenize_time = std::chrono::nanoseconds(
+      totals[StatisticsShard::kTokenizeNanoseconds]);
+  result.field_parser_time = std::chrono::nanoseconds(
+      totals[StatisticsShard::kFieldParserNanoseconds]);
+  return result;
+}
+
+void reset_statistics(StatisticsSource source) {
+  // shards are only ever written by their threads, so that resetting records
+  // the current totals rather than clearing the shards
+  ShardRegistry* shards{registry(source)};
+  std::lock_guard<std::mutex> lock{shards->mutex};
+  sum_totals(*shards, &shards->baseline);
+  return;
+}
+
+#else
+
+ParseStatistics statistics(StatisticsSource) {
+  return ParseStatistics{};
+}
+
+void reset_statistics(StatisticsSource) {
+  return;
+}
+
+#endif // STL_IOS_UTILITIES_STATISTICS
+
+} // namespace internal
+
+} // namespace stl_ios_utilities
@@ -0,0 +1,345 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "pipelined_row_parser.h"
+
+#include "bounded_queue.h"
+#include "field_view.h"
+#include "input_source.h"
+#include "parse_statistics.h"
+#include "row_scanner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+namespace {
+
+// Unit of work passed between the stages of the pipeline. Blocks are recycled
+// together with the capacity of their members.
+struct Block {
+  // marks the end of a stage's output instead of carrying data
+  bool end{false};
+  std::size_t sequence{0};
+  // complete rows, the last of which is terminated by a newline character
+  std::string data;
+  // spans of the fields of all rows which are not ignored; offsets past the
+  // end of `data` refer to `unquoted` instead
+  std::vector<FieldSpan> fields;
+  // fields whose quotes were removed, which therefore are not part of `data`
+  std::string unquoted;
+  // number of fields of each row
+  std::vector<std::size_t> widths;
+  std::vector<std::vector<std::string>> rows;
+};
+
+// State shared by the stages of one call of `PipelinedRowParser::parse`.
+class Pipeline {
+ public:
+  Pipeline(std::size_t block_count, std::size_t transform_threads)
+      : free_blocks{block_count},
+        read_blocks{block_count + 1},
+        tokenized_blocks{block_count + transform_threads},
+        transformed_blocks{block_count + transform_threads} {
+    for (std::size_t i = 0; i < block_count; ++i) {
+      Block block;
+      free_blocks.try_push(&block);
+    }
+  }
+
+  // Records the exception being handled, unless another stage failed first,
+  // and makes all stages stop.
+  void fail() {
+    std::lock_guard<std::mutex> lock{error_mutex_};
+    if (!error_) {
+      error_ = std::current_exception();
+    }
+    failed_.store(true, std::memory_order_release);
+  }
+
+  bool failed() const {return failed_.load(std::memory_order_acquire);}
+
+  void rethrow_error() {
+    if (error_) {
+      std::rethrow_exception(error_);
+    }
+  }
+
+  // Pushes `*block` to `queue`, waiting while it is full. Returns `false` if
+  // the pipeline failed in the meantime.
+  bool push(BoundedQueue<Block>* queue, Block* block) {
+    return wait([queue, block]() {return queue->try_push(block);});
+  }
+
+  // Pops the front of `queue` to `*block`, waiting while it is empty. Returns
+  // `false` if the pipeline failed in the meantime.
+  bool pop(BoundedQueue<Block>* queue, Block* block) {
+    return wait([queue, block]() {return queue->try_pop(block);});
+  }
+
+  BoundedQueue<Block> free_blocks;
+  BoundedQueue<Block> read_blocks;
+  BoundedQueue<Block> tokenized_blocks;
+  BoundedQueue<Block> transformed_blocks;
+
+ private:
+  // Retries `operation` until it succeeds, yielding at first and then
+  // sleeping briefly, so that idle stages do not occupy a core for long.
+  template <typename Operation>
+  bool wait(Operation operation) {
+    int attempts{0};
+    while (!operation()) {
+      if (failed()) {
+        return false;
+      } else if (++attempts < 64) {
+        std::this_thread::yield();
+      } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+      }
+    }
+    return true;
+  }
+
+  std::atomic<bool> failed_{false};
+  std::mutex error_mutex_;
+  std::exception_ptr error_;
+};
+
+// Reads blocks of complete rows from `is`.
+void read_stage(Pipeline* pipeline, std::istream* is, std::size_t block_size) {
+  std::string carry;
+  std::size_t sequence{0};
+  bool end{false};
+  while (!end) {
+    Block block;
+    if (!pipeline->pop(&pipeline->free_blocks, &block)) {
+      return;
+    }
+    block.data.assign(carry);
+    carry.clear();
+    // the partial row in `carry` contains no newline character, so that the
+    // last newline character of the block completes its last row
+    while (true) {
+      std::size_t size{block.data.size()};
+      block.data.resize(size + block_size);
+      is->read(&block.data[size], block_size);
+      block.data.resize(size + static_cast<std::size_t>(is->gcount()));
+      if (!(*is)) {
+        end = true;
+        break;
+      }
+      std::size_t newline{block.data.rfind('\n')};
+      if (newline != std::string::npos) {
+        carry.assign(block.data, newline + 1, std::string::npos);
+        block.data.resize(newline + 1);
+        break;
+      }
+    }
+    block.sequence = sequence++;
+    if (!pipeline->push(&pipeline->read_blocks, &block)) {
+      return;
+    }
+  }
+  Block marker;
+  marker.end = true;
+  pipeline->push(&pipeline->read_blocks, &marker);
+}
+
+// Splits blocks into rows, enforcing the numbers of fields of `parser`.
+void tokenize_stage(Pipeline* pipeline, DelimitedRowParser parser,
+                    std::size_t transform_threads) {
+  std::vector<FieldView> row;
+  while (true) {
+    Block block;
+    if (!pipeline->pop(&pipeline->read_blocks, &block)) {
+      return;
+    }
+    if (block.end) {
+      break;
+    }
+    // the last row of the input may lack its newline character
+    if (!block.data.empty() && block.data.back() != '\n') {
+      block.data.push_back('\n');
+    }
+    block.fields.clear();
+    block.widths.clear();
+    block.unquoted.clear();
+    const char* data{block.data.data()};
+    std::size_t size{block.data.size()};
+    MemorySource source{data, size};
+    while (source.begin() != source.end()) {
+      row.clear();
+      parser.parse_row(&source, &row);
+      if (!row.empty()) {
+        block.widths.push_back(row.size());
+        for (const FieldView& field : row) {
+          // views of unquoted fields point into the parser's scanner and are
+          // only valid until the next row is parsed
+          if (field.data() >= data && field.data() <= data + size) {
+            block.fields.push_back(FieldSpan{
+                static_cast<std::size_t>(field.data() - data), field.size()});
+          } else {
+            block.fields.push_back(FieldSpan{size + block.unquoted.size(),
+                                             field.size()});
+            block.unquoted.append(field.data(), field.size());
+          }
+        }
+      }
+    }
+    if (!pipeline->push(&pipeline->tokenized_blocks, &block)) {
+      return;
+    }
+  }
+  for (std::size_t i = 0; i < transform_threads; ++i) {
+    Block marker;
+    marker.end = true;
+    if (!pipeline->push(&pipeline->tokenized_blocks, &marker)) {
+      return;
+    }
+  }
+}
+
+// Copies fields into rows of strings and applies the field parsers of
+// `column_plan`, indexed by position in the tokenized row.
+void transform_stage(
+    Pipeline* pipeline,
+    const std::vector<std::function<void(std::string*)>>& column_plan) {
+  internal::StatisticsRecorder recorder{StatisticsSource::kDelimitedRowParser};
+  while (true) {
+    Block block;
+    if (!pipeline->pop(&pipeline->tokenized_blocks, &block)) {
+      return;
+    }
+    if (!block.end) {
+      block.rows.resize(block.widths.size());
+      std::size_t next_field{0};
+      for (std::size_t i = 0; i < block.widths.size(); ++i) {
+        std::vector<std::string>& row = block.rows[i];
+        row.resize(block.widths[i]);
+        for (std::size_t column = 0; column < row.size(); ++column) {
+          const FieldSpan& span = block.fields[next_field++];
+          if (span.offset < block.data.size()) {
+            row[column].assign(block.data, span.offset, span.length);
+          } else {
+            row[column].assign(block.unquoted,
+                               span.offset - block.data.size(), span.length);
+          }
+          if (column < column_plan.size() && column_plan[column]) {
+            recorder.call_field_parser(column_plan[column], &row[column]);
+          }
+        }
+      }
+    }
+    bool end{block.end};
+    if (!pipeline->push(&pipeline->transformed_blocks, &block) || end) {
+      return;
+    }
+  }
+}
+
+// Runs `stage` and records its exception, if any.
+template <typename Stage>
+void run_stage(Pipeline* pipeline, Stage stage) {
+  try {
+    stage();
+  } catch (...) {
+    pipeline->fail();
+  }
+}
+
+} // namespace
+
+std::istream& PipelinedRowParser::parse(std::istream* is,
+                                        const RowHandler& handler) const {
+  std::size_t block_size{std::max<std::size_t>(this->block_size_, 1)};
+  std::size_t block_count{std::max<std::size_t>(this->block_count_, 2)};
+  std::size_t transform_threads{this->transform_threads_};
+  if (transform_threads == 0) {
+    unsigned hardware_threads{std::thread::hardware_concurrency()};
+    transform_threads = hardware_threads > 3 ? hardware_threads - 2 : 1;
+  }
+  // field parsers, indexed by position in the tokenized row, which only
+  // holds the selected columns, if any
+  std::vector<std::function<void(std::string*)>> column_plan{
+      this->parser_.stored_column_plan()};
+
+  Pipeline pipeline{block_count, transform_threads};
+  std::vector<std::thread> threads;
+  threads.emplace_back([&]() {
+    run_stage(&pipeline, [&]() {read_stage(&pipeline, is, block_size);});
+  });
+  threads.emplace_back([&]() {
+    run_stage(&pipeline, [&]() {
+      tokenize_stage(&pipeline, this->parser_, transform_threads);
+    });
+  });
+  for (std::size_t i = 0; i < transform_threads; ++i) {
+    threads.emplace_back([&]() {
+      run_stage(&pipeline, [&]() {transform_stage(&pipeline, column_plan);});
+    });
+  }
+
+  // hands rows to `handler` in the order of their blocks, which the
+  // transform threads may finish out of order
+  run_stage(&pipeline, [&]() {
+    std::map<std::size_t, Block> pending;
+    std::size_t next_sequence{0};
+    std::size_t ended{0};
+    while (ended < transform_threads) {
+      Block block;
+      if (!pipeline.pop(&pipeline.transformed_blocks, &block)) {
+        return;
+      }
+      if (block.end) {
+        ++ended;
+        continue;
+      }
+      std::size_t sequence{block.sequence};
+      pending.emplace(sequence, std::move(block));
+      auto next = pending.begin();
+      while (next != pending.end() && next->first == next_sequence) {
+        for (std::vector<std::string>& row : next->second.rows) {
+          handler(&row);
+        }
+        if (!pipeline.push(&pipeline.free_blocks, &next->second)) {
+          return;
+        }
+        next = pending.erase(next);
+        ++next_sequence;
+      }
+    }
+  });
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  pipeline.rethrow_error();
+  return (*is);
+}
+
+} // namespace stl_ios_utilities
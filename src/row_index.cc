@@ -0,0 +1,388 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "row_index.h"
+
+#include "exceptions.h"
+#include "field_view.h"
+#include "input_source.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define STL_IOS_UTILITIES_HAS_POSIX 1
+#include <cerrno>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace stl_ios_utilities {
+
+namespace {
+
+// identifies sidecar files and the version of their layout
+constexpr char kMagic[8]{'S', 'I', 'U', 'R', 'I', 'D', 'X', '2'};
+
+// Finds the ends of rows with the delimiter and quoting options of a parser.
+class RowBoundaries {
+ public:
+  explicit RowBoundaries(const DelimitedRowParser& parser) {
+    splitter_.delimiter(parser.delimiter());
+    splitter_.quote_fields(parser.quote_fields());
+    splitter_.quote(parser.quote());
+  }
+
+  // Returns the offset right after the row beginning at `offset`.
+  std::size_t next(const char* data, std::size_t size, std::size_t offset) {
+    if (!splitter_.quote_fields()) {
+      const void* newline{std::memchr(data + offset, '\n', size - offset)};
+      return newline == nullptr
+             ? size
+             : static_cast<std::size_t>(
+                   static_cast<const char*>(newline) - data) + 1;
+    }
+    // newline characters may be quoted, and only a parse finds the row's end
+    MemorySource source{data + offset, size - offset};
+    splitter_.parse_row(&source, &fields_);
+    return static_cast<std::size_t>(source.begin() - data);
+  }
+
+ private:
+  DelimitedRowParser splitter_;
+  std::vector<FieldView> fields_;
+};
+
+// Size and modification time in nanoseconds since the epoch of a file.
+struct FileStamp {
+  std::uint64_t size{0};
+  std::int64_t time{0};
+};
+
+// Returns `false` if the file at `path` cannot be examined. Where *stat* is
+// unavailable, files are stamped by their size only.
+bool stamp_file(const std::string& path, FileStamp* stamp) {
+#ifdef STL_IOS_UTILITIES_HAS_POSIX
+  struct stat status;
+  if (::stat(path.c_str(), &status) != 0) {
+    return false;
+  }
+  stamp->size = static_cast<std::uint64_t>(status.st_size);
+#ifdef __APPLE__
+  const struct timespec& time = status.st_mtimespec;
+#else
+  const struct timespec& time = status.st_mtim;
+#endif
+  stamp->time = static_cast<std::int64_t>(time.tv_sec) * 1000000000
+                + static_cast<std::int64_t>(time.tv_nsec);
+  return true;
+#else
+  std::ifstream ifs{path, std::ios_base::binary | std::ios_base::ate};
+  if (!ifs.is_open()) {
+    return false;
+  }
+  stamp->size = static_cast<std::uint64_t>(ifs.tellg());
+  stamp->time = 0;
+  return true;
+#endif
+}
+
+// Appends `value` in seven-bit groups, least significant first, with the high
+// bit of each byte set if more follow.
+void append_varint(std::uint64_t value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+// Reads a value appended by `append_varint` at `*position` and advances past
+// it. Returns `false` if the data ends or the value exceeds 64 bits.
+bool read_varint(const std::string& data, std::size_t* position,
+                 std::uint64_t* value) {
+  (*value) = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7) {
+    if (*position >= data.size()) {
+      return false;
+    }
+    std::uint64_t byte{static_cast<unsigned char>(data[(*position)++])};
+    (*value) |= (byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Writes `data` to a new file with a unique name next to `path` and returns
+// the new file's path.
+std::string write_temporary_file(const std::string& path,
+                                 const std::string& data) {
+#ifdef STL_IOS_UTILITIES_HAS_POSIX
+  std::string temporary_path{path + ".XXXXXX"};
+  int fd{::mkstemp(&temporary_path[0])};
+  if (fd < 0) {
+    throw FileError("Unable to create a temporary file for `" + path + "` in"
+                    " `stl_ios_utilities::RowIndex`.");
+  }
+  // readable like files created with default permissions
+  mode_t mask{::umask(0)};
+  ::umask(mask);
+  bool written{::fchmod(fd, 0666 & ~mask) == 0};
+  const char* position{data.data()};
+  std::size_t remaining{data.size()};
+  while (written && remaining > 0) {
+    ssize_t count{::write(fd, position, remaining)};
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    written = count > 0;
+    position += written ? count : 0;
+    remaining -= written ? static_cast<std::size_t>(count) : 0;
+  }
+  written = (::close(fd) == 0) && written;
+#else
+  std::string temporary_path{path + ".tmp"};
+  std::ofstream ofs{temporary_path,
+                    std::ios_base::binary | std::ios_base::trunc};
+  ofs.write(data.data(), static_cast<std::streamsize>(data.size()));
+  ofs.close();
+  bool written{!ofs.fail()};
+#endif
+  if (!written) {
+    std::remove(temporary_path.c_str());
+    throw FileError("Unable to write `" + temporary_path + "` in"
+                    " `stl_ios_utilities::RowIndex`.");
+  }
+  return temporary_path;
+}
+
+} // namespace
+
+RowIndex RowIndex::build(const DelimitedRowParser& parser, const char* data,
+                         std::size_t size, std::size_t stride) {
+  RowIndex index{parser, stride};
+  RowBoundaries boundaries{parser};
+  std::size_t offset{0};
+  while (offset < size) {
+    index.record(offset);
+    offset = boundaries.next(data, size, offset);
+  }
+  return index;
+}
+
+RowIndex RowIndex::build(const DelimitedRowParser& parser,
+                         const std::string& path, std::size_t stride) {
+  // stamped before reading, so that changes while reading make it stale
+  FileStamp stamp;
+  if (!stamp_file(path, &stamp)) {
+    throw FileError("Unable to examine `" + path + "` in"
+                    " `stl_ios_utilities::RowIndex`.");
+  }
+  MappedFile file{path};
+  RowIndex index{build(parser, file.data(), file.size(), stride)};
+  index.file_size_ = stamp.size;
+  index.file_time_ = stamp.time;
+  return index;
+}
+
+std::uint64_t RowIndex::locate(std::size_t row,
+                               std::size_t* indexed_row) const {
+  if (row >= this->row_count_) {
+    throw InvalidArgument("Row " + std::to_string(row) + " is beyond the "
+                          + std::to_string(this->row_count_) + " rows of"
+                          " `stl_ios_utilities::RowIndex`.");
+  }
+  std::size_t position{row / this->stride_};
+  (*indexed_row) = position * this->stride_;
+  return this->offsets_[position];
+}
+
+void RowIndex::save(const std::string& index_path) const {
+  std::string data{kMagic, sizeof(kMagic)};
+  append_varint(this->file_size_, &data);
+  append_varint(static_cast<std::uint64_t>(this->file_time_), &data);
+  append_varint(this->stride_, &data);
+  data.push_back(this->quote_fields_ ? '1' : '0');
+  data.push_back(this->quote_);
+  data.push_back(this->delimiter_);
+  append_varint(this->row_count_, &data);
+  std::uint64_t previous{0};
+  for (std::uint64_t offset : this->offsets_) {
+    append_varint(offset - previous, &data);
+    previous = offset;
+  }
+
+  std::string temporary_path{write_temporary_file(index_path, data)};
+  if (std::rename(temporary_path.c_str(), index_path.c_str()) != 0) {
+    std::remove(temporary_path.c_str());
+    throw FileError("Unable to replace `" + index_path + "` in"
+                    " `stl_ios_utilities::RowIndex`.");
+  }
+}
+
+bool RowIndex::load(const std::string& index_path,
+                    const std::string& data_path,
+                    const DelimitedRowParser& parser, std::size_t stride,
+                    RowIndex* index) {
+  FileStamp stamp;
+  return stamp_file(data_path, &stamp)
+         && load(index_path, stamp.size, stamp.time, parser, stride, index);
+}
+
+bool RowIndex::load(const std::string& index_path, std::uint64_t file_size,
+                    std::int64_t file_time, const DelimitedRowParser& parser,
+                    std::size_t stride, RowIndex* index) {
+  std::ifstream ifs{index_path, std::ios_base::binary};
+  if (!ifs.is_open()) {
+    return false;
+  }
+  std::string data{std::istreambuf_iterator<char>{ifs},
+                   std::istreambuf_iterator<char>{}};
+  if (data.size() < sizeof(kMagic)
+      || data.compare(0, sizeof(kMagic), kMagic, sizeof(kMagic)) != 0) {
+    return false;
+  }
+  std::size_t position{sizeof(kMagic)};
+  std::uint64_t size;
+  std::uint64_t time;
+  std::uint64_t saved_stride;
+  std::uint64_t row_count;
+  if (!read_varint(data, &position, &size)
+      || !read_varint(data, &position, &time)
+      || !read_varint(data, &position, &saved_stride)
+      || data.size() - position < 3) {
+    return false;
+  }
+  RowIndex loaded{static_cast<std::size_t>(saved_stride)};
+  loaded.quote_fields_ = data[position] == '1';
+  loaded.quote_ = data[position + 1];
+  loaded.delimiter_ = data[position + 2];
+  position += 3;
+  if (!read_varint(data, &position, &row_count)
+      || size != file_size || static_cast<std::int64_t>(time) != file_time
+      || saved_stride != std::max<std::size_t>(stride, 1)
+      || !loaded.splits_like(parser)) {
+    return false;
+  }
+  loaded.row_count_ = static_cast<std::size_t>(row_count);
+  loaded.file_size_ = size;
+  loaded.file_time_ = file_time;
+  std::uint64_t offset_count{row_count / saved_stride
+                             + (row_count % saved_stride > 0)};
+  // each offset takes at least one byte, which bounds the reservation
+  if (offset_count > data.size() - position) {
+    return false;
+  }
+  loaded.offsets_.reserve(static_cast<std::size_t>(offset_count));
+  std::uint64_t offset{0};
+  for (std::uint64_t i = 0; i < offset_count; ++i) {
+    std::uint64_t delta;
+    if (!read_varint(data, &position, &delta)) {
+      return false;
+    }
+    offset += delta;
+    loaded.offsets_.push_back(offset);
+  }
+  if (position != data.size()) {
+    return false;
+  }
+  (*index) = std::move(loaded);
+  return true;
+}
+
+IndexedRowReader::IndexedRowReader(const std::string& path,
+                                   const DelimitedRowParser& parser,
+                                   std::size_t stride)
+    : parser_{parser} {
+  // the file is stamped before it is mapped, and the index is loaded for or
+  // built from that mapping, so that it cannot describe a later version
+  FileStamp stamp;
+  if (!stamp_file(path, &stamp)) {
+    throw FileError("Unable to examine `" + path + "` in"
+                    " `stl_ios_utilities::IndexedRowReader`.");
+  }
+  this->file_ = MappedFile{path};
+  std::string index_path{RowIndex::sidecar_path(path)};
+  if (!RowIndex::load(index_path, stamp.size, stamp.time, parser, stride,
+                      &this->index_)) {
+    this->index_ = RowIndex::build(parser, this->file_.data(),
+                                   this->file_.size(), stride);
+    this->index_.file_size_ = stamp.size;
+    this->index_.file_time_ = stamp.time;
+    try {
+      this->index_.save(index_path);
+    } catch (const FileError&) {}
+  }
+}
+
+std::size_t IndexedRowReader::read_rows(std::size_t first, std::size_t count,
+                                        const RowHandler& handler) {
+  std::size_t row_count{this->index_.row_count()};
+  if (first >= row_count || count == 0) {
+    return 0;
+  }
+  count = std::min(count, row_count - first);
+  const char* data{this->file_.data()};
+  std::size_t size{this->file_.size()};
+  std::size_t row;
+  std::size_t offset{
+      static_cast<std::size_t>(this->index_.locate(first, &row))};
+  RowBoundaries boundaries{this->parser_};
+  for (; row < first; ++row) {
+    offset = boundaries.next(data, size, offset);
+  }
+  MemorySource source{data + offset, size - offset};
+  std::vector<std::string> fields;
+  for (std::size_t i = 0; i < count; ++i) {
+    fields.clear();
+    this->parser_.parse_row(&source, &fields);
+    // rows are never empty, unless the parser ignored them
+    if (!fields.empty()) {
+      handler(&fields);
+    }
+  }
+  return count;
+}
+
+bool IndexedRowReader::read_row(std::size_t row,
+                                std::vector<std::string>* fields) {
+  if (row >= this->index_.row_count()) {
+    throw InvalidArgument("Row " + std::to_string(row) + " is beyond the "
+                          + std::to_string(this->index_.row_count())
+                          + " rows of `stl_ios_utilities::IndexedRowReader`.");
+  }
+  fields->clear();
+  bool parsed{false};
+  this->read_rows(row, 1, [fields, &parsed](std::vector<std::string>* row) {
+    fields->swap(*row);
+    parsed = true;
+  });
+  return parsed;
+}
+
+} // namespace stl_ios_utilities
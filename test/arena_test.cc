@@ -0,0 +1,84 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "gtest/gtest.h"
+
+#include "arena.h"
+
+#include <cstdint>
+#include <string>
+
+namespace stl_ios_utilities {
+
+namespace {
+
+TEST(ArenaTest, AllocatesAlignedMemoryFromBlocks) {
+  Arena arena{64};
+  char* first{static_cast<char*>(arena.allocate(3, 1))};
+  char* second{static_cast<char*>(arena.allocate(8, 8))};
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(second) % 8);
+  EXPECT_GE(second, first + 3);
+  EXPECT_EQ(64u, arena.capacity());
+  // requests larger than the block size get blocks of their own
+  arena.allocate(100, 1);
+  EXPECT_GE(arena.capacity(), 164u);
+  arena.allocate(60, 1);
+  std::size_t capacity{arena.capacity()};
+
+  // after a reset, the same memory is handed out again without new blocks
+  arena.reset();
+  EXPECT_EQ(first, arena.allocate(3, 1));
+  EXPECT_EQ(second, arena.allocate(8, 8));
+  arena.allocate(100, 1);
+  arena.allocate(60, 1);
+  EXPECT_EQ(capacity, arena.capacity());
+}
+
+TEST(ArenaTest, ContainersUseTheArena) {
+  Arena arena{256};
+  ArenaRow row{ArenaRow::allocator_type{&arena}};
+  std::string long_field(100, 'x');
+  row.emplace_back("a");
+  row.emplace_back(long_field.data(), long_field.size());
+  EXPECT_EQ(&arena, row[1].get_allocator().arena());
+  EXPECT_EQ(ArenaString(long_field.data(), ArenaAllocator<char>{&arena}),
+            row[1]);
+  row = ArenaRow{ArenaRow::allocator_type{&arena}};
+  std::size_t capacity{arena.capacity()};
+  // rows of the same size fit into the kept blocks after each reset
+  for (int i = 0; i < 10; ++i) {
+    arena.reset();
+    {
+      ArenaRow other{ArenaRow::allocator_type{&arena}};
+      other.emplace_back("a");
+      other.emplace_back(long_field.data(), long_field.size());
+    }
+  }
+  EXPECT_EQ(capacity, arena.capacity());
+
+  Arena other_arena;
+  EXPECT_TRUE(ArenaAllocator<char>{&arena} == ArenaAllocator<int>{&arena});
+  EXPECT_TRUE(ArenaAllocator<char>{&arena}
+              != ArenaAllocator<char>{&other_arena});
+}
+
+} // namespace
+
+} // namespace stl_ios_utilities
@@ -0,0 +1,108 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include "gtest/gtest.h"
+
+#include "boundary_search.h"
+
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+namespace {
+
+class BoundarySearchTest : public ::testing::Test {
+ protected:
+  std::vector<std::pair<std::string, internal::BoundarySearch>> kernels;
+
+  void SetUp() override {
+    kernels.emplace_back("scalar", internal::find_boundary_scalar);
+#ifdef STL_IOS_UTILITIES_X86_KERNELS
+    kernels.emplace_back("sse2", internal::find_boundary_sse2);
+    if (internal::cpu_supports_avx2()) {
+      kernels.emplace_back("avx2", internal::find_boundary_avx2);
+    }
+#endif
+  }
+};
+
+TEST_F(BoundarySearchTest, EmptyRange) {
+  std::string data{"\t\n"};
+  for (const auto& kernel : kernels) {
+    EXPECT_EQ(data.data(), kernel.second(data.data(), data.data(), '\t'))
+        << kernel.first;
+  }
+}
+
+TEST_F(BoundarySearchTest, EveryPosition) {
+  // boundary at every position of ranges longer than several blocks, with the
+  // range starting at every alignment
+  for (const auto& kernel : kernels) {
+    for (std::size_t length = 0; length < 100; ++length) {
+      for (std::size_t shift = 0; shift < 4; ++shift) {
+        for (char boundary : {'\t', '\n'}) {
+          std::string data(shift + length + 1, 'x');
+          data[shift + length] = boundary;
+          const char* first{data.data() + shift};
+          EXPECT_EQ(first + length,
+                    kernel.second(first, data.data() + data.size(), '\t'))
+              << kernel.first << " length " << length << " shift " << shift;
+          EXPECT_EQ(first + length,
+                    kernel.second(first, first + length, '\t'))
+              << kernel.first << " length " << length << " shift " << shift;
+        }
+      }
+    }
+  }
+}
+
+TEST_F(BoundarySearchTest, MatchesScalarOnRandomInput) {
+  std::mt19937 generator{7};
+  std::uniform_int_distribution<int> byte{0, 255};
+  std::string data(5000, '\0');
+  for (char& c : data) {
+    c = static_cast<char>(byte(generator));
+  }
+  for (char delimiter : {'\t', ',', '\xff', '\0'}) {
+    const char* last{data.data() + data.size()};
+    for (const auto& kernel : kernels) {
+      const char* expected{data.data()};
+      const char* result{data.data()};
+      while (expected != last) {
+        expected = internal::find_boundary_scalar(expected, last, delimiter);
+        result = kernel.second(result, last, delimiter);
+        ASSERT_EQ(expected, result) << kernel.first;
+        if (expected != last) {
+          ++expected;
+          ++result;
+        }
+      }
+    }
+  }
+  EXPECT_EQ(data.data() + data.size(),
+            find_boundary(data.data() + data.size(),
+                          data.data() + data.size(), '\t'));
+}
+
+} // namespace
+
+} // namespace stl_ios_utilities
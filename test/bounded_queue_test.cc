@@ -0,0 +1,104 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "gtest/gtest.h"
+
+#include "bounded_queue.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+namespace {
+
+TEST(BoundedQueueTest, FifoUntilFull) {
+  BoundedQueue<std::string> queue{3};
+  EXPECT_EQ(4u, queue.capacity());
+  std::string value;
+  EXPECT_FALSE(queue.try_pop(&value));
+  for (std::string item : {"a", "b", "c", "d"}) {
+    EXPECT_TRUE(queue.try_push(&item));
+  }
+  std::string rejected{"e"};
+  EXPECT_FALSE(queue.try_push(&rejected));
+  EXPECT_EQ("e", rejected);
+  for (std::string item : {"a", "b", "c", "d"}) {
+    ASSERT_TRUE(queue.try_pop(&value));
+    EXPECT_EQ(item, value);
+  }
+  EXPECT_FALSE(queue.try_pop(&value));
+  // positions wrap around the ring
+  for (int i = 0; i < 10; ++i) {
+    std::string item{std::to_string(i)};
+    ASSERT_TRUE(queue.try_push(&item));
+    ASSERT_TRUE(queue.try_pop(&value));
+    EXPECT_EQ(std::to_string(i), value);
+  }
+}
+
+TEST(BoundedQueueTest, ConcurrentProducersAndConsumers) {
+  constexpr int kThreads{4};
+  constexpr int kItemsPerThread{20000};
+  BoundedQueue<int> queue{8};
+  std::vector<std::vector<int>> popped(kThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&queue, t]() {
+      for (int i = 0; i < kItemsPerThread; ++i) {
+        int item{t * kItemsPerThread + i};
+        while (!queue.try_push(&item)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+    threads.emplace_back([&queue, &popped, t]() {
+      int item;
+      while (popped[t].size() < static_cast<std::size_t>(kItemsPerThread)) {
+        if (queue.try_pop(&item)) {
+          popped[t].push_back(item);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  // every item is popped exactly once, and items of one producer in order
+  std::vector<int> count(kThreads * kItemsPerThread, 0);
+  for (const std::vector<int>& items : popped) {
+    std::vector<int> last(kThreads, -1);
+    for (int item : items) {
+      ++count[item];
+      EXPECT_LT(last[item / kItemsPerThread], item);
+      last[item / kItemsPerThread] = item;
+    }
+  }
+  for (int c : count) {
+    ASSERT_EQ(1, c);
+  }
+}
+
+} // namespace
+
+} // namespace stl_ios_utilities
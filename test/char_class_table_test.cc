@@ -0,0 +1,157 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include "gtest/gtest.h"
+
+#include "char_class_table.h"
+
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+namespace {
+
+class CharClassTableTest : public ::testing::Test {
+ protected:
+  std::vector<std::pair<std::string, internal::FieldScan>> kernels;
+  std::mt19937 generator{11};
+
+  void SetUp() override {
+#ifdef STL_IOS_UTILITIES_X86_KERNELS
+    if (internal::cpu_supports_ssse3()) {
+      kernels.emplace_back("ssse3", internal::scan_field_ssse3);
+    }
+    if (internal::cpu_supports_avx2()) {
+      kernels.emplace_back("avx2", internal::scan_field_avx2);
+    }
+#endif
+  }
+
+  std::unordered_set<char> random_set(int size) {
+    std::uniform_int_distribution<int> byte{0, 255};
+    std::unordered_set<char> set;
+    while (static_cast<int>(set.size()) < size) {
+      set.insert(static_cast<char>(byte(generator)));
+    }
+    return set;
+  }
+
+  // characters drawn from `special` with the given probability and from all
+  // byte values otherwise
+  std::string random_input(const std::string& special, double density) {
+    std::uniform_int_distribution<int> byte{0, 255};
+    std::uniform_int_distribution<std::size_t> pick{0, special.size() - 1};
+    std::bernoulli_distribution use_special{density};
+    std::string input(3000, '\0');
+    for (char& c : input) {
+      c = (use_special(generator) ? special[pick(generator)]
+                                  : static_cast<char>(byte(generator)));
+    }
+    return input;
+  }
+
+  // compares each kernel to the scalar kernel, field by field
+  void compare_kernels(const CharClassTable& table, const std::string& input) {
+    const char* last{input.data() + input.size()};
+    for (const auto& kernel : kernels) {
+      const char* expected{input.data()};
+      const char* result{input.data()};
+      while (expected != last) {
+        std::string expected_field, result_field;
+        expected = internal::scan_field_scalar(expected, last, table,
+                                               &expected_field);
+        result = kernel.second(result, last, table, &result_field);
+        ASSERT_EQ(expected - input.data(), result - input.data())
+            << kernel.first;
+        ASSERT_EQ(expected_field, result_field) << kernel.first;
+        if (expected != last) {
+          ++expected;
+          ++result;
+        }
+      }
+    }
+  }
+};
+
+TEST_F(CharClassTableTest, Precedence) {
+  CharClassTable table;
+  EXPECT_EQ(CharClass::kOrdinary, table['\t']);
+  table.compile({'\t', ','}, {'\n', ','}, {'#', '\t', '\n'});
+  EXPECT_EQ(CharClass::kDelimiter, table['\t']);
+  EXPECT_EQ(CharClass::kTerminator, table[',']);
+  EXPECT_EQ(CharClass::kTerminator, table['\n']);
+  EXPECT_EQ(CharClass::kMasked, table['#']);
+  EXPECT_EQ(CharClass::kOrdinary, table['a']);
+  EXPECT_TRUE(table.has_masked());
+}
+
+TEST_F(CharClassTableTest, ScanField) {
+  CharClassTable table;
+  table.compile({'\t'}, {'\n'}, {'#'});
+  std::string input{"ab#cdefghijklmnopqrstuvwxyz#0123456789#\tnext"};
+  std::string field;
+  const char* stop{table.scan_field(input.data(), input.data() + input.size(),
+                                    &field)};
+  EXPECT_EQ('\t', *stop);
+  EXPECT_EQ("abcdefghijklmnopqrstuvwxyz0123456789", field);
+}
+
+TEST_F(CharClassTableTest, KernelsMatchScalar) {
+  for (int size : {1, 4, 16, 40, 100}) {
+    for (double density : {0.01, 0.2, 0.9}) {
+      std::unordered_set<char> delimiters{random_set(size)};
+      std::unordered_set<char> terminators{random_set(1 + size / 4)};
+      std::unordered_set<char> masked{random_set(size)};
+      std::string special;
+      for (const auto* set : {&delimiters, &terminators, &masked}) {
+        special.append(set->begin(), set->end());
+      }
+      CharClassTable table;
+      table.compile(delimiters, terminators, masked);
+      compare_kernels(table, random_input(special, density));
+      table.compile(delimiters, terminators, {});
+      compare_kernels(table, random_input(special, density));
+    }
+  }
+}
+
+TEST_F(CharClassTableTest, EveryHighNibble) {
+  // a set using all 16 high nibbles with distinct low nibble sets requires
+  // both rounds of the nibble tables
+  std::unordered_set<char> masked;
+  for (int high = 0; high < 16; ++high) {
+    masked.insert(static_cast<char>((high << 4) | high));
+    masked.insert(static_cast<char>((high << 4) | ((high + 1) % 16)));
+  }
+  CharClassTable table;
+  table.compile({'\t'}, {'\n'}, masked);
+  EXPECT_EQ(2, table.masked_table().rounds);
+  EXPECT_EQ(1, table.stop_table().rounds);
+  std::string special(masked.begin(), masked.end());
+  special.append("\t\n");
+  compare_kernels(table, random_input(special, 0.5));
+}
+
+} // namespace
+
+} // namespace stl_ios_utilities
@@ -0,0 +1,76 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef STL_IOS_UTILITIES_CHUNKED_STREAMBUF_H_
+#define STL_IOS_UTILITIES_CHUNKED_STREAMBUF_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <streambuf>
+#include <string>
+#include <utility>
+
+namespace stl_ios_utilities {
+
+namespace test {
+
+// exposes at most `window` characters of a string at a time; a `window` of 0
+// makes the buffer unbuffered
+class ChunkedStreambuf : public std::streambuf {
+public:
+  ChunkedStreambuf(std::string data, std::size_t window)
+      : data_{std::move(data)}, window_{window} {}
+
+protected:
+  int_type underflow() override {
+    if (position_ >= data_.size()) {
+      return traits_type::eof();
+    }
+    if (window_ == 0) {
+      return traits_type::to_int_type(data_[position_]);
+    }
+    std::size_t length = std::min(window_, data_.size() - position_);
+    char* begin = &data_[position_];
+    setg(begin, begin, begin + length);
+    position_ += length;
+    return traits_type::to_int_type(*begin);
+  }
+
+  int_type uflow() override {
+    if (window_ != 0) {
+      return std::streambuf::uflow();
+    }
+    if (position_ >= data_.size()) {
+      return traits_type::eof();
+    }
+    return traits_type::to_int_type(data_[position_++]);
+  }
+
+private:
+  std::string data_;
+  std::size_t window_;
+  std::size_t position_{0};
+};
+
+} // namespace test
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_CHUNKED_STREAMBUF_H_
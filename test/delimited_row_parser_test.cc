@@ -20,6 +20,7 @@
 
 #include "gtest/gtest.h"
 
+#include "chunked_streambuf.h"
 #include "delimited_row_parser.h"
 
 #include <sstream>
@@ -128,6 +129,12 @@ TEST_F(DelimitedRowParserOptions, IgnoreOverfullRows) {
   EXPECT_FALSE(parser.ignore_overfull_row());
 }
 
+TEST_F(DelimitedRowParserOptions, ReuseRow) {
+  EXPECT_FALSE(parser.reuse_row());
+  parser.reuse_row(true);
+  EXPECT_TRUE(parser.reuse_row());
+}
+
 TEST_F(DelimitedRowParserOptions, FieldParsers) {
   // test default
   std::unordered_map<int, std::function<void(std::string*)>> test_parsers;
@@ -322,6 +329,708 @@ TEST_F(DelimitedRowParserParseRow, ExpectedFieldParsers) {
   compare_data();
 }
 
+TEST_F(DelimitedRowParserParseRow, RowsStraddlingBufferBoundaries) {
+  std::string data{"foo\tbar\tbaz\n"
+                   "one\t two \t three\n"
+                   "\n"
+                   "x\ty\tz"};
+  std::vector<std::vector<std::string>> expected_rows{
+      {"foo", "bar", "baz"}, {"one", " two ", " three"}, {""}, {"x", "y", "z"}};
+  for (std::size_t window : {0, 1, 2, 3, 5, 7, 64}) {
+    test::ChunkedStreambuf buf{data, window};
+    std::istream is{&buf};
+    std::vector<std::vector<std::string>> rows;
+    std::vector<std::string> row;
+    while (parser.parse_row(&is, &row)) {
+      rows.push_back(row);
+    }
+    rows.push_back(row);
+    EXPECT_EQ(expected_rows, rows) << "window size " << window;
+    EXPECT_TRUE(is.eof());
+  }
+}
+
+TEST_F(DelimitedRowParserParseRow, StreamPositionAfterRow) {
+  std::vector<std::string> row;
+  std::string line;
+  iss.str("foo\tbar\nnext line\nbaz\tbum\n");
+  ASSERT_TRUE(parser.parse_row(&iss, &row));
+  EXPECT_EQ((std::vector<std::string>{"foo", "bar"}), row);
+  ASSERT_TRUE(std::getline(iss, line));
+  EXPECT_EQ("next line", line);
+  ASSERT_TRUE(parser.parse_row(&iss, &row));
+  EXPECT_EQ((std::vector<std::string>{"baz", "bum"}), row);
+  EXPECT_FALSE(parser.parse_row(&iss, &row));
+  EXPECT_EQ((std::vector<std::string>{""}), row);
+}
+
+TEST_F(DelimitedRowParserParseRow, StreamPositionAfterUnexpectedFields) {
+  std::vector<std::string> row;
+  iss.str("a\tb\tc\td\ne\tf\n");
+  parser.max_fields(2);
+  EXPECT_THROW(parser.parse_row(&iss, &row),
+               stl_ios_utilities::DelimitedRowParser::UnexpectedFields);
+  EXPECT_EQ('c', iss.peek());
+}
+
+TEST_F(DelimitedRowParserParseRow, FieldViewsMatchStrings) {
+  std::string data{"foo\tbar\tbaz\n"
+                   "one\t two \t three\n"
+                   "\n"
+                   "x\ty\tz"};
+  parser.set_parser(2, [](std::string* s){s->append("_parsed");});
+  for (std::size_t window : {0, 2, 5, 64}) {
+    test::ChunkedStreambuf buf{data, window};
+    std::istream is{&buf};
+    std::istringstream reference{data};
+    std::vector<FieldView> view_row;
+    std::vector<std::string> string_row;
+    bool more{true};
+    while (more) {
+      more = static_cast<bool>(parser.parse_row(&reference, &string_row));
+      EXPECT_EQ(more, static_cast<bool>(parser.parse_row(&is, &view_row)));
+      ASSERT_EQ(string_row.size(), view_row.size());
+      for (std::size_t i = 0; i < view_row.size(); ++i) {
+        // field parsers are not applied to views
+        std::string expected{string_row[i]};
+        if (i == 1) {
+          expected.resize(expected.size() - std::string{"_parsed"}.size());
+        }
+        EXPECT_EQ(expected, view_row[i]) << "window size " << window;
+      }
+    }
+  }
+}
+
+TEST_F(DelimitedRowParserParseRow, FieldViewsReuseCapacity) {
+  iss.str("a\tb\tc\nd\te\nf\tg\th\ti\nj\tk\tl");
+  parser.min_fields(3);
+  parser.enforce_min_fields(false);
+  std::vector<FieldView> row;
+  row.reserve(4);
+  const FieldView* storage{row.data()};
+  ASSERT_TRUE(parser.parse_row(&iss, &row));
+  EXPECT_EQ((std::vector<FieldView>{{"a", 1}, {"b", 1}, {"c", 1}}), row);
+  // the underfull row is ignored and leaves the views unchanged
+  ASSERT_TRUE(parser.parse_row(&iss, &row));
+  EXPECT_EQ((std::vector<FieldView>{{"a", 1}, {"b", 1}, {"c", 1}}), row);
+  ASSERT_TRUE(parser.parse_row(&iss, &row));
+  EXPECT_EQ(4u, row.size());
+  EXPECT_FALSE(parser.parse_row(&iss, &row));
+  EXPECT_EQ((std::vector<FieldView>{{"j", 1}, {"k", 1}, {"l", 1}}), row);
+  EXPECT_EQ(storage, row.data());
+}
+
+TEST_F(DelimitedRowParserParseRow, ReuseRow) {
+  SetUp("foo\tbar\tbaz\n"
+        "one\t three\n"
+        "x\ty\tz", {
+          {"foo", "bar_parsed", "baz"},
+          {"foo", "bar_parsed", "baz"},
+          {"x", "y_parsed", "z"}
+        });
+  parser.min_fields(3);
+  parser.enforce_min_fields(false);
+  parser.set_parser(2, [](std::string* s){s->append("_parsed");});
+  parser.reuse_row(true);
+  read_data();
+  compare_data();
+}
+
+TEST_F(DelimitedRowParserParseRow, ReuseRowKeepsCapacity) {
+  std::string long_field(100, 'a');
+  for (int i = 0; i < 4; ++i) {
+    iss.str(iss.str() + long_field + "\t" + long_field + "\n");
+  }
+  parser.reuse_row(true);
+  std::vector<std::string> row;
+  ASSERT_TRUE(parser.parse_row(&iss, &row));
+  ASSERT_TRUE(parser.parse_row(&iss, &row));
+  // from now on, the strings of the first two rows alternate
+  const char* first{row[0].data()};
+  ASSERT_TRUE(parser.parse_row(&iss, &row));
+  ASSERT_TRUE(parser.parse_row(&iss, &row));
+  EXPECT_EQ(first, row[0].data());
+  EXPECT_EQ((std::vector<std::string>{long_field, long_field}), row);
+}
+
+TEST_F(DelimitedRowParserParseRow, ReuseRowUnmodifiedOnException) {
+  iss.str("a\tb\nc\td\n");
+  parser.reuse_row(true);
+  parser.set_parser(2, [](std::string* s){
+    if (*s == "d") {
+      throw std::runtime_error("parser failure");
+    }
+  });
+  std::vector<std::string> row;
+  ASSERT_TRUE(parser.parse_row(&iss, &row));
+  EXPECT_THROW(parser.parse_row(&iss, &row), std::runtime_error);
+  EXPECT_EQ((std::vector<std::string>{"a", "b"}), row);
+}
+
+TEST_F(DelimitedRowParserParseRow, FieldParsersReplacedAndOutOfRange) {
+  SetUp("a\tb\tc\n"
+        "d\te\tf", {
+          {"a", "b", "c-3"},
+          {"d", "e", "f-3"}
+        });
+  parser.set_parser(2, [](std::string* s){s->append("-2");});
+  parser.set_parser(0, [](std::string* s){s->append("-0");});
+  parser.set_parser(7, [](std::string* s){s->append("-7");});
+  parser.field_parsers({
+    {-1, [](std::string* s){s->append("--1");}},
+    {3, [](std::string* s){s->append("-3");}}
+  });
+  read_data();
+  compare_data();
+  EXPECT_THROW(parser.get_parser(2), std::out_of_range);
+}
+
+TEST_F(DelimitedRowParserParseRow, CopiedParserKeepsFieldParsers) {
+  SetUp("a\tb\na\tb", {{"a", "b_parsed"}, {"a", "b_parsed"}});
+  parser.set_parser(2, [](std::string* s){s->append("_parsed");});
+  DelimitedRowParser copy{parser};
+  parser.set_parser(2, [](std::string* s){s->append("_changed");});
+  parser = copy;
+  std::vector<std::string> row;
+  parser.parse_row(&iss, &row);
+  result.push_back(row);
+  parser.parse_row(&iss, &row);
+  result.push_back(row);
+  compare_data();
+}
+
+TEST_F(DelimitedRowParserParseRow, CallableColumnParser) {
+  SetUp("foo\tbar\tbaz\n"
+        "x\ty\tz", {
+          {"foo", "bar2", "baz3"},
+          {"x", "y2", "z3"}
+        });
+  // the callable takes the place of field parsers set on the parser
+  parser.set_parser(1, [](std::string* s){s->append("_unused");});
+  int calls{0};
+  auto append_column = [&calls](int column, std::string* field) {
+    ++calls;
+    if (column > 1) {
+      field->append(std::to_string(column));
+    }
+  };
+  std::vector<std::string> row;
+  while (parser.parse_row(&iss, &row, append_column)) {
+    result.push_back(row);
+  }
+  result.push_back(row);
+  compare_data();
+  EXPECT_EQ(6, calls);
+
+  std::string data{"1\t2\n"};
+  MemorySource source{data.data(), data.size()};
+  parser.parse_row(&source, &row, [](int column, std::string* field) {
+    field->insert(0, column, '+');
+  });
+  EXPECT_EQ((std::vector<std::string>{"+1", "++2"}), row);
+}
+
+TEST_F(DelimitedRowParserParseRow, CallableColumnParserUnmodifiedOnException) {
+  iss.str("a\tb\nc\td\n");
+  auto throw_on_d = [](int, std::string* field) {
+    if (*field == "d") {
+      throw std::runtime_error("parser failure");
+    }
+  };
+  std::vector<std::string> row;
+  ASSERT_TRUE(parser.parse_row(&iss, &row, throw_on_d));
+  EXPECT_THROW(parser.parse_row(&iss, &row, throw_on_d), std::runtime_error);
+  EXPECT_EQ((std::vector<std::string>{"a", "b"}), row);
+}
+
+std::vector<std::vector<std::string>> batch_rows(const RowBatch& batch) {
+  std::vector<std::vector<std::string>> rows;
+  for (std::size_t i = 0; i < batch.size(); ++i) {
+    rows.emplace_back(batch[i].begin(), batch[i].end());
+  }
+  return rows;
+}
+
+TEST_F(DelimitedRowParserParseRow, ParseRowsInBatches) {
+  std::string data{"foo\tbar\tbaz\n"
+                   "one\n"
+                   "\t\n"
+                   "x\ty\tz\tw\n"
+                   "last\tone\n"};
+  std::vector<std::vector<std::string>> expected_rows{
+      {"foo", "bar_parsed", "baz"}, {"", "_parsed"}, {"x", "y_parsed", "z"},
+      {"last", "one_parsed"}};
+  parser.min_fields(2);
+  parser.enforce_min_fields(false);
+  parser.max_fields(3);
+  parser.enforce_max_fields(false);
+  parser.ignore_overfull_row(false);
+  parser.set_parser(2, [](std::string* s){s->append("_parsed");});
+  RowBatch batch;
+  for (std::size_t max_rows : {1, 3, 100}) {
+    for (std::size_t window : {0, 2, 64}) {
+      test::ChunkedStreambuf buf{data, window};
+      std::istream is{&buf};
+      std::vector<std::vector<std::string>> rows;
+      while (parser.parse_rows(&is, &batch, max_rows) > 0) {
+        EXPECT_LE(batch.size(), max_rows);
+        std::vector<std::vector<std::string>> batch_result{batch_rows(batch)};
+        rows.insert(rows.end(), batch_result.begin(), batch_result.end());
+      }
+      EXPECT_EQ(expected_rows, rows) << max_rows << ' ' << window;
+      EXPECT_TRUE(is.eof());
+      EXPECT_TRUE(batch.empty());
+    }
+    MemorySource source{data.data(), data.size() - 1};
+    std::vector<std::vector<std::string>> rows;
+    while (parser.parse_rows(&source, &batch, max_rows) > 0) {
+      std::vector<std::vector<std::string>> batch_result{batch_rows(batch)};
+      rows.insert(rows.end(), batch_result.begin(), batch_result.end());
+    }
+    EXPECT_EQ(expected_rows, rows) << max_rows;
+    EXPECT_FALSE(source);
+  }
+}
+
+TEST_F(DelimitedRowParserParseRow,
+       ParseRowsReusesBatchAndKeepsRowsOnException) {
+  std::string long_field(100, 'a');
+  for (int i = 0; i < 4; ++i) {
+    iss.str(iss.str() + long_field + "\t" + long_field + "\n");
+  }
+  RowBatch batch;
+  ASSERT_EQ(2u, parser.parse_rows(&iss, &batch, 2));
+  const char* first{batch[0][0].data()};
+  ASSERT_EQ(2u, parser.parse_rows(&iss, &batch, 2));
+  EXPECT_EQ(first, batch[0][0].data());
+  EXPECT_EQ(4u, batch.field_count());
+  EXPECT_EQ(0u, parser.parse_rows(&iss, &batch, 2));
+
+  iss.clear();
+  iss.str("a\tb\nc\td\ne\tf\n");
+  parser.set_parser(2, [](std::string* s){
+    if (*s == "d") {
+      throw std::runtime_error("parser failure");
+    }
+  });
+  EXPECT_THROW(parser.parse_rows(&iss, &batch, 10), std::runtime_error);
+  EXPECT_EQ((std::vector<std::vector<std::string>>{{"a", "b"}}),
+            batch_rows(batch));
+  EXPECT_EQ(2u, batch.field_count());
+  ASSERT_EQ(1u, parser.parse_rows(&iss, &batch, 10));
+  EXPECT_EQ((std::vector<std::vector<std::string>>{{"e", "f"}}),
+            batch_rows(batch));
+}
+
+TEST_F(DelimitedRowParserParseRow, ParseRowsIntoColumns) {
+  iss.str("a\tb\n"
+          "c\n"
+          "d\te\tf\n");
+  parser.set_parser(1, [](std::string* s){s->append("_unused");});
+  ColumnBatch batch;
+  ASSERT_EQ(3u, parser.parse_rows(&iss, &batch, 10));
+  ASSERT_EQ(3u, batch.column_count());
+  EXPECT_EQ("acd", batch.chars(1));
+  EXPECT_EQ((std::vector<std::size_t>{0, 1, 2, 3}), batch.offsets(1));
+  EXPECT_EQ("be", batch.chars(2));
+  EXPECT_EQ((std::vector<std::size_t>{0, 1, 1, 2}), batch.offsets(2));
+  // the column first seen in the last row holds empty fields before it
+  EXPECT_EQ((std::vector<std::size_t>{0, 0, 0, 1}), batch.offsets(3));
+  EXPECT_EQ(FieldView("e", 1), batch.field(2, 2));
+  EXPECT_TRUE(batch.field(3, 0).empty());
+  EXPECT_EQ(ColumnBatch::ColumnType::kText, batch.column_type(3));
+  EXPECT_THROW(batch.chars(4), std::out_of_range);
+  EXPECT_THROW(batch.chars(0), std::out_of_range);
+  EXPECT_EQ(0u, parser.parse_rows(&iss, &batch, 10));
+  EXPECT_EQ(0u, batch.column_count());
+}
+
+TEST_F(DelimitedRowParserParseRow, ParseRowsIntoTypedColumns) {
+  std::string data{"x\t1\t0.5\n"
+                   "y\t-2\t1e3\n"
+                   "z\t3\t-0.25\n"
+                   "w\tq\t1\n"};
+  ColumnBatch batch;
+  batch.column_type(2, ColumnBatch::ColumnType::kInteger);
+  batch.column_type(3, ColumnBatch::ColumnType::kFloatingPoint);
+  MemorySource source{data.data(), data.size()};
+  ASSERT_EQ(2u, parser.parse_rows(&source, &batch, 2));
+  EXPECT_EQ("xy", batch.chars(1));
+  EXPECT_EQ((std::vector<std::int64_t>{1, -2}), batch.integers(2));
+  EXPECT_EQ((std::vector<double>{0.5, 1000.0}), batch.floating_points(3));
+  EXPECT_TRUE(batch.chars(2).empty());
+  EXPECT_TRUE(batch.integers(1).empty());
+
+  // the row whose field cannot be converted is left out of the batch
+  EXPECT_THROW(parser.parse_rows(&source, &batch, 2), InvalidField);
+  ASSERT_EQ(1u, batch.size());
+  EXPECT_EQ("z", batch.chars(1));
+  EXPECT_EQ((std::vector<std::size_t>{0, 1}), batch.offsets(1));
+  EXPECT_EQ((std::vector<std::int64_t>{3}), batch.integers(2));
+  EXPECT_EQ((std::vector<double>{-0.25}), batch.floating_points(3));
+  EXPECT_EQ(0u, parser.parse_rows(&source, &batch, 2));
+  EXPECT_EQ(3u, batch.column_count());
+
+  // a declared numeric column lacking a field cannot be converted
+  iss.str("v\t4\n");
+  EXPECT_THROW(parser.parse_rows(&iss, &batch, 2), InvalidField);
+  EXPECT_TRUE(batch.empty());
+}
+
+TEST_F(DelimitedRowParserParseRow, ArenaRows) {
+  std::string data{"foo\tbar\tbaz\n"
+                   "one\n"
+                   "a long field of more than fifteen characters\tb\n"
+                   "x\ty\tz"};
+  std::vector<std::vector<std::string>> expected_rows{
+      {"foo", "bar_parsed", "baz"},
+      {"a long field of more than fifteen characters", "b_parsed"},
+      {"x", "y_parsed", "z"}};
+  parser.min_fields(2);
+  parser.enforce_min_fields(false);
+  parser.set_parser(2, [](std::string* s){s->append("_parsed");});
+  Arena arena{64};
+  for (std::size_t window : {0, 3, 64}) {
+    test::ChunkedStreambuf buf{data, window};
+    std::istream is{&buf};
+    std::vector<std::vector<std::string>> rows;
+    ArenaRow row{ArenaRow::allocator_type{&arena}};
+    while (parser.parse_row(&is, &row)) {
+      if (!row.empty()) {
+        rows.emplace_back();
+        for (const ArenaString& field : row) {
+          EXPECT_EQ(&arena, field.get_allocator().arena());
+          rows.back().emplace_back(field.data(), field.size());
+        }
+      }
+      // a fresh row stays empty if the next row is ignored
+      row = ArenaRow{ArenaRow::allocator_type{&arena}};
+    }
+    rows.emplace_back();
+    for (const ArenaString& field : row) {
+      rows.back().emplace_back(field.data(), field.size());
+    }
+    EXPECT_EQ(expected_rows, rows) << "window size " << window;
+  }
+
+  std::string last{"x\td"};
+  MemorySource source{last.data(), last.size()};
+  parser.set_parser(2, [](std::string* s){
+    if (*s == "d") {
+      throw std::runtime_error("parser failure");
+    }
+  });
+  ArenaRow row{ArenaRow::allocator_type{&arena}};
+  row.emplace_back("kept");
+  EXPECT_THROW(parser.parse_row(&source, &row), std::runtime_error);
+  ASSERT_EQ(1u, row.size());
+  EXPECT_EQ("kept", std::string(row[0].data(), row[0].size()));
+}
+
+TEST_F(DelimitedRowParserParseRow, TryParseRowReportsStatus) {
+  iss.str("a\tb\n"
+          "c\n"
+          "d\te\tf\tg\n"
+          "h\ti\tj\n"
+          "k\tl\n");
+  parser.min_fields(2);
+  parser.max_fields(2);
+  std::vector<std::string> row;
+  ParseStatus status{parser.try_parse_row(&iss, &row)};
+  EXPECT_TRUE(status.ok());
+  EXPECT_EQ(2, status.field_count);
+  EXPECT_EQ((std::vector<std::string>{"a", "b"}), row);
+
+  status = parser.try_parse_row(&iss, &row);
+  EXPECT_EQ(ParseStatus::Code::kMissingFields, status.code);
+  EXPECT_EQ(1, status.field_count);
+  EXPECT_EQ(2, status.expected_fields);
+  EXPECT_EQ(1u, status.offset);
+  EXPECT_EQ((std::vector<std::string>{"a", "b"}), row);
+  try {
+    MemorySource source{"c\n", 2};
+    parser.parse_row(&source, &row);
+    FAIL();
+  } catch (const DelimitedRowParser::MissingFields& e) {
+    EXPECT_STREQ(status.message().c_str(), e.what());
+  }
+
+  // the stream is left where `parse_row` would leave it
+  status = parser.try_parse_row(&iss, &row);
+  EXPECT_EQ(ParseStatus::Code::kUnexpectedFields, status.code);
+  EXPECT_EQ(3, status.field_count);
+  EXPECT_EQ(2, status.expected_fields);
+  EXPECT_EQ(4u, status.offset);
+  EXPECT_EQ('f', iss.peek());
+  // the rest of the row forms a row of its own
+  EXPECT_TRUE(parser.try_parse_row(&iss, &row).ok());
+  EXPECT_EQ((std::vector<std::string>{"f", "g"}), row);
+
+  parser.enforce_max_fields(false);
+  std::vector<FieldView> views;
+  status = parser.try_parse_row(&iss, &views);
+  EXPECT_EQ(ParseStatus::Code::kIgnored, status.code);
+  EXPECT_EQ(3, status.field_count);
+  EXPECT_TRUE(views.empty());
+
+  std::string data{"x\ty\tz"};
+  MemorySource source{data.data(), data.size()};
+  parser.enforce_max_fields(true);
+  status = parser.try_parse_row(&source, &row);
+  EXPECT_EQ(ParseStatus::Code::kUnexpectedFields, status.code);
+  try {
+    MemorySource again{data.data(), data.size()};
+    parser.parse_row(&again, &row);
+    FAIL();
+  } catch (const DelimitedRowParser::UnexpectedFields& e) {
+    EXPECT_STREQ(status.message().c_str(), e.what());
+  }
+  EXPECT_EQ((std::vector<std::string>{"f", "g"}), row);
+}
+
+TEST_F(DelimitedRowParserParseRow, QuotedFieldsStraddlingBufferBoundaries) {
+  std::string data{"\"a\tb\"\tc\n"
+                   "\"x\"\"y\"\t\"multi\nline\"\n"
+                   "plain\t\"q\"tail\tmi\"d\n"
+                   "\"\"\t\"\"\"\"\n"
+                   "end\t\"last\""};
+  std::vector<std::vector<std::string>> expected_rows{
+      {"a\tb", "c"}, {"x\"y", "multi\nline"}, {"plain", "qtail", "mi\"d"},
+      {"", "\""}, {"end", "last"}};
+  parser.quote_fields(true);
+  for (std::size_t window : {0, 1, 2, 3, 5, 7, 64}) {
+    test::ChunkedStreambuf buf{data, window};
+    std::istream is{&buf};
+    std::vector<std::vector<std::string>> rows;
+    std::vector<std::string> row;
+    while (parser.parse_row(&is, &row)) {
+      rows.push_back(row);
+    }
+    rows.push_back(row);
+    EXPECT_EQ(expected_rows, rows) << "window size " << window;
+  }
+
+  MemorySource source{data.data(), data.size()};
+  std::vector<std::vector<std::string>> rows;
+  std::vector<FieldView> views;
+  while (source.begin() != source.end()) {
+    parser.parse_row(&source, &views);
+    rows.emplace_back();
+    for (const FieldView& view : views) {
+      rows.back().push_back(view.str());
+    }
+  }
+  EXPECT_EQ(expected_rows, rows);
+}
+
+TEST_F(DelimitedRowParserParseRow, QuotesAreLiteralUnlessEnabled) {
+  std::vector<std::string> row;
+  iss.str("\"a\tb\"\n");
+  parser.parse_row(&iss, &row);
+  EXPECT_EQ((std::vector<std::string>{"\"a", "b\""}), row);
+  parser.quote_fields(true);
+  parser.quote('\'');
+  iss.clear();
+  iss.str("'a\tb'\t\"c\"\n");
+  parser.parse_row(&iss, &row);
+  EXPECT_EQ((std::vector<std::string>{"a\tb", "\"c\""}), row);
+}
+
+TEST_F(DelimitedRowParserParseRow, QuotedFieldErrors) {
+  std::vector<std::string> row;
+  parser.quote_fields(true);
+  parser.max_fields(2);
+  iss.str("\"a\tb\"\tc\td\n\"open\tfield\n");
+  EXPECT_THROW(parser.parse_row(&iss, &row),
+               DelimitedRowParser::UnexpectedFields);
+  EXPECT_EQ('d', iss.peek());
+  parser.parse_row(&iss, &row);
+  EXPECT_EQ((std::vector<std::string>{"d"}), row);
+  ParseStatus status{parser.try_parse_row(&iss, &row)};
+  EXPECT_EQ(ParseStatus::Code::kUnterminatedQuote, status.code);
+  EXPECT_EQ(1, status.field_count);
+  EXPECT_EQ(12u, status.offset);
+  EXPECT_EQ((std::vector<std::string>{"d"}), row);
+  MemorySource source{"x\t\"y", 4};
+  EXPECT_THROW(parser.parse_row(&source, &row),
+               DelimitedRowParser::UnterminatedQuote);
+}
+
+TEST_F(DelimitedRowParserParseRow, SelectedColumns) {
+  std::string data{"id\tname\tscore\tnote\n"
+                   "1\tann\t7\tx\n"
+                   "2\tbob\n"};
+  std::vector<std::string> row;
+  iss.str(data);
+  parser.parse_row(&iss, &row);
+  ASSERT_EQ(4u, row.size());
+  parser.select_columns({"score", "id"}, row);
+  EXPECT_EQ((std::vector<int>{3, 1}), parser.selected_columns());
+  std::vector<int> parsed_columns;
+  parser.set_parser(1, [&parsed_columns](std::string* s) {
+    parsed_columns.push_back(1);
+    s->append("!");
+  });
+  parser.set_parser(3, [&parsed_columns](std::string* s) {
+    parsed_columns.push_back(3);
+    s->append("!");
+  });
+  // the stored plan follows the order of the selected columns
+  std::vector<std::function<void(std::string*)>> plan{
+      parser.stored_column_plan()};
+  ASSERT_EQ(2u, plan.size());
+  EXPECT_TRUE(plan[0] && plan[1]);
+  parser.select_columns({2, 3, 5});
+  plan = parser.stored_column_plan();
+  ASSERT_EQ(3u, plan.size());
+  EXPECT_TRUE(!plan[0] && plan[1] && !plan[2]);
+  parser.select_columns({3, 1});
+  parser.parse_row(&iss, &row);
+  EXPECT_EQ((std::vector<std::string>{"7!", "1!"}), row);
+  // unselected columns are not parsed, and missing ones are empty
+  EXPECT_EQ((std::vector<int>{3, 1}), parsed_columns);
+  parser.parse_row(&iss, &row);
+  EXPECT_EQ((std::vector<std::string>{"!", "2!"}), row);
+
+  // every way of storing rows stores the same columns
+  parser.field_parsers({});
+  parser.select_columns({2, 2, 4});
+  std::vector<std::string> expected_row{"ann", "ann", "x"};
+  MemorySource source{data.data(), data.size()};
+  parser.parse_row(&source, &row);
+  std::vector<FieldView> views;
+  parser.parse_row(&source, &views);
+  ASSERT_EQ(3u, views.size());
+  EXPECT_EQ("ann", views[0]);
+  EXPECT_EQ("ann", views[1]);
+  EXPECT_EQ("x", views[2]);
+  source = MemorySource{data.data(), data.size()};
+  parser.parse_row(&source, &row);
+  Arena arena;
+  ArenaRow arena_row{ArenaRow::allocator_type{&arena}};
+  parser.parse_row(&source, &arena_row);
+  ASSERT_EQ(3u, arena_row.size());
+  EXPECT_EQ("x", std::string(arena_row[2].data(), arena_row[2].size()));
+  RowBatch batch;
+  source = MemorySource{data.data(), data.size()};
+  ASSERT_EQ(3u, parser.parse_rows(&source, &batch, 10));
+  EXPECT_EQ(expected_row, std::vector<std::string>(batch[1].begin(),
+                                                   batch[1].end()));
+  EXPECT_EQ(3u, batch[2].size());
+  ColumnBatch columns;
+  source = MemorySource{data.data(), data.size()};
+  ASSERT_EQ(3u, parser.parse_rows(&source, &columns, 10));
+  ASSERT_EQ(3u, columns.column_count());
+  EXPECT_EQ("nameannbob", columns.chars(2));
+  EXPECT_EQ("notex", columns.chars(3));
+
+  parser.select_columns(std::vector<int>{});
+  source = MemorySource{data.data(), data.size()};
+  parser.parse_row(&source, &row);
+  EXPECT_EQ(4u, row.size());
+  EXPECT_THROW(parser.select_columns({1, 0}), InvalidArgument);
+  EXPECT_THROW(parser.select_columns({"id", "other"}, row), InvalidArgument);
+  EXPECT_TRUE(parser.selected_columns().empty());
+}
+
+TEST_F(DelimitedRowParserParseRow, PredicatesRejectRowsEarly) {
+  std::string data{"keep\t1\ta\tb\n"
+                   "drop\t2\tc\n"
+                   "keep\t3\n"
+                   "keep\n"
+                   "keep\tlong field straddling windows\td\n"
+                   "drop\tlong field straddling windows\te\tf"};
+  std::vector<std::vector<std::string>> expected_rows{
+      {"keep", "1_parsed", "a", "b"},
+      {"keep", "3_parsed"},
+      {"keep", "long field straddling windows_parsed", "d"}};
+  std::vector<std::string> tested;
+  parser.set_parser(2, [](std::string* s){s->append("_parsed");});
+  parser.set_predicate(1, [](const FieldView& field) {
+    return field == "keep";
+  });
+  parser.set_predicate(2, [&tested](const FieldView& field) {
+    tested.push_back(field.str());
+    return !field.empty();
+  });
+  for (std::size_t window : {0, 1, 2, 3, 5, 7, 64}) {
+    test::ChunkedStreambuf buf{data, window};
+    std::istream is{&buf};
+    RowBatch batch;
+    tested.clear();
+    parser.parse_rows(&is, &batch, 100);
+    std::vector<std::vector<std::string>> rows;
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+      rows.emplace_back(batch[i].begin(), batch[i].end());
+    }
+    EXPECT_EQ(expected_rows, rows) << "window size " << window;
+    // the second column of rows failing the first predicate is not tested,
+    // and a missing one is tested as empty
+    EXPECT_EQ((std::vector<std::string>{
+                  "1", "3", "", "long field straddling windows"}), tested)
+        << "window size " << window;
+  }
+
+  // rows failing a predicate are ignored and leave the row unchanged, while
+  // passing rows are still checked for too many fields
+  parser.max_fields(3);
+  MemorySource source{data.data(), data.size()};
+  std::vector<std::string> row{"unchanged"};
+  EXPECT_THROW(parser.parse_row(&source, &row),
+               DelimitedRowParser::UnexpectedFields);
+  parser.parse_row(&source, &row);
+  ParseStatus status{parser.try_parse_row(&source, &row)};
+  EXPECT_EQ(ParseStatus::Code::kIgnored, status.code);
+  EXPECT_EQ((std::vector<std::string>{"unchanged"}), row);
+  EXPECT_TRUE(parser.try_parse_row(&source, &row).ok());
+  EXPECT_EQ((std::vector<std::string>{"keep", "3_parsed"}), row);
+
+  // with quoting, predicates see the unquoted fields of tokenized rows
+  parser.max_fields(0);
+  parser.quote_fields(true);
+  parser.set_predicate(2, nullptr);
+  EXPECT_EQ(1u, parser.field_predicates().size());
+  iss.str("\"keep\"\tx\n\"drop\"\ty\nkeep\tz\n");
+  RowBatch batch;
+  ASSERT_EQ(2u, parser.parse_rows(&iss, &batch, 10));
+  EXPECT_EQ("x_parsed", batch[0][1]);
+  EXPECT_EQ("z_parsed", batch[1][1]);
+}
+
+TEST(DelimitedRowParserPredicates, BoundsAreCheckedInEveryScanPath) {
+  // the same rows fail a predicate tested early on unquoted rows, after
+  // scanning up to the maximum number of fields, and on quoted rows
+  auto reject = [](const FieldView& field) {return field != "drop";};
+  std::vector<DelimitedRowParser> parsers(3);
+  parsers[0].set_predicate(1, reject);
+  parsers[1].set_predicate(3, reject);
+  parsers[2].set_predicate(1, reject);
+  parsers[2].quote_fields(true);
+  std::string data{"drop\tx\tdrop\tz\n"
+                   "drop\tx\tdrop\n"
+                   "drop\n"};
+  for (std::size_t i = 0; i < parsers.size(); ++i) {
+    parsers[i].max_fields(3);
+    parsers[i].min_fields(2);
+    MemorySource source{data.data(), data.size()};
+    std::vector<std::string> row{"unchanged"};
+    ParseStatus status{parsers[i].try_parse_row(&source, &row)};
+    EXPECT_EQ(ParseStatus::Code::kUnexpectedFields, status.code)
+        << "parser " << i;
+    EXPECT_EQ(4, status.field_count) << "parser " << i;
+    source = MemorySource{data.data() + 14, data.size() - 14};
+    EXPECT_EQ(ParseStatus::Code::kIgnored,
+              parsers[i].try_parse_row(&source, &row).code)
+        << "parser " << i;
+    EXPECT_EQ(ParseStatus::Code::kMissingFields,
+              parsers[i].try_parse_row(&source, &row).code)
+        << "parser " << i;
+    EXPECT_EQ(source.end(), source.begin()) << "parser " << i;
+    EXPECT_EQ((std::vector<std::string>{"unchanged"}), row) << "parser " << i;
+  }
+}
+
 } // namespace
 
 } // namespace stl_ios_utilities
\ No newline at end of file
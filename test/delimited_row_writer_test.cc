@@ -0,0 +1,351 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "gtest/gtest.h"
+
+#include "delimited_row_parser.h"
+#include "delimited_row_writer.h"
+#include "field_converter.h"
+#include "field_formatter.h"
+#include "mapped_file.h"
+
+#include <clocale>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+namespace {
+
+using Rows = std::vector<std::vector<std::string>>;
+
+template <typename T>
+std::string format(const T& value) {
+  std::string out;
+  FieldFormatter<T>::append(value, &out);
+  return out;
+}
+
+Rows parse_all(const DelimitedRowParser& parser, const std::string& data) {
+  DelimitedRowParser copy{parser};
+  MemorySource source{data.data(), data.size()};
+  Rows rows;
+  std::vector<std::string> row;
+  while (source.begin() != source.end()) {
+    row.clear();
+    copy.parse_row(&source, &row);
+    rows.push_back(row);
+  }
+  return rows;
+}
+
+enum class Color : std::int16_t {kRed = -3, kBlue = 12};
+
+TEST(FieldFormatterTest, Integers) {
+  EXPECT_EQ("0", format(0));
+  EXPECT_EQ("7", format(7u));
+  EXPECT_EQ("-42", format(-42));
+  EXPECT_EQ("1234567890", format(1234567890L));
+  EXPECT_EQ("-9223372036854775808",
+            format(std::numeric_limits<std::int64_t>::min()));
+  EXPECT_EQ("18446744073709551615",
+            format(std::numeric_limits<std::uint64_t>::max()));
+  EXPECT_EQ("-128", format(std::numeric_limits<signed char>::min()));
+  EXPECT_EQ("x", format('x'));
+  EXPECT_EQ("1", format(true));
+  EXPECT_EQ("0", format(false));
+  EXPECT_EQ("-3", format(Color::kRed));
+  EXPECT_EQ("12", format(Color::kBlue));
+}
+
+TEST(FieldFormatterTest, FixedPoint) {
+  EXPECT_EQ("12.50", format(FixedPoint<2>{1250}));
+  EXPECT_EQ("-0.05", format(FixedPoint<2>{-5}));
+  EXPECT_EQ("0.000", format(FixedPoint<3>{0}));
+  EXPECT_EQ("17", format(FixedPoint<0>{17}));
+  EXPECT_EQ("-9.223372036854775808",
+            format(FixedPoint<18>{std::numeric_limits<std::int64_t>::min()}));
+}
+
+TEST(FieldFormatterTest, FloatingPointRoundTrips) {
+  EXPECT_EQ("0.1", format(0.1));
+  EXPECT_EQ("-2.5", format(-2.5));
+  EXPECT_EQ("1e+100", format(1e100));
+  EXPECT_EQ("0.30000000000000004", format(0.1 + 0.2));
+  EXPECT_EQ("100000", format(1e5));
+  EXPECT_EQ("0.00015", format(1.5e-4));
+  EXPECT_EQ("1.5e-05", format(1.5e-5));
+  EXPECT_EQ("-0", format(-0.0));
+  EXPECT_EQ("0.1", format(0.1f));
+  EXPECT_EQ("0.1", format(0.1L));
+  EXPECT_EQ("inf", format(std::numeric_limits<double>::infinity()));
+  EXPECT_EQ("-inf", format(-std::numeric_limits<double>::infinity()));
+  EXPECT_EQ("nan", format(std::numeric_limits<double>::quiet_NaN()));
+  std::mt19937_64 generator{5};
+  for (int i = 0; i < 10000; ++i) {
+    std::uint64_t bits{generator()};
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    if (std::isnan(value)) {
+      continue;
+    }
+    std::string field{format(value)};
+    double parsed;
+    FieldConverter<double>::convert(FieldView{field.data(), field.size()},
+                                    &parsed);
+    ASSERT_EQ(value, parsed) << field;
+  }
+  for (double value : {std::numeric_limits<double>::min(),
+                       std::numeric_limits<double>::denorm_min(),
+                       std::numeric_limits<double>::max()}) {
+    std::string field{format(value)};
+    double parsed;
+    FieldConverter<double>::convert(FieldView{field.data(), field.size()},
+                                    &parsed);
+    EXPECT_EQ(value, parsed) << field;
+  }
+}
+
+// significant digits of a formatted number
+int significant_digits(const std::string& field) {
+  std::string digits;
+  for (char c : field.substr(0, field.find('e'))) {
+    if (c >= '0' && c <= '9') {
+      digits.push_back(c);
+    }
+  }
+  std::size_t first{digits.find_first_not_of('0')};
+  std::size_t last{digits.find_last_not_of('0')};
+  return first == std::string::npos ? 1 : static_cast<int>(last - first + 1);
+}
+
+// significant digits of the shortest of the correctly rounded
+// representations which reads back as `value`
+int shortest_digits(double value) {
+  for (int precision = 1; precision < 17; ++precision) {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%.*e", precision - 1, value);
+    if (std::strtod(buffer, nullptr) == value) {
+      return significant_digits(buffer);
+    }
+  }
+  return 17;
+}
+
+TEST(FieldFormatterTest, FloatingPointIsShortest) {
+  // rounding the 17 digits 63916763893472545 to 16 digits would round up
+  EXPECT_EQ("6.391676389347254e-109", format(6.3916763893472545e-109));
+  std::mt19937_64 generator{9};
+  for (int i = 0; i < 20000; ++i) {
+    std::uint64_t bits{generator()};
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    if (!std::isfinite(value)) {
+      continue;
+    }
+    std::string field{format(value)};
+    ASSERT_EQ(shortest_digits(value), significant_digits(field)) << field;
+  }
+}
+
+TEST(FieldFormatterTest, IgnoresLocale) {
+  // skipped where no locale with a decimal comma is installed
+  const char* previous{std::setlocale(LC_NUMERIC, nullptr)};
+  std::string saved{previous == nullptr ? "C" : previous};
+  if (std::setlocale(LC_NUMERIC, "de_DE.UTF-8") == nullptr
+      && std::setlocale(LC_NUMERIC, "de_DE") == nullptr) {
+    return;
+  }
+  std::string field{format(1.25)};
+  std::setlocale(LC_NUMERIC, saved.c_str());
+  EXPECT_EQ("1.25", field);
+}
+
+TEST(DelimitedRowWriterTest, WritesRowsToStream) {
+  std::ostringstream oss;
+  DelimitedRowWriter writer{&oss};
+  writer.write_row(std::vector<std::string>{"name", "count", "price"});
+  writer.write_row(std::make_tuple(std::string{"apples"}, 12, 0.25));
+  writer.write_field("pears");
+  writer.write_field(-7L);
+  writer.write_field(FixedPoint<2>{50});
+  writer.end_row();
+  std::string text{"plums"};
+  writer.write_row(std::vector<FieldView>{FieldView{text.data(), 4}});
+  writer.end_row();
+  EXPECT_EQ("", oss.str());
+  writer.flush();
+  EXPECT_EQ("name\tcount\tprice\napples\t12\t0.25\npears\t-7\t0.50\nplum\n\n",
+            oss.str());
+  std::size_t written{oss.str().size()};
+  writer.delimiter(',');
+  writer.write_row(std::make_tuple('a', true, Color::kBlue));
+  writer.close();
+  EXPECT_EQ("a,1,12\n", oss.str().substr(written));
+}
+
+TEST(DelimitedRowWriterTest, SmallBufferWritesEachRow) {
+  std::ostringstream oss;
+  DelimitedRowWriter writer{&oss};
+  writer.buffer_size(1);
+  writer.write_row(std::vector<std::string>{"a", "b"});
+  EXPECT_EQ("a\tb\n", oss.str());
+  writer.write_field("c");
+  EXPECT_EQ("a\tb\n", oss.str());
+  writer.end_row();
+  EXPECT_EQ("a\tb\nc\n", oss.str());
+}
+
+TEST(DelimitedRowWriterTest, QuotedFieldsRoundTrip) {
+  Rows rows{{"plain", "with\ttab", "with \"quotes\""},
+            {"line\nbreak", "", "carriage\rreturn"},
+            {"\"", "\t", "end"}};
+  std::ostringstream oss;
+  {
+    DelimitedRowWriter writer{&oss};
+    writer.quote_fields(true);
+    for (const std::vector<std::string>& row : rows) {
+      writer.write_row(row);
+    }
+  }
+  EXPECT_EQ(0u, oss.str().find("plain\t\"with\ttab\"\t\"with \"\"quotes\"\"\""
+                               "\n"));
+  DelimitedRowParser parser;
+  parser.quote_fields(true);
+  EXPECT_EQ(rows, parse_all(parser, oss.str()));
+
+  std::ostringstream characters;
+  {
+    DelimitedRowWriter writer{&characters};
+    writer.quote_fields(true);
+    writer.write_row(std::make_tuple('\t', '"', '\n', 'a'));
+  }
+  EXPECT_EQ("\"\t\"\t\"\"\"\"\t\"\n\"\ta\n", characters.str());
+  EXPECT_EQ((Rows{{"\t", "\"", "\n", "a"}}),
+            parse_all(parser, characters.str()));
+
+  std::ostringstream unquoted;
+  {
+    DelimitedRowWriter writer{&unquoted};
+    writer.write_row(std::vector<std::string>{"a\"b", "c"});
+  }
+  EXPECT_EQ("a\"b\tc\n", unquoted.str());
+}
+
+TEST(DelimitedRowWriterTest, FileDescriptor) {
+  std::string path{::testing::TempDir() + "delimited_row_writer_test_fd.tsv"};
+  int fd{::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)};
+  ASSERT_GE(fd, 0);
+  {
+    DelimitedRowWriter writer{fd};
+    writer.buffer_size(16);
+    for (int i = 0; i < 100; ++i) {
+      writer.write_row(std::make_tuple(i, i * 0.5));
+    }
+  }
+  // the descriptor stays open
+  EXPECT_EQ(1, ::write(fd, "x", 1));
+  ::close(fd);
+  MappedFile file{path};
+  std::string data{file.data(), file.size()};
+  ASSERT_EQ('x', data.back());
+  data.pop_back();
+  Rows rows{parse_all(DelimitedRowParser{}, data)};
+  ASSERT_EQ(100u, rows.size());
+  EXPECT_EQ((std::vector<std::string>{"99", "49.5"}), rows.back());
+  std::remove(path.c_str());
+}
+
+TEST(DelimitedRowWriterTest, MappedFileAcrossWindows) {
+  std::string path{::testing::TempDir() + "delimited_row_writer_test.tsv"};
+  std::string expected;
+  {
+    DelimitedRowWriter writer{path};
+    // more than the 16 MiB mapped at a time
+    std::string field(1000, 'a');
+    for (int i = 0; i < 17 * 1024; ++i) {
+      writer.write_row(std::make_tuple(i, field));
+      expected.append(std::to_string(i) + '\t' + field + '\n');
+    }
+    writer.close();
+    writer.close();
+  }
+  MappedFile file{path};
+  ASSERT_EQ(expected.size(), file.size());
+  EXPECT_TRUE(expected == std::string(file.data(), file.size()));
+  {
+    DelimitedRowWriter writer{path};
+  }
+  EXPECT_EQ(0u, MappedFile{path}.size());
+  std::remove(path.c_str());
+  EXPECT_THROW(DelimitedRowWriter{::testing::TempDir() + "missing/x.tsv"},
+               FileError);
+}
+
+TEST(DelimitedRowWriterTest, MoveAssignmentClosesDestination) {
+  std::ostringstream first;
+  std::ostringstream second;
+  DelimitedRowWriter writer{&first};
+  writer.write_row(std::vector<std::string>{"a"});
+  DelimitedRowWriter other{&second};
+  other.write_row(std::vector<std::string>{"b"});
+  writer = std::move(other);
+  EXPECT_EQ("a\n", first.str());
+  writer.write_row(std::vector<std::string>{"c"});
+  writer.close();
+  EXPECT_EQ("b\nc\n", second.str());
+}
+
+TEST(DelimitedRowWriterTest, FailuresAndClosedWritersThrow) {
+  std::ostringstream failed;
+  failed.setstate(std::ios_base::badbit);
+  DelimitedRowWriter writer{&failed};
+  writer.write_row(std::vector<std::string>{"a"});
+  EXPECT_THROW(writer.flush(), FileError);
+  EXPECT_THROW(writer.close(), FileError);
+
+  std::ostringstream oss;
+  DelimitedRowWriter closed{&oss};
+  closed.close();
+  EXPECT_THROW(closed.write_field("a"), std::logic_error);
+  EXPECT_THROW(closed.end_row(), std::logic_error);
+  EXPECT_THROW(closed.write_row(std::make_tuple(1)), std::logic_error);
+  DelimitedRowWriter moved_to{std::move(writer)};
+  EXPECT_THROW(writer.write_row(std::vector<std::string>{"b"}),
+               std::logic_error);
+  EXPECT_EQ("", oss.str());
+}
+
+} // namespace
+
+} // namespace stl_ios_utilities
@@ -0,0 +1,221 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "gtest/gtest.h"
+
+#include "delimited_row_parser.h"
+#include "exceptions.h"
+#include "field_converter.h"
+#include "field_parser.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+namespace {
+
+template <typename T>
+T convert(const std::string& field) {
+  T value;
+  FieldConverter<T>::convert(FieldView{field.data(), field.size()}, &value);
+  return value;
+}
+
+// compares bit patterns, so that signed zeros are distinguished
+template <typename T>
+bool same_bits(T lhs, T rhs) {
+  return std::memcmp(&lhs, &rhs, sizeof(T)) == 0;
+}
+
+TEST(NumericParsingTest, EightDigits) {
+  std::uint32_t value{0};
+  EXPECT_TRUE(internal::parse_eight_digits("01234567", &value));
+  EXPECT_EQ(1234567u, value);
+  EXPECT_TRUE(internal::parse_eight_digits("99999999", &value));
+  EXPECT_EQ(99999999u, value);
+  EXPECT_FALSE(internal::parse_eight_digits("1234567.", &value));
+  EXPECT_FALSE(internal::parse_eight_digits("/2345678", &value));
+  EXPECT_FALSE(internal::parse_eight_digits("123:5678", &value));
+  EXPECT_FALSE(internal::parse_eight_digits("1234\xff" "678", &value));
+}
+
+TEST(FieldConverterTest, LongIntegers) {
+  EXPECT_EQ(1234567890123456789LL,
+            convert<std::int64_t>("1234567890123456789"));
+  EXPECT_EQ(7, convert<int>("00000000000000000000000007"));
+  EXPECT_EQ(0, convert<int>("-0"));
+  EXPECT_EQ(std::numeric_limits<std::int32_t>::min(),
+            convert<std::int32_t>("-2147483648"));
+  EXPECT_THROW(convert<std::int32_t>("2147483648"), InvalidField);
+  EXPECT_THROW(convert<std::int64_t>("9223372036854775808"), InvalidField);
+  EXPECT_THROW(convert<std::uint64_t>("99999999999999999999"), InvalidField);
+  EXPECT_THROW(convert<std::uint64_t>("184467440737095516150"), InvalidField);
+  EXPECT_THROW(convert<int>("1234567x"), InvalidField);
+  EXPECT_THROW(convert<int>("12345678x"), InvalidField);
+  EXPECT_THROW(convert<int>("+-1"), InvalidField);
+}
+
+TEST(FieldConverterTest, FixedPoint) {
+  EXPECT_EQ(12345, convert<FixedPoint<2>>("123.45").units);
+  EXPECT_EQ(12340, convert<FixedPoint<2>>("123.4").units);
+  EXPECT_EQ(12300, convert<FixedPoint<2>>("123").units);
+  EXPECT_EQ(12300, convert<FixedPoint<2>>("123.").units);
+  EXPECT_EQ(-50, convert<FixedPoint<2>>("-.5").units);
+  EXPECT_EQ(12345, convert<FixedPoint<2>>("123.4500").units);
+  EXPECT_EQ(7, convert<FixedPoint<0>>("7.0").units);
+  EXPECT_DOUBLE_EQ(-1.25, convert<FixedPoint<3>>("-1.25").to_double());
+  EXPECT_EQ(std::numeric_limits<std::int64_t>::min(),
+            convert<FixedPoint<4>>("-922337203685477.5808").units);
+  EXPECT_THROW(convert<FixedPoint<4>>("922337203685477.5808"), InvalidField);
+  EXPECT_THROW(convert<FixedPoint<2>>("123.456"), InvalidField);
+  EXPECT_THROW(convert<FixedPoint<2>>("."), InvalidField);
+  EXPECT_THROW(convert<FixedPoint<2>>(""), InvalidField);
+  EXPECT_THROW(convert<FixedPoint<2>>("1e2"), InvalidField);
+  EXPECT_THROW(convert<FixedPoint<2>>("12345678901234567890"), InvalidField);
+}
+
+TEST(FieldConverterTest, FloatingPointFormats) {
+  EXPECT_TRUE(same_bits(0.5, convert<double>(".5")));
+  EXPECT_TRUE(same_bits(5.0, convert<double>("5.")));
+  EXPECT_TRUE(same_bits(-0.0, convert<double>("-0.000")));
+  EXPECT_TRUE(same_bits(1e-5, convert<double>("0.00001")));
+  EXPECT_TRUE(same_bits(1.5e300, convert<double>("+1.5E+300")));
+  EXPECT_TRUE(same_bits(1e23, convert<double>("1e23")));
+  EXPECT_TRUE(same_bits(0.1f, convert<float>("0.1")));
+  EXPECT_TRUE(std::isinf(convert<double>("-Infinity")));
+  EXPECT_TRUE(std::isinf(convert<float>("inf")));
+  EXPECT_TRUE(std::isnan(convert<double>("NaN")));
+  EXPECT_EQ(0.0, convert<double>("1e-99999999999"));
+  EXPECT_THROW(convert<double>("1e99999999999"), InvalidField);
+  EXPECT_THROW(convert<float>("3.5e38"), InvalidField);
+  EXPECT_THROW(convert<double>("."), InvalidField);
+  EXPECT_THROW(convert<double>("e5"), InvalidField);
+  EXPECT_THROW(convert<double>("1e"), InvalidField);
+  EXPECT_THROW(convert<double>("1e+"), InvalidField);
+  EXPECT_THROW(convert<double>("0x10"), InvalidField);
+  EXPECT_THROW(convert<double>(" 1"), InvalidField);
+  EXPECT_THROW(convert<double>("1.2.3"), InvalidField);
+  EXPECT_THROW(convert<double>("infinite"), InvalidField);
+}
+
+TEST(FieldConverterTest, FloatingPointCorrectlyRounded) {
+  // halfway cases and long mantissas which a naive conversion gets wrong
+  const std::vector<std::string> numbers{
+      "9007199254740993", "9007199254740992.5", "2.2250738585072011e-308",
+      "2.2250738585072012e-308", "4.9406564584124654e-324",
+      "1.7976931348623157e308", "0.1000000000000000055511151231257827",
+      "123456789012345678901234567890", "7.038531e-26",
+      "1.00000005960464477550", "3.4028235677973366e38"};
+  for (const std::string& number : numbers) {
+    EXPECT_TRUE(same_bits(std::strtod(number.c_str(), nullptr),
+                          convert<double>(number))) << number;
+    float expected{std::strtof(number.c_str(), nullptr)};
+    if (std::isinf(expected)) {
+      EXPECT_THROW(convert<float>(number), InvalidField) << number;
+    } else {
+      EXPECT_TRUE(same_bits(expected, convert<float>(number))) << number;
+    }
+  }
+
+  std::mt19937_64 generator{42};
+  std::uniform_int_distribution<int> digits{1, 20};
+  std::uniform_int_distribution<int> exponent{-330, 310};
+  std::uniform_int_distribution<int> digit{0, 9};
+  for (int i = 0; i < 100000; ++i) {
+    std::string number;
+    for (int j = digits(generator); j > 0; --j) {
+      number.push_back(static_cast<char>('0' + digit(generator)));
+    }
+    number.insert(digit(generator) % number.size(), ".");
+    number += "e" + std::to_string(exponent(generator) / (1 + i % 10));
+    double expected{std::strtod(number.c_str(), nullptr)};
+    if (std::isinf(expected)) {
+      EXPECT_THROW(convert<double>(number), InvalidField) << number;
+    } else {
+      EXPECT_TRUE(same_bits(expected, convert<double>(number))) << number;
+    }
+    float expected_float{std::strtof(number.c_str(), nullptr)};
+    if (std::isinf(expected_float)) {
+      EXPECT_THROW(convert<float>(number), InvalidField) << number;
+    } else {
+      EXPECT_TRUE(same_bits(expected_float, convert<float>(number)))
+          << number;
+    }
+  }
+}
+
+TEST(FieldConverterTest, FieldParsersIntoTypedOutputs) {
+  std::istringstream iss{"a\t12\t1.5\t9.99\n"
+                         "b\t-3\t2e3\t0.01\n"};
+  DelimitedRowParser parser;
+  std::int64_t count{0};
+  std::vector<double> values;
+  std::vector<FixedPoint<2>> prices;
+  parser.set_parser(2, convert_into(&count));
+  parser.set_parser(3, append_into(&values));
+  parser.set_parser(4, append_into(&prices));
+  std::vector<std::string> row;
+  parser.parse_row(&iss, &row);
+  EXPECT_EQ(12, count);
+  EXPECT_EQ((std::vector<std::string>{"a", "12", "1.5", "9.99"}), row);
+  parser.parse_row(&iss, &row);
+  EXPECT_EQ(-3, count);
+  EXPECT_EQ((std::vector<double>{1.5, 2000.0}), values);
+  EXPECT_EQ((std::vector<FixedPoint<2>>{{999}, {1}}), prices);
+
+  std::istringstream invalid{"c\tx\t1\t1\n"};
+  EXPECT_THROW(parser.parse_row(&invalid, &row), InvalidField);
+  EXPECT_EQ(-3, count);
+
+  // values of earlier columns are kept when a later column fails
+  std::istringstream failing{"d\t5\t4.5\tx\n"
+                             "e\t6\t5.5\t1\n"};
+  EXPECT_THROW(parser.parse_row(&failing, &row), InvalidField);
+  EXPECT_EQ((std::vector<double>{1.5, 2000.0, 4.5}), values);
+  EXPECT_EQ(2u, prices.size());
+  values.resize(prices.size());
+  parser.parse_row(&failing, &row);
+  EXPECT_EQ((std::vector<double>{1.5, 2000.0, 5.5}), values);
+  EXPECT_EQ((std::vector<FixedPoint<2>>{{999}, {1}, {100}}), prices);
+
+  std::istringstream fields{"7,0.25"};
+  FieldParser field_parser;
+  field_parser.delimiters({','});
+  int number{0};
+  float fraction{0.0f};
+  field_parser.add_parser(1, convert_into(&number));
+  field_parser.add_parser(2, convert_into(&fraction));
+  std::vector<std::string> read;
+  field_parser.parse_fields(&fields, &read, 2);
+  EXPECT_EQ(7, number);
+  EXPECT_EQ(0.25f, fraction);
+}
+
+} // namespace
+
+} // namespace stl_ios_utilities
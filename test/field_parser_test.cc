@@ -20,11 +20,13 @@
 
 #include "gtest/gtest.h"
 
+#include "chunked_streambuf.h"
 #include "field_parser_test.h"
 
 #include "field_parser.h"
 
 #include <sstream>
+#include <thread>
 
 namespace stl_ios_utilities {
 
@@ -143,6 +145,259 @@ TEST_P(FieldParserParserFieldsTest, FieldParsers) {
       static_cast<int>(TestPattern::kFieldParsers)).fields);
 }
 
+TEST(FieldParserCharClassTest, OptionsAfterModification) {
+  FieldParser parser;
+  std::istringstream iss{"a,b;c\td|e"};
+  std::vector<std::string> fields;
+  parser.delimiters({','});
+  parser.delimiters({',', ';'});
+  parser.terminators({'|'});
+  parser.masked({'\t'});
+  parser.parse_fields(&iss, &fields, 3);
+  EXPECT_EQ((std::vector<std::string>{"a", "b", "cd"}), fields);
+
+  // copies keep their own character classes
+  FieldParser copy{parser};
+  parser.masked({});
+  iss.str("x;y\tz");
+  iss.clear();
+  copy.parse_fields(&iss, &fields, 2);
+  EXPECT_EQ((std::vector<std::string>{"x", "yz"}), fields);
+}
+
+TEST(FieldParserBufferTest, FieldsStraddlingBufferBoundaries) {
+  std::string data{"foo_bar\tba#z_bum\tbel_bol\nr#f_h#d\tpif"};
+  std::vector<std::vector<std::string>> expected{
+      {"foo", "bar"}, {"baz", "bum"}, {"bel", "bol"}, {"rf", "hd"}, {"pif"}};
+  FieldParser parser;
+  parser.delimiters({'\t', '_'});
+  parser.masked({'#'});
+  parser.enforce_field_number(false);
+  parser.ignore_underfull_data(false);
+  for (std::size_t window : {0, 1, 2, 3, 5, 64}) {
+    ChunkedStreambuf buf{data, window};
+    std::istream is{&buf};
+    std::vector<std::vector<std::string>> result;
+    std::vector<std::string> fields;
+    while (parser.parse_fields(&is, &fields, 2)) {
+      result.push_back(fields);
+    }
+    result.push_back(fields);
+    EXPECT_EQ(expected, result) << "window size " << window;
+  }
+}
+
+TEST(FieldParserBufferTest, StreamPositionAfterEmptyField) {
+  FieldParser parser;
+  std::istringstream iss{"a\t\tb\tc"};
+  std::vector<std::string> fields;
+  parser.parse_fields(&iss, &fields, 1);
+  EXPECT_THROW(parser.parse_fields(&iss, &fields, 1), EmptyField);
+  EXPECT_EQ('b', iss.peek());
+}
+
+TEST_P(FieldParserParserFieldsTest, ReuseFields) {
+  parser.reuse_fields(true);
+
+  execute_with_expectations(TestPattern::kEnforceFieldNumberThrow, 2);
+  EXPECT_EQ(parsed_fields, GetParam().expectations.at(
+      static_cast<int>(TestPattern::kEnforceFieldNumberThrow)).fields);
+}
+
+TEST(FieldParserReuseTest, KeepsCapacityAndLeavesFieldsOnException) {
+  std::string long_field(100, 'a');
+  std::string input;
+  for (int i = 0; i < 8; ++i) {
+    input.append(long_field + "\t");
+  }
+  std::istringstream iss{input + "\t"};
+  FieldParser parser;
+  parser.reuse_fields(true);
+  EXPECT_TRUE(parser.reuse_fields());
+  std::vector<std::string> fields;
+  parser.parse_fields(&iss, &fields, 2);
+  parser.parse_fields(&iss, &fields, 2);
+  // from now on, the strings of the first two requests alternate
+  const char* first{fields[0].data()};
+  parser.parse_fields(&iss, &fields, 2);
+  parser.parse_fields(&iss, &fields, 2);
+  EXPECT_EQ(first, fields[0].data());
+  EXPECT_EQ((std::vector<std::string>{long_field, long_field}), fields);
+  EXPECT_THROW(parser.parse_fields(&iss, &fields, 2), EmptyField);
+  EXPECT_EQ((std::vector<std::string>{long_field, long_field}), fields);
+}
+
+TEST(FieldParserReuseTest, SharedParserReusesStringsPerThread) {
+  FieldParser reusing;
+  reusing.reuse_fields(true);
+  const FieldParser& parser{reusing};
+  std::vector<std::vector<std::string>> results(4);
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    threads.emplace_back([&parser, &results, i] {
+      std::string field(50, static_cast<char>('a' + i));
+      std::string input;
+      for (int j = 0; j < 1000; ++j) {
+        input.append(field + "\t" + std::to_string(j) + "\n");
+      }
+      std::istringstream iss{input};
+      std::vector<std::string> fields;
+      for (int j = 0; j < 1000; ++j) {
+        parser.parse_fields(&iss, &fields, 2);
+        if (fields != std::vector<std::string>{field, std::to_string(j)}) {
+          return;
+        }
+      }
+      results[i] = fields;
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    EXPECT_EQ((std::vector<std::string>{
+                  std::string(50, static_cast<char>('a' + i)), "999"}),
+              results[i]);
+  }
+}
+
+TEST(FieldParserFieldParsersTest, ReplacedAndAdded) {
+  std::istringstream iss{"a\tb\tc\td"};
+  FieldParser parser;
+  parser.add_parser(1, [](std::string* s){s->append("-1");});
+  parser.field_parsers({
+    {0, [](std::string* s){s->append("-0");}},
+    {3, [](std::string* s){s->append("-3");}}
+  });
+  parser.add_parser(4, [](std::string* s){s->append("-4");});
+  parser.add_parser(9, [](std::string* s){s->append("-9");});
+  std::vector<std::string> fields;
+  parser.parse_fields(&iss, &fields, 4);
+  EXPECT_EQ((std::vector<std::string>{"a", "b", "c-3", "d-4"}), fields);
+  EXPECT_EQ(4u, parser.field_parsers().size());
+}
+
+TEST(FieldParserBatchTest, GroupsOfFields) {
+  std::string data{"a\tb\tc\nd\te\tf\tg\th"};
+  FieldParser parser;
+  parser.add_parser(2, [](std::string* s){s->append("-2");});
+  parser.enforce_field_number(false);
+  RowBatch batch;
+  for (std::size_t window : {0, 1, 64}) {
+    ChunkedStreambuf buf{data, window};
+    std::istream is{&buf};
+    std::vector<std::vector<std::string>> groups;
+    while (parser.parse_fields(&is, &batch, 2, 2) > 0) {
+      for (std::size_t i = 0; i < batch.size(); ++i) {
+        groups.emplace_back(batch[i].begin(), batch[i].end());
+      }
+    }
+    // the underfull groups {"c"} and {"h"} are ignored
+    EXPECT_EQ((std::vector<std::vector<std::string>>{
+                  {"a", "b-2"}, {"d", "e-2"}, {"f", "g-2"}}), groups)
+        << "window size " << window;
+  }
+  MemorySource source{data.data(), data.size()};
+  parser.ignore_underfull_data(false);
+  EXPECT_EQ(5u, parser.parse_fields(&source, &batch, 2, 10));
+  EXPECT_EQ((std::vector<std::string>{"c"}),
+            std::vector<std::string>(batch[1].begin(), batch[1].end()));
+  EXPECT_EQ(8u, batch.field_count());
+  EXPECT_THROW(parser.parse_fields(&source, &batch, 0, 10), InvalidArgument);
+}
+
+TEST(FieldParserBatchTest, KeepsGroupsBeforeException) {
+  std::istringstream iss{"a\tb\tc\t\td\te"};
+  FieldParser parser;
+  RowBatch batch;
+  EXPECT_THROW(parser.parse_fields(&iss, &batch, 2, 10), EmptyField);
+  ASSERT_EQ(1u, batch.size());
+  EXPECT_EQ(2u, batch.field_count());
+  EXPECT_EQ("b", batch[0][1]);
+  EXPECT_EQ('d', iss.peek());
+}
+
+TEST(FieldParserArenaTest, MatchesStringFields) {
+  std::string data{"foo_bar\tba#z_bum\tbel_a field of more than fifteen"
+                   " characters\nr#f_h#d\tpif"};
+  FieldParser parser;
+  parser.delimiters({'\t', '_'});
+  parser.masked({'#'});
+  parser.enforce_field_number(false);
+  parser.ignore_underfull_data(false);
+  parser.add_parser(2, [](std::string* s){s->append("-2");});
+  Arena arena{32};
+  for (std::size_t window : {0, 1, 5, 64}) {
+    ChunkedStreambuf expected_buf{data, window};
+    std::istream expected_is{&expected_buf};
+    ChunkedStreambuf buf{data, window};
+    std::istream is{&buf};
+    std::vector<std::string> expected;
+    ArenaRow fields{ArenaRow::allocator_type{&arena}};
+    while (parser.parse_fields(&expected_is, &expected, 2)) {
+      ASSERT_TRUE(parser.parse_fields(&is, &fields, 2));
+      ASSERT_EQ(expected.size(), fields.size());
+      for (std::size_t i = 0; i < fields.size(); ++i) {
+        EXPECT_EQ(expected[i], std::string(fields[i].data(), fields[i].size()));
+      }
+    }
+    EXPECT_FALSE(parser.parse_fields(&is, &fields, 2));
+    ASSERT_EQ(1u, fields.size());
+    EXPECT_EQ("pif", std::string(fields[0].data(), fields[0].size()));
+    arena.reset();
+  }
+}
+
+TEST(FieldParserArenaTest, LeavesFieldsOnException) {
+  Arena arena;
+  FieldParser parser;
+  std::istringstream iss{"a\t\tb"};
+  ArenaRow fields{ArenaRow::allocator_type{&arena}};
+  parser.parse_fields(&iss, &fields, 1);
+  EXPECT_THROW(parser.parse_fields(&iss, &fields, 1), EmptyField);
+  ASSERT_EQ(1u, fields.size());
+  EXPECT_EQ("a", std::string(fields[0].data(), fields[0].size()));
+  EXPECT_THROW(parser.parse_fields(&iss, &fields, 0), InvalidArgument);
+}
+
+TEST(FieldParserStatusTest, TryParseFieldsReportsStatus) {
+  std::istringstream iss{"a\t#b\t\tc\nd"};
+  FieldParser parser;
+  parser.masked({'#'});
+  std::vector<std::string> fields;
+  ParseStatus status{parser.try_parse_fields(&iss, &fields, 2)};
+  EXPECT_TRUE(status.ok());
+  EXPECT_EQ((std::vector<std::string>{"a", "b"}), fields);
+
+  status = parser.try_parse_fields(&iss, &fields, 2);
+  EXPECT_EQ(ParseStatus::Code::kEmptyField, status.code);
+  EXPECT_EQ(1, status.field_count);
+  EXPECT_EQ(0u, status.offset);
+  EXPECT_EQ('c', iss.peek());
+  EXPECT_EQ((std::vector<std::string>{"a", "b"}), fields);
+
+  status = parser.try_parse_fields(&iss, &fields, 2);
+  EXPECT_EQ(ParseStatus::Code::kMissingFields, status.code);
+  EXPECT_EQ(1, status.field_count);
+  EXPECT_EQ(2, status.expected_fields);
+  EXPECT_EQ(2u, status.offset);
+  EXPECT_EQ('d', iss.peek());
+
+  parser.enforce_field_number(false);
+  status = parser.try_parse_fields(&iss, &fields, 2);
+  EXPECT_EQ(ParseStatus::Code::kIgnored, status.code);
+  EXPECT_EQ((std::vector<std::string>{"a", "b"}), fields);
+
+  std::string data{"x\t\ty"};
+  MemorySource source{data.data(), data.size()};
+  parser.ignore_underfull_data(false);
+  status = parser.try_parse_fields(&source, &fields, 3);
+  EXPECT_EQ(ParseStatus::Code::kEmptyField, status.code);
+  EXPECT_EQ(2, status.field_count);
+  EXPECT_EQ(2u, status.offset);
+  EXPECT_THROW(parser.try_parse_fields(&source, &fields, 0), InvalidArgument);
+}
+
 INSTANTIATE_TEST_SUITE_P(Expected,
                          FieldParserParserFieldsTest,
                          testing::ValuesIn(kTestCases));
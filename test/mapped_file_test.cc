@@ -0,0 +1,130 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include "gtest/gtest.h"
+
+#include "delimited_row_parser.h"
+#include "exceptions.h"
+#include "field_parser.h"
+#include "mapped_file.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+namespace {
+
+class MappedFileTest : public ::testing::Test {
+ protected:
+  std::string path{::testing::TempDir() + "mapped_file_test.tsv"};
+  std::string contents{"foo\tbar\tbaz\n"
+                       "one\t two \t three\n"
+                       "\n"
+                       "x\ty\tz"};
+
+  void SetUp() override {
+    write(contents);
+  }
+
+  void TearDown() override {
+    std::remove(path.c_str());
+  }
+
+  void write(const std::string& data) {
+    std::ofstream ofs{path, std::ios_base::binary | std::ios_base::trunc};
+    ofs << data;
+  }
+};
+
+TEST_F(MappedFileTest, Contents) {
+  MappedFile file{path};
+  ASSERT_EQ(contents.size(), file.size());
+  EXPECT_EQ(contents, std::string(file.data(), file.size()));
+
+  MappedFile moved{std::move(file)};
+  EXPECT_EQ(nullptr, file.data());
+  EXPECT_EQ(0u, file.size());
+  EXPECT_EQ(contents, std::string(moved.data(), moved.size()));
+}
+
+TEST_F(MappedFileTest, EmptyFile) {
+  write("");
+  MappedFile file{path};
+  EXPECT_EQ(0u, file.size());
+  MemorySource source{file.source()};
+  std::vector<std::string> row;
+  DelimitedRowParser parser;
+  EXPECT_FALSE(parser.parse_row(&source, &row));
+  EXPECT_EQ((std::vector<std::string>{""}), row);
+}
+
+TEST_F(MappedFileTest, MissingFile) {
+  EXPECT_THROW(MappedFile{path + ".missing"}, FileError);
+}
+
+TEST_F(MappedFileTest, DelimitedRowParserMatchesStream) {
+  MappedFile file{path};
+  MemorySource source{file.source()};
+  std::istringstream iss{contents};
+  DelimitedRowParser parser;
+  std::vector<std::string> expected, result;
+  bool more{true};
+  while (more) {
+    more = static_cast<bool>(parser.parse_row(&iss, &expected));
+    EXPECT_EQ(more, static_cast<bool>(parser.parse_row(&source, &result)));
+    EXPECT_EQ(expected, result);
+  }
+  EXPECT_EQ((std::vector<std::string>{"x", "y", "z"}), result);
+}
+
+TEST_F(MappedFileTest, FieldParserMatchesStream) {
+  MappedFile file{path};
+  MemorySource source{file.source()};
+  std::istringstream iss{contents};
+  FieldParser parser;
+  parser.masked({' '});
+  parser.terminators({});
+  parser.delimiters({'\t', '\n'});
+  parser.enforce_field_number(false);
+  parser.ignore_underfull_data(false);
+  std::vector<std::string> expected, result;
+  bool more{true};
+  while (more) {
+    // the empty row is an empty field
+    try {
+      more = static_cast<bool>(parser.parse_fields(&iss, &expected, 2));
+    } catch (const EmptyField&) {
+      EXPECT_THROW(parser.parse_fields(&source, &result, 2), EmptyField);
+      continue;
+    }
+    EXPECT_EQ(more,
+              static_cast<bool>(parser.parse_fields(&source, &result, 2)));
+    EXPECT_EQ(expected, result);
+  }
+  EXPECT_EQ((std::vector<std::string>{"z"}), result);
+}
+
+} // namespace
+
+} // namespace stl_ios_utilities
@@ -0,0 +1,216 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "gtest/gtest.h"
+
+#include "delimited_row_parser.h"
+#include "mapped_file.h"
+#include "parallel_row_parser.h"
+#include "row_test_data.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+namespace {
+
+using test::Rows;
+
+Rows parse_in_parallel(const ParallelRowParser& parser,
+                       const std::string& data,
+                       ParallelRowParser::Order order) {
+  Rows rows;
+  parser.parse(data.data(), data.size(), order,
+               [&rows](std::vector<std::string>* row) {
+                 rows.push_back(std::move(*row));
+               });
+  return rows;
+}
+
+TEST(ParallelRowParserTest, BothOrdersMatchSequentialParsing) {
+  DelimitedRowParser row_parser;
+  row_parser.set_parser(2, [](std::string* s){s->append("_parsed");});
+  for (bool final_newline : {true, false}) {
+    std::string data{test::generate_rows(2000, final_newline)};
+    Rows expected{test::parse_sequentially(row_parser, data)};
+    for (std::size_t chunk_size : {1, 7, 64, 1000, 1 << 20}) {
+      for (unsigned thread_count : {1, 3, 8}) {
+        ParallelRowParser parser{row_parser};
+        parser.chunk_size(chunk_size);
+        parser.thread_count(thread_count);
+        EXPECT_EQ(expected, parse_in_parallel(
+            parser, data, ParallelRowParser::Order::kOriginal))
+            << chunk_size << ' ' << thread_count;
+        Rows unordered{parse_in_parallel(
+            parser, data, ParallelRowParser::Order::kUnordered)};
+        Rows sorted_expected{expected};
+        std::sort(sorted_expected.begin(), sorted_expected.end());
+        std::sort(unordered.begin(), unordered.end());
+        EXPECT_EQ(sorted_expected, unordered)
+            << chunk_size << ' ' << thread_count;
+      }
+    }
+  }
+}
+
+TEST(ParallelRowParserTest, QuotedFieldsMatchSequentialParsing) {
+  DelimitedRowParser row_parser;
+  row_parser.quote_fields(true);
+  std::string data{test::generate_quoted_rows(1000)};
+  ASSERT_NE(std::string::npos, data.find("\n\"\"")) << "no quoted newline";
+  Rows expected{test::parse_sequentially(row_parser, data)};
+  ASSERT_EQ(std::size_t{1000}, expected.size());
+  for (std::size_t chunk_size : {1, 2, 7, 64, 1000, 1 << 20}) {
+    for (unsigned thread_count : {1, 3, 8}) {
+      ParallelRowParser parser{row_parser};
+      parser.chunk_size(chunk_size);
+      parser.thread_count(thread_count);
+      EXPECT_EQ(expected, parse_in_parallel(
+          parser, data, ParallelRowParser::Order::kOriginal))
+          << chunk_size << ' ' << thread_count;
+    }
+  }
+}
+
+TEST(ParallelRowParserTest, UnterminatedQuoteIsPropagated) {
+  DelimitedRowParser row_parser;
+  row_parser.quote_fields(true);
+  ParallelRowParser parser{row_parser};
+  parser.chunk_size(5);
+  parser.thread_count(3);
+  std::string data{"a\t\"b\nc\"\nd\t\"e\nf\n"};
+  EXPECT_THROW(parse_in_parallel(parser, data,
+                                 ParallelRowParser::Order::kOriginal),
+               DelimitedRowParser::UnterminatedQuote);
+  data.append("\"\n");
+  EXPECT_EQ((Rows{{"a", "b\nc"}, {"d", "e\nf\n"}}), parse_in_parallel(
+      parser, data, ParallelRowParser::Order::kOriginal));
+}
+
+TEST(ParallelRowParserTest, ParsingContinuesWhileHandlerRuns) {
+  // 8 chunks of 25 rows, all of which fit into the window of 4 threads
+  std::string data;
+  for (int i = 0; i < 200; ++i) {
+    data.append("a\n");
+  }
+  std::atomic<int> parsed{0};
+  DelimitedRowParser row_parser;
+  row_parser.set_parser(1, [&parsed](std::string*) {++parsed;});
+  ParallelRowParser parser{row_parser};
+  parser.chunk_size(50);
+  parser.thread_count(4);
+  for (auto order : {ParallelRowParser::Order::kOriginal,
+                     ParallelRowParser::Order::kUnordered}) {
+    parsed = 0;
+    bool first{true};
+    bool overlapped{false};
+    int handled{0};
+    parser.parse(data.data(), data.size(), order,
+                 [&](std::vector<std::string>*) {
+                   ++handled;
+                   if (!first) {
+                     return;
+                   }
+                   first = false;
+                   // the other threads parse the remaining chunks meanwhile
+                   auto deadline = std::chrono::steady_clock::now()
+                                   + std::chrono::seconds(10);
+                   while (parsed < 200
+                          && std::chrono::steady_clock::now() < deadline) {
+                     std::this_thread::yield();
+                   }
+                   overlapped = parsed == 200;
+                 });
+    EXPECT_TRUE(overlapped);
+    EXPECT_EQ(200, handled);
+  }
+}
+
+TEST(ParallelRowParserTest, IgnoredRowsAcrossChunksAndEmptyInput) {
+  DelimitedRowParser row_parser;
+  row_parser.min_fields(2);
+  row_parser.enforce_min_fields(false);
+  ParallelRowParser parser{row_parser};
+  parser.chunk_size(4);
+  parser.thread_count(4);
+  std::string data{"a\tb\nc\n\nd\te\n"};
+  EXPECT_EQ((Rows{{"a", "b"}, {"d", "e"}}), parse_in_parallel(
+      parser, data, ParallelRowParser::Order::kOriginal));
+  EXPECT_EQ(Rows{}, parse_in_parallel(
+      parser, "", ParallelRowParser::Order::kOriginal));
+}
+
+TEST(ParallelRowParserTest, WorkerAndHandlerExceptionsArePropagated) {
+  std::string data{test::generate_rows_with_overfull_row(1000)};
+  DelimitedRowParser row_parser;
+  row_parser.max_fields(6);
+  row_parser.ignore_overfull_row(false);
+  ParallelRowParser parser{row_parser};
+  parser.chunk_size(256);
+  parser.thread_count(4);
+  ParallelRowParser unlimited;
+  unlimited.chunk_size(256);
+  unlimited.thread_count(4);
+  for (auto order : {ParallelRowParser::Order::kOriginal,
+                     ParallelRowParser::Order::kUnordered}) {
+    EXPECT_THROW(parse_in_parallel(parser, data, order),
+                 DelimitedRowParser::UnexpectedFields);
+    int handled{0};
+    EXPECT_THROW(unlimited.parse(data.data(), data.size(), order,
+                                 [&handled](std::vector<std::string>*) {
+                                   if (++handled == 10) {
+                                     throw std::runtime_error("handler");
+                                   }
+                                 }),
+                 std::runtime_error);
+    EXPECT_EQ(10, handled);
+  }
+}
+
+TEST(ParallelRowParserTest, MappedFile) {
+  std::string path{::testing::TempDir() + "parallel_row_parser_test.tsv"};
+  std::string data{test::generate_rows(500, false)};
+  {
+    std::ofstream ofs{path, std::ios_base::binary | std::ios_base::trunc};
+    ofs << data;
+  }
+  MappedFile file{path};
+  ParallelRowParser parser;
+  parser.chunk_size(100);
+  Rows rows;
+  parser.parse(file, ParallelRowParser::Order::kOriginal,
+               [&rows](std::vector<std::string>* row) {
+                 rows.push_back(*row);
+               });
+  EXPECT_EQ(test::parse_sequentially(DelimitedRowParser{}, data), rows);
+  std::remove(path.c_str());
+}
+
+} // namespace
+
+} // namespace stl_ios_utilities
@@ -0,0 +1,120 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "gtest/gtest.h"
+
+#include "delimited_row_parser.h"
+#include "field_parser.h"
+#include "parse_statistics.h"
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+namespace {
+
+TEST(ParseStatisticsTest, Enabled) {
+  EXPECT_TRUE(kParseStatisticsEnabled);
+}
+
+TEST(ParseStatisticsTest, DelimitedRowParserCountsRows) {
+  DelimitedRowParser parser;
+  parser.min_fields(2);
+  parser.max_fields(3);
+  parser.enforce_min_fields(false);
+  parser.set_parser(1, [](std::string* field) {field->append("!");});
+  DelimitedRowParser::reset_statistics();
+  // accepted, ignored, accepted, rejected
+  std::istringstream iss{"a\tb\nc\nd\te\tf\ng\th\ti\tj\tk\n"};
+  std::vector<std::string> row;
+  parser.parse_row(&iss, &row);
+  parser.parse_row(&iss, &row);
+  parser.parse_row(&iss, &row);
+  EXPECT_THROW(parser.parse_row(&iss, &row),
+               DelimitedRowParser::UnexpectedFields);
+  ParseStatistics statistics{DelimitedRowParser::statistics()};
+  EXPECT_EQ(4u, statistics.rows_read);
+  EXPECT_EQ(2u, statistics.rows_accepted);
+  EXPECT_EQ(1u, statistics.rows_ignored);
+  EXPECT_EQ(1u, statistics.rows_rejected);
+  EXPECT_EQ(5u, statistics.fields_produced);
+  // the fourth row is read up to the delimiter after its third field
+  EXPECT_EQ(4u + 2u + 6u + 6u, statistics.bytes_consumed);
+  EXPECT_GT(statistics.field_parser_time.count(), 0);
+  EXPECT_EQ(0u, FieldParser::statistics().rows_read);
+
+  DelimitedRowParser::reset_statistics();
+  statistics = DelimitedRowParser::statistics();
+  EXPECT_EQ(0u, statistics.rows_read);
+  EXPECT_EQ(0u, statistics.bytes_consumed);
+  EXPECT_EQ(0, statistics.tokenize_time.count());
+}
+
+TEST(ParseStatisticsTest, FieldParserCountsGroups) {
+  FieldParser parser;
+  parser.delimiters({','});
+  parser.add_parser(2, [](std::string* field) {field->append("!");});
+  FieldParser::reset_statistics();
+  std::istringstream iss{"a,b\nc\n,d\n"};
+  std::vector<std::string> fields;
+  parser.parse_fields(&iss, &fields, 2);
+  EXPECT_THROW(parser.parse_fields(&iss, &fields, 2),
+               MissingFields);
+  EXPECT_THROW(parser.parse_fields(&iss, &fields, 2),
+               EmptyField);
+  parser.enforce_field_number(false);
+  EXPECT_EQ(ParseStatus::Code::kIgnored,
+            parser.try_parse_fields(&iss, &fields, 2).code);
+  ParseStatistics statistics{FieldParser::statistics()};
+  EXPECT_EQ(4u, statistics.rows_read);
+  EXPECT_EQ(1u, statistics.rows_accepted);
+  EXPECT_EQ(1u, statistics.rows_ignored);
+  EXPECT_EQ(2u, statistics.rows_rejected);
+  EXPECT_EQ(2u, statistics.fields_produced);
+  EXPECT_EQ(4u + 2u + 1u + 2u, statistics.bytes_consumed);
+}
+
+TEST(ParseStatisticsTest, SumsThreads) {
+  DelimitedRowParser::reset_statistics();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([]() {
+      DelimitedRowParser parser;
+      std::istringstream iss{"a\tb\nc\td\n"};
+      std::vector<std::string> row;
+      while (parser.parse_row(&iss, &row)) {}
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  // each thread reads an empty row after the final newline character
+  ParseStatistics statistics{DelimitedRowParser::statistics()};
+  EXPECT_EQ(12u, statistics.rows_read);
+  EXPECT_EQ(12u, statistics.rows_accepted);
+  EXPECT_EQ(32u, statistics.bytes_consumed);
+}
+
+} // namespace
+
+} // namespace stl_ios_utilities
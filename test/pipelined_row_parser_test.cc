@@ -0,0 +1,161 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "gtest/gtest.h"
+
+#include "chunked_streambuf.h"
+#include "delimited_row_parser.h"
+#include "pipelined_row_parser.h"
+#include "row_test_data.h"
+
+#include <istream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+namespace {
+
+using test::Rows;
+
+Rows parse_pipelined(const PipelinedRowParser& parser, std::istream* is) {
+  Rows rows;
+  parser.parse(is, [&rows](std::vector<std::string>* row) {
+    rows.push_back(std::move(*row));
+  });
+  return rows;
+}
+
+TEST(PipelinedRowParserTest, BlockSizesMatchSequentialParsing) {
+  DelimitedRowParser row_parser;
+  row_parser.set_parser(1, [](std::string* s){s->append("_1");});
+  row_parser.set_parser(3, [](std::string* s){s->append("_3");});
+  for (bool final_newline : {true, false}) {
+    std::string data{test::generate_rows(3000, final_newline)};
+    Rows expected{test::parse_sequentially(row_parser, data)};
+    for (std::size_t block_size : {1, 10, 333, 1 << 20}) {
+      for (unsigned transform_threads : {1, 4}) {
+        PipelinedRowParser parser{row_parser};
+        parser.block_size(block_size);
+        parser.block_count(3);
+        parser.transform_threads(transform_threads);
+        std::istringstream iss{data};
+        EXPECT_EQ(expected, parse_pipelined(parser, &iss))
+            << block_size << ' ' << transform_threads;
+        EXPECT_TRUE(iss.eof());
+      }
+    }
+    // reads from buffers that expose only a few characters at a time
+    PipelinedRowParser parser{row_parser};
+    parser.block_size(64);
+    test::ChunkedStreambuf buffer{data, 5};
+    std::istream is{&buffer};
+    EXPECT_EQ(expected, parse_pipelined(parser, &is));
+  }
+}
+
+TEST(PipelinedRowParserTest, SelectedColumns) {
+  DelimitedRowParser row_parser;
+  row_parser.set_parser(1, [](std::string* s){s->append("_1");});
+  row_parser.set_parser(3, [](std::string* s){s->append("_3");});
+  row_parser.select_columns({3, 5, 1});
+  std::string data{test::generate_rows(1000, true)};
+  Rows expected{test::parse_sequentially(row_parser, data)};
+  PipelinedRowParser parser{row_parser};
+  parser.block_size(100);
+  parser.transform_threads(2);
+  std::istringstream iss{data};
+  EXPECT_EQ(expected, parse_pipelined(parser, &iss));
+}
+
+TEST(PipelinedRowParserTest, QuotedAndEscapedFields) {
+  DelimitedRowParser row_parser;
+  row_parser.delimiter(',');
+  row_parser.quote_fields(true);
+  row_parser.set_parser(2, [](std::string* s){s->append("_2");});
+  std::string data;
+  for (int i = 0; i < 200; ++i) {
+    data.append("a,\"b,c\",d\nx,\"he said \"\"hi\"\"\",z\n\"\",,\"q\"\n");
+  }
+  Rows expected{test::parse_sequentially(row_parser, data)};
+  ASSERT_EQ(600u, expected.size());
+  EXPECT_EQ((std::vector<std::string>{"x", "he said \"hi\"_2", "z"}),
+            expected[1]);
+  for (std::size_t block_size : {1, 7, 64, 1 << 20}) {
+    PipelinedRowParser parser{row_parser};
+    parser.block_size(block_size);
+    parser.transform_threads(2);
+    std::istringstream iss{data};
+    EXPECT_EQ(expected, parse_pipelined(parser, &iss)) << block_size;
+  }
+}
+
+TEST(PipelinedRowParserTest, IgnoredRowsAcrossBlocksAndEmptyInput) {
+  DelimitedRowParser row_parser;
+  row_parser.max_fields(1);
+  row_parser.enforce_max_fields(false);
+  PipelinedRowParser parser{row_parser};
+  parser.block_size(3);
+  std::istringstream iss{"a\nb\tc\n\nd"};
+  EXPECT_EQ((Rows{{"a"}, {""}, {"d"}}), parse_pipelined(parser, &iss));
+  std::istringstream empty{""};
+  EXPECT_EQ(Rows{}, parse_pipelined(parser, &empty));
+}
+
+TEST(PipelinedRowParserTest, StageAndHandlerExceptionsArePropagated) {
+  std::string data{test::generate_rows_with_overfull_row(2000)};
+  DelimitedRowParser row_parser;
+  row_parser.max_fields(6);
+  row_parser.ignore_overfull_row(false);
+  PipelinedRowParser parser{row_parser};
+  parser.block_size(128);
+  parser.block_count(4);
+  std::istringstream iss{data};
+  EXPECT_THROW(parse_pipelined(parser, &iss),
+               DelimitedRowParser::UnexpectedFields);
+
+  DelimitedRowParser throwing_parser;
+  throwing_parser.set_parser(2, [](std::string* s){
+    if (*s == "x") {
+      throw std::runtime_error("field parser");
+    }
+  });
+  parser.parser(throwing_parser);
+  std::istringstream field_error{data + "a\tx\n" + data};
+  EXPECT_THROW(parse_pipelined(parser, &field_error), std::runtime_error);
+
+  parser.parser(DelimitedRowParser{});
+  std::istringstream handler_error{data};
+  int handled{0};
+  EXPECT_THROW(parser.parse(&handler_error,
+                            [&handled](std::vector<std::string>*) {
+                              if (++handled == 100) {
+                                throw std::logic_error("handler");
+                              }
+                            }),
+               std::logic_error);
+  EXPECT_EQ(100, handled);
+}
+
+} // namespace
+
+} // namespace stl_ios_utilities
@@ -0,0 +1,254 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "gtest/gtest.h"
+
+#include "delimited_row_parser.h"
+#include "exceptions.h"
+#include "input_source.h"
+#include "row_index.h"
+#include "row_test_data.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+namespace {
+
+using test::Rows;
+
+// generated rows, the quoted ones of which contain newline characters if
+// `quoted` is set
+std::string generate_data(int row_count, bool quoted) {
+  return quoted ? test::generate_quoted_rows(row_count)
+                : test::generate_rows(row_count, true);
+}
+
+void write_file(const std::string& path, const std::string& data) {
+  std::ofstream ofs{path, std::ios_base::binary | std::ios_base::trunc};
+  ofs << data;
+}
+
+TEST(RowIndexTest, RecordsEveryStrideRow) {
+  DelimitedRowParser parser;
+  std::string data{"a\tb\n\nccc\nd\ne"};
+  RowIndex index{RowIndex::build(parser, data.data(), data.size())};
+  EXPECT_EQ(5u, index.row_count());
+  EXPECT_EQ((std::vector<std::uint64_t>{0, 4, 5, 9, 11}), index.offsets());
+  RowIndex sparse{RowIndex::build(parser, data.data(), data.size(), 2)};
+  EXPECT_EQ(5u, sparse.row_count());
+  EXPECT_EQ((std::vector<std::uint64_t>{0, 5, 11}), sparse.offsets());
+  std::size_t row;
+  EXPECT_EQ(5u, sparse.locate(3, &row));
+  EXPECT_EQ(2u, row);
+  EXPECT_EQ(11u, sparse.locate(4, &row));
+  EXPECT_EQ(4u, row);
+  EXPECT_THROW(sparse.locate(5, &row), InvalidArgument);
+  EXPECT_EQ(0u, RowIndex::build(parser, data.data(), 0).row_count());
+
+  // recording while parsing gives the same index
+  RowIndex recorded{2};
+  MemorySource source{data.data(), data.size()};
+  std::vector<std::string> fields;
+  while (source.begin() != source.end()) {
+    recorded.record(static_cast<std::uint64_t>(source.begin() - data.data()));
+    parser.parse_row(&source, &fields);
+  }
+  EXPECT_EQ(sparse.offsets(), recorded.offsets());
+  EXPECT_EQ(sparse.row_count(), recorded.row_count());
+}
+
+TEST(RowIndexTest, QuotedNewlinesDoNotEndRows) {
+  DelimitedRowParser parser;
+  parser.quote_fields(true);
+  std::string data{"\"a\nb\"\tc\nd\n"};
+  EXPECT_EQ((std::vector<std::uint64_t>{0, 8}),
+            RowIndex::build(parser, data.data(), data.size()).offsets());
+  std::string generated{generate_data(500, true)};
+  ASSERT_NE(std::string::npos, generated.find("\n\"")) << "no quoted newline";
+  EXPECT_EQ(500u, RowIndex::build(parser, generated.data(), generated.size(),
+                                  7).row_count());
+}
+
+TEST(RowIndexTest, SidecarIsKeyedOnFile) {
+  std::string path{::testing::TempDir() + "row_index_test_keyed.tsv"};
+  std::string index_path{RowIndex::sidecar_path(path)};
+  write_file(path, generate_data(1000, false));
+  RowIndex index{RowIndex::build(DelimitedRowParser{}, path, 10)};
+  EXPECT_EQ(1000u, index.row_count());
+  index.save(index_path);
+
+  DelimitedRowParser parser;
+  RowIndex loaded;
+  ASSERT_TRUE(RowIndex::load(index_path, path, parser, 10, &loaded));
+  EXPECT_EQ(index.offsets(), loaded.offsets());
+  EXPECT_EQ(index.row_count(), loaded.row_count());
+  EXPECT_EQ(10u, loaded.stride());
+  EXPECT_EQ(index.file_size(), loaded.file_size());
+  EXPECT_EQ(index.file_time(), loaded.file_time());
+
+  // as do other splitting options or strides
+  DelimitedRowParser quoting;
+  quoting.quote_fields(true);
+  RowIndex other;
+  EXPECT_FALSE(RowIndex::load(index_path, path, quoting, 10, &other));
+  EXPECT_FALSE(RowIndex::load(index_path, path, parser, 1, &other));
+  EXPECT_EQ(0u, other.row_count());
+  parser.delimiter(',');
+  EXPECT_TRUE(RowIndex::load(index_path, path, parser, 10, &other));
+
+  // a changed file makes the index stale
+  write_file(path, generate_data(999, false));
+  RowIndex stale;
+  EXPECT_FALSE(RowIndex::load(index_path, path, parser, 10, &stale));
+  EXPECT_EQ(0u, stale.row_count());
+
+  // truncated and missing sidecars are rejected
+  index = RowIndex::build(DelimitedRowParser{}, path, 10);
+  index.save(index_path);
+  std::string sidecar;
+  {
+    std::ifstream ifs{index_path, std::ios_base::binary};
+    sidecar.assign(std::istreambuf_iterator<char>{ifs},
+                   std::istreambuf_iterator<char>{});
+  }
+  write_file(index_path, sidecar.substr(0, sidecar.size() - 1));
+  EXPECT_FALSE(RowIndex::load(index_path, path, parser, 10, &stale));
+  std::remove(index_path.c_str());
+  EXPECT_FALSE(RowIndex::load(index_path, path, parser, 10, &stale));
+  std::remove(path.c_str());
+}
+
+TEST(IndexedRowReaderTest, ReadsRangesLikeSequentialParsing) {
+  for (bool quoted : {false, true}) {
+    std::string path{::testing::TempDir() + "row_index_test_ranges.tsv"};
+    std::string data{generate_data(300, quoted)};
+    write_file(path, data);
+    DelimitedRowParser parser;
+    parser.quote_fields(quoted);
+    parser.set_parser(1, [](std::string* s){s->append("_parsed");});
+    Rows expected{test::parse_sequentially(parser, data, true)};
+    ASSERT_EQ(300u, expected.size());
+    for (std::size_t stride : {1, 16}) {
+      std::remove(RowIndex::sidecar_path(path).c_str());
+      IndexedRowReader reader{path, parser, stride};
+      ASSERT_EQ(300u, reader.row_count());
+      for (std::size_t first : {0, 1, 15, 16, 17, 299}) {
+        Rows rows;
+        EXPECT_EQ(std::min<std::size_t>(40, 300 - first), reader.read_rows(
+            first, 40, [&rows](std::vector<std::string>* row) {
+              rows.push_back(*row);
+            }));
+        std::size_t last{std::min<std::size_t>(first + 40, 300)};
+        EXPECT_EQ(Rows(expected.begin() + first, expected.begin() + last),
+                  rows) << quoted << ' ' << stride << ' ' << first;
+      }
+      std::vector<std::string> row;
+      EXPECT_TRUE(reader.read_row(123, &row));
+      EXPECT_EQ(expected[123], row);
+      EXPECT_THROW(reader.read_row(300, &row), InvalidArgument);
+      EXPECT_EQ(0u, reader.read_rows(300, 1, [](std::vector<std::string>*) {}));
+    }
+    std::remove(RowIndex::sidecar_path(path).c_str());
+    std::remove(path.c_str());
+  }
+}
+
+TEST(IndexedRowReaderTest, ReusesAndRebuildsSidecar) {
+  std::string path{::testing::TempDir() + "row_index_test_sidecar.tsv"};
+  std::string index_path{RowIndex::sidecar_path(path)};
+  std::remove(index_path.c_str());
+  write_file(path, "a\nb\nc\n");
+  {
+    IndexedRowReader reader{path, DelimitedRowParser{}, 2};
+    EXPECT_EQ(3u, reader.row_count());
+  }
+  RowIndex saved;
+  ASSERT_TRUE(RowIndex::load(index_path, path, DelimitedRowParser{}, 2,
+                             &saved));
+  EXPECT_EQ(2u, saved.stride());
+  {
+    // a sidecar of another stride is replaced
+    IndexedRowReader reader{path, DelimitedRowParser{}, 1};
+    EXPECT_EQ(1u, reader.index().stride());
+  }
+  ASSERT_TRUE(RowIndex::load(index_path, path, DelimitedRowParser{}, 1,
+                             &saved));
+  write_file(path, "a\nb\nc\nd\n");
+  {
+    IndexedRowReader reader{path, DelimitedRowParser{}, 1};
+    EXPECT_EQ(4u, reader.row_count());
+    EXPECT_EQ(1u, reader.index().stride());
+    std::vector<std::string> row;
+    EXPECT_TRUE(reader.read_row(3, &row));
+    EXPECT_EQ(std::vector<std::string>{"d"}, row);
+  }
+  std::remove(index_path.c_str());
+  std::remove(path.c_str());
+}
+
+TEST(IndexedRowReaderTest, RebuildsSidecarOfOtherQuoting) {
+  std::string path{::testing::TempDir() + "row_index_test_quoting.tsv"};
+  std::remove(RowIndex::sidecar_path(path).c_str());
+  write_file(path, "a,\"x\ny\"\nb,c\n");
+  DelimitedRowParser parser;
+  parser.delimiter(',');
+  {
+    IndexedRowReader reader{path, parser};
+    EXPECT_EQ(3u, reader.row_count());
+  }
+  parser.quote_fields(true);
+  IndexedRowReader reader{path, parser};
+  EXPECT_EQ(2u, reader.row_count());
+  std::vector<std::string> row;
+  EXPECT_TRUE(reader.read_row(1, &row));
+  EXPECT_EQ((std::vector<std::string>{"b", "c"}), row);
+  std::remove(RowIndex::sidecar_path(path).c_str());
+  std::remove(path.c_str());
+}
+
+TEST(IndexedRowReaderTest, IgnoredRows) {
+  std::string path{::testing::TempDir() + "row_index_test_ignored.tsv"};
+  write_file(path, "a\tb\nc\nd\te\n");
+  DelimitedRowParser parser;
+  parser.min_fields(2);
+  parser.enforce_min_fields(false);
+  IndexedRowReader reader{path, parser};
+  std::vector<std::string> row{"x"};
+  EXPECT_FALSE(reader.read_row(1, &row));
+  EXPECT_TRUE(row.empty());
+  Rows rows;
+  EXPECT_EQ(3u, reader.read_rows(0, 3, [&rows](std::vector<std::string>* r) {
+    rows.push_back(*r);
+  }));
+  EXPECT_EQ((Rows{{"a", "b"}, {"d", "e"}}), rows);
+  std::remove(RowIndex::sidecar_path(path).c_str());
+  std::remove(path.c_str());
+}
+
+} // namespace
+
+} // namespace stl_ios_utilities
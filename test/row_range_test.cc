@@ -0,0 +1,141 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "gtest/gtest.h"
+
+#include "delimited_row_parser.h"
+#include "field_view.h"
+#include "input_source.h"
+#include "row_range.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace stl_ios_utilities {
+
+namespace {
+
+using Rows = std::vector<std::vector<std::string>>;
+
+template <typename Range>
+Rows collect(Range range) {
+  Rows rows;
+  for (std::vector<std::string>& row : range) {
+    rows.push_back(std::move(row));
+  }
+  return rows;
+}
+
+TEST(RowRangeTest, MatchesParseRow) {
+  DelimitedRowParser parser;
+  parser.min_fields(2);
+  parser.enforce_min_fields(false);
+  parser.set_parser(2, [](std::string* s){s->append("_parsed");});
+  for (std::string data : {"a\tb\nc\n\nd\te\tf\n", "a\tb\nc\n\nd\te\tf"}) {
+    std::istringstream iss{data};
+    EXPECT_EQ((Rows{{"a", "b_parsed"}, {"d", "e_parsed", "f"}}),
+              collect(rows(&parser, &iss)));
+    EXPECT_FALSE(iss.good());
+    MemorySource source{data.data(), data.size()};
+    EXPECT_EQ((Rows{{"a", "b_parsed"}, {"d", "e_parsed", "f"}}),
+              collect(rows(&parser, &source)));
+  }
+  std::istringstream empty{""};
+  EXPECT_EQ(Rows{}, collect(rows(&parser, &empty)));
+  std::istringstream single{"\n"};
+  DelimitedRowParser unlimited;
+  EXPECT_EQ(Rows{{""}}, collect(rows(&unlimited, &single)));
+}
+
+TEST(RowRangeTest, EarlyBreakLeavesRemainingRows) {
+  DelimitedRowParser parser;
+  std::istringstream iss{"a\nb\nc\nd\n"};
+  Rows read;
+  for (std::vector<std::string>& row : rows(&parser, &iss)) {
+    read.push_back(row);
+    if (read.size() == 2) {
+      break;
+    }
+  }
+  EXPECT_EQ((Rows{{"a"}, {"b"}}), read);
+  std::vector<std::string> row;
+  parser.parse_row(&iss, &row);
+  EXPECT_EQ(std::vector<std::string>{"c"}, row);
+}
+
+TEST(RowRangeTest, FiltersAndProjections) {
+  int parsed{0};
+  DelimitedRowParser parser;
+  parser.delimiter(',');
+  parser.set_parser(1, [&parsed](std::string*){++parsed;});
+  parser.set_parser(3, [&parsed](std::string* s){++parsed; s->append("!");});
+  std::string data{"1,x,a\n2,y,b\n3,x,c,d\n4,x\n"};
+  std::istringstream iss{data};
+  auto range = rows(&parser, &iss)
+      .filter([](const std::vector<FieldView>& row) {
+        return row[1] == "x";
+      })
+      .filter([](const std::vector<FieldView>& row) {
+        return row[0] != "4";
+      });
+  EXPECT_EQ((Rows{{"1", "x", "a!"}, {"3", "x", "c!", "d"}}), collect(range));
+  EXPECT_EQ(4, parsed);
+
+  // unselected columns are neither copied nor parsed, and missing ones are
+  // empty
+  parsed = 0;
+  MemorySource source{data.data(), data.size()};
+  EXPECT_EQ((Rows{{"a!", "x"}, {"b!", "y"}, {"c!", "x"}, {"!", "x"}}),
+            collect(rows(&parser, &source).select({3, 2})));
+  EXPECT_EQ(4, parsed);
+
+  // columns selected by the parser are referred to by their positions
+  parser.select_columns({3, 1});
+  source = MemorySource{data.data(), data.size()};
+  EXPECT_EQ((Rows{{"a!"}, {"c!"}}),
+            collect(rows(&parser, &source)
+                .filter([](const std::vector<FieldView>& row) {
+                  return row[1] != "2" && !row[0].empty();
+                })
+                .select({1})));
+}
+
+TEST(RowRangeTest, IteratorsAndExceptions) {
+  DelimitedRowParser parser;
+  parser.max_fields(1);
+  parser.ignore_overfull_row(false);
+  std::istringstream iss{"a\nb\tc\nd\n"};
+  auto range = rows(&parser, &iss);
+  auto it = range.begin();
+  ASSERT_NE(range.end(), it);
+  EXPECT_EQ("a", it->front());
+  EXPECT_THROW(++it, DelimitedRowParser::UnexpectedFields);
+  // the rest of the overfull row is read as the next row, as by parse_row
+  ++it;
+  EXPECT_EQ(std::vector<std::string>{"c"}, *it);
+  EXPECT_EQ(std::vector<std::string>{"d"}, *(++it));
+  it++;
+  EXPECT_EQ(range.end(), it);
+}
+
+} // namespace
+
+} // namespace stl_ios_utilities
@@ -0,0 +1,125 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef STL_IOS_UTILITIES_ROW_TEST_DATA_H_
+#define STL_IOS_UTILITIES_ROW_TEST_DATA_H_
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "delimited_row_parser.h"
+#include "input_source.h"
+
+namespace stl_ios_utilities {
+
+namespace test {
+
+using Rows = std::vector<std::vector<std::string>>;
+
+// rows of 0 to 6 fields of 0 to 12 letters, some of them empty lines
+inline std::string generate_rows(int row_count, bool final_newline) {
+  std::mt19937 generator{7};
+  std::uniform_int_distribution<int> fields{0, 6};
+  std::uniform_int_distribution<int> length{0, 12};
+  std::uniform_int_distribution<int> letter{'a', 'z'};
+  std::string data;
+  for (int i = 0; i < row_count; ++i) {
+    for (int j = fields(generator); j > 0; --j) {
+      for (int k = length(generator); k > 0; --k) {
+        data.push_back(static_cast<char>(letter(generator)));
+      }
+      if (j > 1) {
+        data.push_back('\t');
+      }
+    }
+    if (i + 1 < row_count || final_newline) {
+      data.push_back('\n');
+    }
+  }
+  return data;
+}
+
+// rows of 1 to 4 fields, the quoted ones of which contain delimiters, newline
+// characters, and doubled quotes
+inline std::string generate_quoted_rows(int row_count) {
+  std::mt19937 generator{11};
+  std::uniform_int_distribution<int> fields{1, 4};
+  std::uniform_int_distribution<int> length{0, 8};
+  std::uniform_int_distribution<int> quoted{0, 1};
+  const std::string characters{"abc\t\n\"\""};
+  std::uniform_int_distribution<std::size_t> character{
+      0, characters.size() - 1};
+  std::string data;
+  for (int i = 0; i < row_count; ++i) {
+    for (int j = fields(generator); j > 0; --j) {
+      bool quote{quoted(generator) == 1};
+      if (quote) {
+        data.push_back('"');
+      }
+      for (int k = length(generator); k > 0; --k) {
+        char c{characters[character(generator)]};
+        if (quote && c == '"') {
+          data.append("\"\"");
+        } else if (quote || (c != '\t' && c != '\n' && c != '"')) {
+          data.push_back(c);
+        }
+      }
+      if (quote) {
+        data.push_back('"');
+      }
+      if (j > 1) {
+        data.push_back('\t');
+      }
+    }
+    data.push_back('\n');
+  }
+  return data;
+}
+
+// generated rows with seven fields in the middle of them
+inline std::string generate_rows_with_overfull_row(int row_count) {
+  return generate_rows(row_count, true) + "a\tb\tc\td\te\tf\tg\n"
+         + generate_rows(row_count, true);
+}
+
+// rows read by `parser` one at a time; rows left empty are only kept if
+// `keep_empty_rows` is set
+inline Rows parse_sequentially(DelimitedRowParser parser,
+                               const std::string& data,
+                               bool keep_empty_rows = false) {
+  MemorySource source{data.data(), data.size()};
+  Rows rows;
+  std::vector<std::string> row;
+  while (source.begin() != source.end()) {
+    row.clear();
+    parser.parse_row(&source, &row);
+    if (!row.empty() || keep_empty_rows) {
+      rows.push_back(row);
+    }
+  }
+  return rows;
+}
+
+} // namespace test
+
+} // namespace stl_ios_utilities
+
+#endif // STL_IOS_UTILITIES_ROW_TEST_DATA_H_
@@ -0,0 +1,125 @@
+// Copyright (c) 2020 Jasper Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include "gtest/gtest.h"
+
+#include "exceptions.h"
+#include "field_converter.h"
+#include "typed_row_parser.h"
+
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <tuple>
+
+namespace stl_ios_utilities {
+
+namespace {
+
+enum class Color {kRed = 1, kGreen = 2};
+
+template <typename T>
+T convert(const std::string& field) {
+  T value;
+  FieldConverter<T>::convert(FieldView{field.data(), field.size()}, &value);
+  return value;
+}
+
+TEST(FieldConverterTest, Integers) {
+  EXPECT_EQ(0, convert<int>("0"));
+  EXPECT_EQ(-42, convert<int>("-42"));
+  EXPECT_EQ(42, convert<int>("+42"));
+  EXPECT_EQ(std::numeric_limits<std::int64_t>::min(),
+            convert<std::int64_t>("-9223372036854775808"));
+  EXPECT_EQ(std::numeric_limits<std::uint64_t>::max(),
+            convert<std::uint64_t>("18446744073709551615"));
+  EXPECT_EQ(-128, convert<signed char>("-128"));
+  EXPECT_THROW(convert<signed char>("128"), InvalidField);
+  EXPECT_THROW(convert<std::uint64_t>("18446744073709551616"), InvalidField);
+  EXPECT_THROW(convert<unsigned>("-1"), InvalidField);
+  EXPECT_THROW(convert<int>(""), InvalidField);
+  EXPECT_THROW(convert<int>("-"), InvalidField);
+  EXPECT_THROW(convert<int>("12a"), InvalidField);
+  EXPECT_THROW(convert<int>(" 12"), InvalidField);
+}
+
+TEST(FieldConverterTest, OtherTypes) {
+  EXPECT_DOUBLE_EQ(-1.5e3, convert<double>("-1.5e3"));
+  EXPECT_FLOAT_EQ(0.25f, convert<float>("0.25"));
+  EXPECT_THROW(convert<double>("1.5x"), InvalidField);
+  EXPECT_THROW(convert<double>(""), InvalidField);
+  EXPECT_THROW(convert<float>("1e300"), InvalidField);
+  EXPECT_TRUE(convert<bool>("true"));
+  EXPECT_FALSE(convert<bool>("0"));
+  EXPECT_THROW(convert<bool>("yes"), InvalidField);
+  EXPECT_EQ('x', convert<char>("x"));
+  EXPECT_THROW(convert<char>("xy"), InvalidField);
+  EXPECT_EQ(Color::kGreen, convert<Color>("2"));
+  EXPECT_EQ("text", convert<std::string>("text"));
+}
+
+TEST(TypedRowParserTest, ParseRows) {
+  std::istringstream iss{"foo\t1\t0.5\t2\n"
+                         "bar\t-7\t1e2\t1\n"};
+  TypedRowParser<std::string, int, double, Color> parser;
+  EXPECT_EQ(4u, (TypedRowParser<std::string, int, double, Color>::kColumns));
+  std::tuple<std::string, int, double, Color> row;
+  ASSERT_TRUE(parser.parse_row(&iss, &row));
+  EXPECT_EQ(std::make_tuple(std::string{"foo"}, 1, 0.5, Color::kGreen), row);
+  ASSERT_TRUE(parser.parse_row(&iss, &row));
+  EXPECT_EQ(std::make_tuple(std::string{"bar"}, -7, 100.0, Color::kRed), row);
+  // the empty row after the last newline is not read
+  EXPECT_FALSE(parser.parse_row(&iss, &row));
+  EXPECT_EQ(std::make_tuple(std::string{"bar"}, -7, 100.0, Color::kRed), row);
+}
+
+TEST(TypedRowParserTest, RowUnmodifiedOnErrors) {
+  std::istringstream iss{"a,1\nb,x\nc\nd,2,3\ne,5"};
+  TypedRowParser<std::string, long> parser;
+  parser.delimiter(',');
+  EXPECT_EQ(',', parser.delimiter());
+  std::tuple<std::string, long> row;
+  ASSERT_TRUE(parser.parse_row(&iss, &row));
+  EXPECT_THROW(parser.parse_row(&iss, &row), InvalidField);
+  EXPECT_THROW(parser.parse_row(&iss, &row),
+               DelimitedRowParser::MissingFields);
+  EXPECT_THROW(parser.parse_row(&iss, &row),
+               DelimitedRowParser::UnexpectedFields);
+  EXPECT_EQ(std::make_tuple(std::string{"a"}, 1L), row);
+  iss.ignore(10, '\n');
+  EXPECT_FALSE(parser.parse_row(&iss, &row));
+  EXPECT_EQ(std::make_tuple(std::string{"e"}, 5L), row);
+}
+
+TEST(TypedRowParserTest, MemorySourceAndViews) {
+  std::string data{"key\t12\n"};
+  MemorySource source{data.data(), data.size()};
+  TypedRowParser<FieldView, unsigned short> parser;
+  std::tuple<FieldView, unsigned short> row;
+  ASSERT_TRUE(parser.parse_row(&source, &row));
+  EXPECT_EQ(std::string{"key"}, std::get<0>(row));
+  EXPECT_EQ(data.data(), std::get<0>(row).data());
+  EXPECT_EQ(12, std::get<1>(row));
+  EXPECT_FALSE(parser.parse_row(&source, &row));
+}
+
+} // namespace
+
+} // namespace stl_ios_utilities